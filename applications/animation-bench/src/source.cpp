@@ -0,0 +1,488 @@
+/* pulcher | aodq.net */
+
+#include <pulcher-animation/animation.hpp>
+#include <pulcher-animation/database.hpp>
+#include <pulcher-util/consts.hpp>
+#include <pulcher-util/log.hpp>
+
+#pragma GCC diagnostic push
+  #pragma GCC diagnostic ignored "-Wshadow"
+  #include <argparse/argparse.hpp>
+#pragma GCC diagnostic pop
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <limits>
+#include <map>
+#include <memory>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Animators =
+  std::map<std::string, std::shared_ptr<pul::animation::Animator>>;
+
+auto StartupOptions() -> argparse::ArgumentParser {
+  auto options = argparse::ArgumentParser("pulcher-animation-bench", "0.0.1");
+
+  options
+    .add_argument("-d")
+    .help("spritesheet data file (json) listing the animations to load")
+    .default_value(std::string{"assets/base/spritesheets/data.json"})
+  ;
+
+  options
+    .add_argument("-n")
+    .help("amount of loads per benchmark")
+    .default_value(20)
+    .action([](std::string const & value) { return std::stoi(value); })
+  ;
+
+  options
+    .add_argument("-f")
+    .help("output format; 'text' or 'json' (one object per line)")
+    .default_value(std::string{"text"})
+  ;
+
+  options
+    .add_argument("-p")
+    .help(
+      "only check that packed piece records expand into the vertices of their "
+      "pieces, exits with an error on any mismatch"
+    )
+    .default_value(false)
+    .implicit_value(true)
+  ;
+
+  return options;
+}
+
+// -----------------------------------------------------------------------------
+// -- results ------------------------------------------------------------------
+
+// one per timed implementation, written out once every benchmark has run
+struct BenchRecord {
+  std::string benchmark;
+  std::string implementation;
+  double msFirst; // the first load, before anything was loaded in the process
+  double msBest;
+  size_t mismatches; // animators differing from the json loaded ones
+};
+
+std::vector<BenchRecord> benchRecords;
+
+void Record(
+  std::string benchmark, std::string implementation
+, double const msFirst, double const msBest, size_t const mismatches
+) {
+  ::benchRecords.emplace_back(BenchRecord {
+    std::move(benchmark), std::move(implementation)
+  , msFirst, msBest, mismatches
+  });
+}
+
+void OutputRecordsText() {
+  spdlog::info(
+    "{:<10} {:<10} {:>12} {:>12} {:>10}"
+  , "benchmark", "impl", "ms first", "ms best", "mismatches"
+  );
+
+  for (auto const & record : ::benchRecords) {
+    spdlog::info(
+      "{:<10} {:<10} {:>12.3f} {:>12.3f} {:>10}"
+    , record.benchmark, record.implementation
+    , record.msFirst, record.msBest, record.mismatches
+    );
+  }
+}
+
+std::string JsonEscape(std::string const & str) {
+  std::string escaped;
+  for (char const c : str) {
+    if (c == '"' || c == '\\') { escaped += '\\'; }
+    escaped += c;
+  }
+  return escaped;
+}
+
+// every other label is a plain identifier, so only the data file is escaped
+void OutputRecordsJson(std::string const & dataFilename, size_t const count) {
+  for (auto const & record : ::benchRecords) {
+    std::puts(
+      fmt::format(
+        "{{\"data\":\"{}\",\"benchmark\":\"{}\",\"implementation\":\"{}\","
+        "\"loads\":{},\"ms_first\":{:.3f},\"ms_best\":{:.3f},"
+        "\"mismatches\":{}}}"
+      , ::JsonEscape(dataFilename), record.benchmark, record.implementation
+      , count, record.msFirst, record.msBest, record.mismatches
+      ).c_str()
+    );
+  }
+}
+
+// -----------------------------------------------------------------------------
+// -- comparison ---------------------------------------------------------------
+
+bool SameComponents(
+  std::vector<pul::animation::Component> const & a
+, std::vector<pul::animation::Component> const & b
+) {
+  if (a.size() != b.size()) { return false; }
+  for (size_t it = 0ul; it < a.size(); ++ it) {
+    if (
+        a[it].tile != b[it].tile
+     || a[it].originOffset != b[it].originOffset
+     || a[it].msDeltaTimeOverride != b[it].msDeltaTimeOverride
+    ) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool SameSkeleton(
+  std::vector<pul::animation::Animator::SkeletalPiece> const & a
+, std::vector<pul::animation::Animator::SkeletalPiece> const & b
+) {
+  if (a.size() != b.size()) { return false; }
+  for (size_t it = 0ul; it < a.size(); ++ it) {
+    if (
+        a[it].label != b[it].label
+     || a[it].origin != b[it].origin
+     || !::SameSkeleton(a[it].children, b[it].children)
+    ) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool SameAnimator(
+  pul::animation::Animator const & a, pul::animation::Animator const & b
+) {
+  if (
+      a.label != b.label
+   || a.filename != b.filename
+   || a.spritesheet.filename != b.spritesheet.filename
+   || a.uvCoordOffset != b.uvCoordOffset
+   || a.pieceLabels != b.pieceLabels
+   || !::SameSkeleton(a.skeleton, b.skeleton)
+  ) {
+    return false;
+  }
+
+  for (size_t pieceIt = 0ul; pieceIt < a.pieces.size(); ++ pieceIt) {
+    auto const & pieceA = a.pieces[pieceIt];
+    auto const & pieceB = b.pieces[pieceIt];
+
+    if (
+        pieceA.stateLabels != pieceB.stateLabels
+     || pieceA.dimensions != pieceB.dimensions
+     || pieceA.origin != pieceB.origin
+     || pieceA.renderDepth != pieceB.renderDepth
+    ) {
+      return false;
+    }
+
+    for (size_t stateIt = 0ul; stateIt < pieceA.states.size(); ++ stateIt) {
+      auto const & stateA = pieceA.states[stateIt];
+      auto const & stateB = pieceB.states[stateIt];
+
+      if (
+          stateA.variationType != stateB.variationType
+       || stateA.msDeltaTime != stateB.msDeltaTime
+       || stateA.rotationMirrored != stateB.rotationMirrored
+       || stateA.originInterpolates != stateB.originInterpolates
+       || stateA.rotatePixels != stateB.rotatePixels
+       || stateA.flipXAxis != stateB.flipXAxis
+       || stateA.loops != stateB.loops
+       || stateA.variations.size() != stateB.variations.size()
+      ) {
+        return false;
+      }
+
+      for (size_t it = 0ul; it < stateA.variations.size(); ++ it) {
+        auto const & variationA = stateA.variations[it];
+        auto const & variationB = stateB.variations[it];
+        if (
+            variationA.range.rangeMax != variationB.range.rangeMax
+         || !::SameComponents(variationA.normal.data, variationB.normal.data)
+         || !::SameComponents(variationA.random.data, variationB.random.data)
+         || !::SameComponents(
+              variationA.range.data[0], variationB.range.data[0]
+            )
+         || !::SameComponents(
+              variationA.range.data[1], variationB.range.data[1]
+            )
+        ) {
+          return false;
+        }
+      }
+    }
+  }
+
+  return true;
+}
+
+size_t Mismatches(Animators const & reference, Animators const & animators) {
+  size_t mismatches = 0ul;
+  for (auto const & referencePair : reference) {
+    auto const animatorIt = animators.find(referencePair.first);
+    if (
+        animatorIt == animators.end()
+     || !::SameAnimator(*referencePair.second, *animatorIt->second)
+    ) {
+      ++ mismatches;
+    }
+  }
+  for (auto const & animatorPair : animators) {
+    if (!reference.contains(animatorPair.first)) { ++ mismatches; }
+  }
+  return mismatches;
+}
+
+// -----------------------------------------------------------------------------
+// -- benchmarks ---------------------------------------------------------------
+
+double ElapsedMs(
+  std::chrono::steady_clock::time_point const begin
+, std::chrono::steady_clock::time_point const end
+) {
+  return std::chrono::duration<double, std::milli>(end - begin).count();
+}
+
+// the first load is kept apart as it's what a player waits on at startup,
+// the animators are only freed after the clock stopped
+template <typename Fn>
+void TimeLoads(
+  size_t const count, double & msFirst, double & msBest, Fn && fn
+) {
+  msBest = std::numeric_limits<double>::max();
+  for (size_t it = 0ul; it < count; ++ it) {
+    Animators animators;
+
+    auto const begin = std::chrono::steady_clock::now();
+    fn(animators);
+    auto const end = std::chrono::steady_clock::now();
+
+    double const ms = ::ElapsedMs(begin, end);
+    if (it == 0ul) { msFirst = ms; }
+    msBest = std::min(msBest, ms);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// -- piece records ------------------------------------------------------------
+
+using VertexInputs = pul::animation::Instance::StateInfo::VertexInputs;
+
+// origins are in pixels while uv coords are normalized to the spritesheet
+float constexpr originEpsilon = 0.001f;
+float constexpr uvCoordEpsilon = 0.00001f;
+
+glm::vec2 const invResolution = glm::vec2(1.0f/512.0f, 1.0f/256.0f);
+
+// every combination of the flags, each with a rotated, a mirrored & a skewed
+// matrix, with & without wrapping
+std::vector<VertexInputs> RecordInputs(size_t const count) {
+  std::mt19937 rng(0u);
+  std::uniform_real_distribution<float>
+    angle(0.0f, 6.2831853f)
+  , translation(-200.0f, 200.0f)
+  , shear(-1.0f, 1.0f)
+  , wrap(0.05f, 0.95f)
+  ;
+
+  std::vector<VertexInputs> inputs;
+  for (size_t it = 0ul; it < count; ++ it)
+  for (uint32_t flags = 0u; flags < 16u; ++ flags)
+  for (uint32_t matrixKind = 0u; matrixKind < 3u; ++ matrixKind)
+  for (bool const wrapped : { false, true }) {
+    VertexInputs & input = inputs.emplace_back();
+
+    float const theta = angle(rng);
+    glm::mat3 matrix = glm::mat3(1.0f);
+    matrix[0] = glm::vec3(std::cos(theta), std::sin(theta), 0.0f);
+    matrix[1] = glm::vec3(-std::sin(theta), std::cos(theta), 0.0f);
+    matrix[2] = glm::vec3(translation(rng), translation(rng), 1.0f);
+
+    if (matrixKind == 1u) { matrix[0] = -matrix[0]; }
+    if (matrixKind == 2u) {
+      matrix[1] += matrix[0] * shear(rng);
+      matrix[0] *= 1.0f + shear(rng)*0.5f;
+    }
+
+    input.localSkeletalMatrix = matrix;
+    input.uvCoordWrap =
+      wrapped ? glm::vec2(wrap(rng), wrap(rng)) : glm::vec2(1.0f);
+    input.vertWrap =
+      wrapped ? glm::vec2(wrap(rng), wrap(rng)) : glm::vec2(1.0f);
+    input.tile = glm::u32vec2(rng() % 16u, rng() % 8u);
+    input.dimensions = glm::u32vec2(8u + rng() % 40u, 8u + rng() % 40u);
+    input.uvCoordOffset = glm::uvec2(rng() % 4u, rng() % 4u);
+    input.renderDepth =
+      static_cast<int16_t>(static_cast<int32_t>(rng() % 200u) - 100);
+    input.flipVertWrap = flags & 0b0001u;
+    input.uvFlip       = flags & 0b0010u;
+    input.visible      = flags & 0b0100u;
+    input.hasComponent = flags & 0b1000u;
+  }
+
+  return inputs;
+}
+
+// the record expanded at each corner of the quad against the vertices
+bool SameVertices(
+  VertexInputs const & input, pul::animation::PieceRecord const & record
+) {
+  std::array<glm::vec2, 6ul> uvCoords;
+  std::array<glm::vec3, 6ul> origins;
+  pul::animation::ComputePieceVertices(
+    input, ::invResolution, std::span{uvCoords}, std::span{origins}
+  );
+
+  auto const corners = pul::util::TriangleVertexArray();
+  for (size_t it = 0ul; it < corners.size(); ++ it) {
+    glm::vec3 const origin =
+      pul::animation::ExpandPieceRecordOrigin(record, corners[it]);
+    glm::vec2 const uvCoord =
+      pul::animation::ExpandPieceRecordUvCoord(record, corners[it]);
+
+    if (
+        glm::distance(origin, origins[it]) > ::originEpsilon
+     || glm::distance(uvCoord, uvCoords[it]) > ::uvCoordEpsilon
+    ) {
+      spdlog::error(
+        "record of vertex {} expands to origin ({}, {}, {}) uv ({}, {}), "
+        "vertex is origin ({}, {}, {}) uv ({}, {})"
+      , it, origin.x, origin.y, origin.z, uvCoord.x, uvCoord.y
+      , origins[it].x, origins[it].y, origins[it].z
+      , uvCoords[it].x, uvCoords[it].y
+      );
+      return false;
+    }
+  }
+
+  return true;
+}
+
+} // -- anon namespace
+
+int main(int argc, char const ** argv) {
+  spdlog::set_pattern("%v");
+
+  auto options = ::StartupOptions();
+  options.parse_args(argc, argv);
+
+  auto const dataFilename = options.get<std::string>("-d");
+  auto const count =
+    std::max(static_cast<size_t>(options.get<int>("-n")), 1ul);
+  auto const format = options.get<std::string>("-f");
+
+  if (format != "text" && format != "json") {
+    spdlog::error("unknown output format '{}'", format);
+    return 1;
+  }
+
+  // only the records are written out as json, errors still get through
+  if (format == "json") { spdlog::set_level(spdlog::level::warn); }
+
+  double msFirst, msBest;
+
+  // -- piece records, packing is timed & every record is expanded as the
+  //    vertex shader would against the vertices computed on the CPU
+  if (options.get<bool>("-p")) {
+    auto const inputs = ::RecordInputs(count);
+    std::vector<pul::animation::PieceRecord> records(inputs.size());
+
+    ::TimeLoads(count, msFirst, msBest, [&](Animators &) {
+      for (size_t it = 0ul; it < inputs.size(); ++ it) {
+        records[it] =
+          pul::animation::PackPieceRecord(inputs[it], ::invResolution);
+      }
+    });
+
+    size_t mismatches = 0ul;
+    for (size_t it = 0ul; it < inputs.size(); ++ it)
+      { mismatches += !::SameVertices(inputs[it], records[it]); }
+
+    spdlog::info("{} piece records {} mismatches", inputs.size(), mismatches);
+    ::Record("pack", "records", msFirst, msBest, mismatches);
+
+    if (format == "json") {
+      ::OutputRecordsJson("records", count);
+    } else {
+      ::OutputRecordsText();
+    }
+
+    return mismatches == 0ul ? 0 : 1;
+  }
+
+  std::string const databaseFilename =
+    (
+      std::filesystem::temp_directory_path() / "pulcher-animation-bench.animdb"
+    ).string();
+
+  // -- json, also the reference the database is compared against
+  Animators reference;
+  std::vector<std::string> sourceFilenames;
+  ::TimeLoads(count, msFirst, msBest, [&](Animators & animators) {
+    sourceFilenames =
+      pul::animation::LoadAnimatorsJson(dataFilename, animators);
+  });
+  pul::animation::LoadAnimatorsJson(dataFilename, reference);
+
+  if (sourceFilenames.empty()) { return 1; }
+  ::Record("load", "json", msFirst, msBest, 0ul);
+
+  spdlog::info(
+    "'{}' {} source files {} animators"
+  , dataFilename, sourceFilenames.size(), reference.size()
+  );
+
+  // -- compiling the database, what the first run after a change pays on top
+  bool written = true;
+  ::TimeLoads(count, msFirst, msBest, [&](Animators &) {
+    written &=
+      pul::animation::WriteAnimatorDatabase(
+        databaseFilename, reference, sourceFilenames
+      );
+  });
+
+  if (!written) { return 1; }
+  ::Record("compile", "database", msFirst, msBest, 0ul);
+
+  // -- database, including hashing the sources to validate it
+  bool loaded = true;
+  Animators databaseAnimators;
+  ::TimeLoads(count, msFirst, msBest, [&](Animators & animators) {
+    loaded &=
+      pul::animation::LoadAnimatorDatabase(databaseFilename, animators);
+  });
+  loaded &=
+    pul::animation::LoadAnimatorDatabase(databaseFilename, databaseAnimators);
+
+  if (!loaded) { return 1; }
+  ::Record(
+    "load", "database", msFirst, msBest
+  , ::Mismatches(reference, databaseAnimators)
+  );
+
+  std::error_code error;
+  std::filesystem::remove(databaseFilename, error);
+
+  if (format == "json") {
+    ::OutputRecordsJson(dataFilename, count);
+  } else {
+    ::OutputRecordsText();
+  }
+
+  return 0;
+}
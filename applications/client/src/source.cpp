@@ -220,10 +220,10 @@ void ProcessLogic(
   pul::plugin::Info const & plugin, pul::core::SceneBundle & scene
 ) {
 
-  // clear debug physics queries
-  auto & queries = scene.PhysicsDebugQueries();
-  queries.intersectorRays.clear();
-  queries.intersectorPoints.clear();
+  ++ scene.logicTick;
+
+  // restart debug physics query counts
+  scene.PhysicsDebugQueries().BeginFrame();
 
   auto & imguiIo = ImGui::GetIO();
 
@@ -0,0 +1,1264 @@
+/* pulcher | aodq.net */
+
+#include <pulcher-core/map.hpp>
+#include <pulcher-core/tiled.hpp>
+#include <pulcher-gfx/image.hpp>
+#include <pulcher-physics/broadphase.hpp>
+#include <pulcher-physics/intersections.hpp>
+#include <pulcher-physics/kernels.hpp>
+#include <pulcher-physics/tileset.hpp>
+#include <pulcher-util/enum.hpp>
+#include <pulcher-util/log.hpp>
+#include <pulcher-util/consts.hpp>
+#include <pulcher-util/math.hpp>
+
+#pragma GCC diagnostic push
+  #pragma GCC diagnostic ignored "-Wshadow"
+  #include <argparse/argparse.hpp>
+#pragma GCC diagnostic pop
+
+#include <cjson/cJSON.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+// collision geometry in the same layout the map plugin hands to the physics
+// plugin, one entry per tileset & collision layer
+struct BenchMap {
+  std::vector<pul::physics::Tileset> tilesets;
+
+  struct Placements {
+    size_t tilesetIdx;
+    pul::core::CollisionChannel channels;
+
+    std::vector<size_t> tileIndices;
+    std::vector<glm::i32vec2> tileOrigins;
+    std::vector<pul::core::TileOrientation> tileOrientations;
+  };
+
+  std::vector<Placements> placements;
+
+  pul::physics::TilemapLayer layer;
+
+  // added if the tileset has no tiles on the layer yet
+  Placements & PlacementsOf(
+    size_t tilesetIdx, pul::core::CollisionChannel channels
+  );
+
+  void ConstructLayer();
+};
+
+BenchMap::Placements & BenchMap::PlacementsOf(
+  size_t const tilesetIdx, pul::core::CollisionChannel const channels
+) {
+  for (auto & placement : this->placements) {
+    if (placement.tilesetIdx == tilesetIdx && placement.channels == channels)
+      { return placement; }
+  }
+
+  auto & placement = this->placements.emplace_back();
+  placement.tilesetIdx = tilesetIdx;
+  placement.channels = channels;
+  return placement;
+}
+
+void BenchMap::ConstructLayer() {
+  std::vector<pul::physics::Tileset const *> tilesetPtrs;
+  std::vector<std::span<size_t>> indices;
+  std::vector<std::span<glm::i32vec2>> origins;
+  std::vector<std::span<pul::core::TileOrientation>> orientations;
+  std::vector<pul::core::CollisionChannel> channels;
+
+  for (auto & placement : this->placements) {
+    tilesetPtrs.emplace_back(&this->tilesets[placement.tilesetIdx]);
+    indices.emplace_back(std::span(placement.tileIndices));
+    origins.emplace_back(std::span(placement.tileOrigins));
+    orientations.emplace_back(std::span(placement.tileOrientations));
+    channels.emplace_back(placement.channels);
+  }
+
+  this->layer =
+    pul::physics::TilemapLayer::Construct(
+      tilesetPtrs, indices, origins, orientations, channels
+    );
+}
+
+auto StartupOptions() -> argparse::ArgumentParser {
+  auto options = argparse::ArgumentParser("pulcher-physics-bench", "0.0.1");
+
+  options
+    .add_argument("-m")
+    .help("Tiled map (json) to benchmark against, otherwise a synthetic map")
+    .default_value(std::string{""})
+  ;
+
+  options
+    .add_argument("-n")
+    .help("amount of queries per benchmark")
+    .default_value(100'000)
+    .action([](std::string const & value) { return std::stoi(value); })
+  ;
+
+  options
+    .add_argument("-s")
+    .help("random seed")
+    .default_value(0)
+    .action([](std::string const & value) { return std::stoi(value); })
+  ;
+
+  options
+    .add_argument("-f")
+    .help("output format; 'text' or 'json' (one object per line)")
+    .default_value(std::string{"text"})
+  ;
+
+  return options;
+}
+
+// -----------------------------------------------------------------------------
+// -- map construction ---------------------------------------------------------
+
+// variations of the tile shapes the shipped tilesets use
+pul::physics::Tileset SyntheticTileset(std::mt19937 & rng) {
+  auto constexpr gridSize = pul::physics::Tile::gridSize;
+  using SolidMask = pul::physics::Tile::SolidMask;
+
+  std::uniform_int_distribution<int32_t> offset(2, 29);
+
+  pul::physics::Tileset tileset;
+
+  auto const addTile = [&](auto && isSolid) {
+    SolidMask mask;
+    for (size_t x = 0ul; x < gridSize; ++ x)
+    for (size_t y = 0ul; y < gridSize; ++ y) {
+      mask[x][y] =
+        isSolid(static_cast<int32_t>(x), static_cast<int32_t>(y));
+    }
+    tileset.tiles.emplace_back(pul::physics::Tile::Construct(mask));
+  };
+
+  addTile([](int32_t, int32_t) { return true; }); // full
+
+  for (size_t variation = 0ul; variation < 8ul; ++ variation) {
+    int32_t const a = offset(rng), b = offset(rng);
+    addTile([=](int32_t x, int32_t y) { return y*a >= x*b; }); // slope
+    addTile([=](int32_t, int32_t y) { return y >= a; }); // ledge
+    addTile([=](int32_t, int32_t y) { return y < a/4; }); // platform
+    addTile([=](int32_t x, int32_t) { return x >= a/2 && x < a/2+b/2; });
+    addTile([=](int32_t x, int32_t y) { // blob
+      return (x-a)*(x-a) + (y-b)*(y-b) < (a/2)*(a/2);
+    });
+    addTile([=](int32_t x, int32_t y) { // sparse debris
+      return (x*a + y*b) % 31 == 0;
+    });
+  }
+
+  return tileset;
+}
+
+// floors, platforms and scattered oriented tiles, roughly as dense as the
+// shipped maps
+BenchMap SyntheticMap(std::mt19937 & rng) {
+  BenchMap map;
+  map.tilesets.emplace_back(::SyntheticTileset(rng));
+  auto & placements = map.PlacementsOf(0ul, pul::core::CollisionChannel::All);
+
+  uint32_t constexpr width = 128u, height = 48u;
+
+  size_t const tileCount = map.tilesets[0].tiles.size();
+  std::uniform_int_distribution<size_t> tileDistribution(0ul, tileCount-1ul);
+  std::uniform_int_distribution<size_t> orientationDistribution(0ul, 7ul);
+  std::uniform_real_distribution<float> chance(0.0f, 1.0f);
+
+  auto const addTile = [&](uint32_t x, uint32_t y, size_t tileIdx) {
+    placements.tileIndices.emplace_back(tileIdx);
+    placements.tileOrigins.emplace_back(glm::i32vec2(x, y));
+    placements.tileOrientations.emplace_back(
+      static_cast<pul::core::TileOrientation>(
+        chance(rng) < 0.2f ? orientationDistribution(rng) : 0ul
+      )
+    );
+  };
+
+  for (uint32_t y = 0u; y < height; ++ y)
+  for (uint32_t x = 0u; x < width; ++ x) {
+    bool const border = x == 0u || x == width-1u || y == 0u || y >= height-3u;
+    bool const platform = y % 8u == 4u && (x / 6u) % 3u == 0u;
+
+    if (border || platform) {
+      addTile(x, y, 0ul);
+    } else if (chance(rng) < 0.12f) {
+      addTile(x, y, tileDistribution(rng));
+    }
+  }
+
+  map.ConstructLayer();
+  return map;
+}
+
+// only the collision layers (those that the map plugin places at depth 0) are
+// loaded, parsed the same way the map plugin does
+bool LoadTiledMap(std::string const & filename, BenchMap & map) {
+  cJSON * json = pul::core::LoadTiledJson(filename);
+  if (!json) { return false; }
+
+  std::vector<pul::core::TiledTileset> tilesets;
+  if (!pul::core::LoadTiledTilesets(json, filename, tilesets)) {
+    cJSON_Delete(json);
+    return false;
+  }
+
+  for (auto const & tileset : tilesets) {
+    auto const image =
+      pul::gfx::Image::Construct(tileset.imagePath.string().c_str());
+
+    map.tilesets.emplace_back(
+      pul::physics::Tileset::Construct(image.data, image.width, image.height)
+    );
+
+    // tile properties only matter to map objects
+    cJSON_Delete(tileset.jsonTiles);
+  }
+
+  cJSON * layer;
+  cJSON_ArrayForEach(layer, cJSON_GetObjectItemCaseSensitive(json, "layers")) {
+    auto const layerType =
+      std::string{cJSON_GetObjectItemCaseSensitive(layer, "type")->valuestring};
+    if (layerType != "tilelayer") { continue; }
+
+    auto const layerLabel =
+      cJSON_GetObjectItemCaseSensitive(layer, "name")->valuestring;
+    if (pul::core::TiledLayerDepth(layerLabel) != 0) { continue; }
+
+    auto const channels = pul::core::TiledLayerChannels(layerLabel);
+
+    for (auto const & tile : pul::core::TiledLayerTiles(layer)) {
+      size_t const tilesetIdx = pul::core::TiledTilesetIdx(tilesets, tile.gid);
+      if (tilesetIdx == -1ul) { continue; }
+
+      auto & placements = map.PlacementsOf(tilesetIdx, channels);
+      placements.tileIndices
+        .emplace_back(tile.gid - tilesets[tilesetIdx].firstGid);
+      placements.tileOrigins.emplace_back(tile.origin);
+      placements.tileOrientations.emplace_back(tile.orientation);
+    }
+  }
+
+  cJSON_Delete(json);
+
+  map.ConstructLayer();
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// -- results ------------------------------------------------------------------
+
+// one per timed implementation, written out once every benchmark has run
+struct BenchRecord {
+  std::string benchmark;
+  std::string implementation;
+  std::string parameters; // eg "length=64", empty if the benchmark has none
+  double nsPerQuery;
+  size_t hits;
+  size_t mismatches; // against the reference implementation of the benchmark
+};
+
+std::vector<BenchRecord> benchRecords;
+
+void Record(
+  std::string benchmark, std::string implementation, std::string parameters
+, double const nsPerQuery, size_t const hits, size_t const mismatches
+) {
+  ::benchRecords.emplace_back(BenchRecord {
+    std::move(benchmark), std::move(implementation), std::move(parameters)
+  , nsPerQuery, hits, mismatches
+  });
+}
+
+void OutputRecordsText() {
+  spdlog::info(
+    "{:<16} {:<10} {:<22} {:>12} {:>14} {:>8} {:>10}"
+  , "benchmark", "impl", "parameters", "ns/query", "queries/sec", "hits"
+  , "mismatches"
+  );
+
+  for (auto const & record : ::benchRecords) {
+    spdlog::info(
+      "{:<16} {:<10} {:<22} {:>12.1f} {:>14.0f} {:>8} {:>10}"
+    , record.benchmark, record.implementation, record.parameters
+    , record.nsPerQuery, 1'000'000'000.0 / record.nsPerQuery
+    , record.hits, record.mismatches
+    );
+  }
+}
+
+std::string JsonEscape(std::string const & str) {
+  std::string escaped;
+  for (char const c : str) {
+    if (c == '"' || c == '\\') { escaped += '\\'; }
+    escaped += c;
+  }
+  return escaped;
+}
+
+// every other label is a plain identifier, so only the map has to be escaped
+void OutputRecordsJson(std::string const & mapLabel, size_t const count) {
+  for (auto const & record : ::benchRecords) {
+    std::puts(
+      fmt::format(
+        "{{\"map\":\"{}\",\"benchmark\":\"{}\",\"implementation\":\"{}\","
+        "\"parameters\":\"{}\",\"queries\":{},\"ns_per_query\":{:.3f},"
+        "\"queries_per_sec\":{:.1f},\"hits\":{},\"mismatches\":{}}}"
+      , ::JsonEscape(mapLabel), record.benchmark, record.implementation
+      , record.parameters
+      , count, record.nsPerQuery, 1'000'000'000.0 / record.nsPerQuery
+      , record.hits, record.mismatches
+      ).c_str()
+    );
+  }
+}
+
+// -----------------------------------------------------------------------------
+// -- benchmarks ---------------------------------------------------------------
+
+// tile layout before collision masks were bit-packed, point queries applied
+// the tile orientation on every lookup
+struct LegacyTile {
+  std::array<std::array<float, 32ul>, 32ul> signedDistanceField;
+  std::array<std::array<uint8_t, 32ul>, 32ul> accelerationHints;
+};
+
+// indexed the same as the tilesets the layer was constructed from, which is
+// once per placement
+std::vector<std::vector<LegacyTile>> LegacyTilesets(BenchMap const & map) {
+  std::vector<std::vector<LegacyTile>> tilesets;
+  for (auto const & placement : map.placements) {
+    auto & legacyTiles = tilesets.emplace_back();
+    for (auto const & tile : map.tilesets[placement.tilesetIdx].tiles) {
+      auto & legacyTile = legacyTiles.emplace_back();
+      for (uint32_t x = 0u; x < 32u; ++ x)
+      for (uint32_t y = 0u; y < 32u; ++ y) {
+        legacyTile.signedDistanceField[x][y] =
+          tile.Solid(glm::u32vec2(x, y)) ? 255.0f : 0.0f;
+      }
+    }
+  }
+
+  return tilesets;
+}
+
+// mirrors the point query from before, which isn't inlined either
+[[gnu::noinline]] bool LegacyPoint(
+  pul::physics::TilemapLayer const & layer
+, std::vector<std::vector<LegacyTile>> const & legacyTilesets
+, pul::physics::IntersectorPoint const & point
+, pul::physics::IntersectionResults & results
+) {
+  results = {};
+
+  if (point.origin.x < 0 || point.origin.y < 0) { return false; }
+
+  auto const * tileInfo = layer.Tile(point.origin / 32);
+  if (!tileInfo || !tileInfo->Valid()) { return false; }
+
+  glm::u32vec2 const texel =
+    pul::physics::OrientTexel(
+      tileInfo->Orientation(), glm::u32vec2(point.origin % 32)
+    , pul::physics::Tile::gridSize
+    );
+
+  auto const & legacyTile =
+    legacyTilesets[tileInfo->tilesetIdx][tileInfo->imageTileIdx];
+
+  if (legacyTile.signedDistanceField[texel.x][texel.y] > 0.0f) {
+    results =
+      pul::physics::IntersectionResults {
+        true, point.origin, tileInfo->imageTileIdx, tileInfo->tilesetIdx
+      };
+    return true;
+  }
+
+  return false;
+}
+
+// lines used to stop after this many steps, the last one was never visited
+uint32_t constexpr legacyBresenhamMaxSteps = 1'000u;
+
+// the raycast before SDFs were used, every texel of the line is tested. Only
+// the first maxTexels texels are tested, as the line used to be capped
+bool LegacyRaycast(
+  pul::physics::TilemapLayer const & layer
+, pul::physics::IntersectorRay const & ray
+, pul::physics::IntersectionResults & results
+, uint32_t maxTexels = std::numeric_limits<uint32_t>::max()
+) {
+  results = {};
+  pul::physics::BresenhamLine(
+    ray.beginOrigin, ray.endOrigin
+  , [&](int32_t x, int32_t y) {
+      if (results.collision || maxTexels == 0u) { return; }
+      -- maxTexels;
+      pul::physics::IntersectionPoint(
+        layer, pul::physics::IntersectorPoint{glm::i32vec2(x, y)}, results
+      );
+    }
+  );
+
+  return results.collision;
+}
+
+// per-texel inverse raycast, the first empty texel inside of the map bounds
+bool LegacyInverseRaycast(
+  pul::physics::TilemapLayer const & layer
+, pul::physics::IntersectorRay const & ray
+, pul::physics::IntersectionResults & results
+) {
+  glm::i32vec2 const texelMin = layer.TexelMin(), texelMax = layer.TexelMax();
+
+  results = {};
+  pul::physics::BresenhamLine(
+    ray.beginOrigin, ray.endOrigin
+  , [&](int32_t x, int32_t y) {
+      if (results.collision) { return; }
+      if (
+          x < texelMin.x || y < texelMin.y || x > texelMax.x || y > texelMax.y
+      ) {
+        return;
+      }
+
+      pul::physics::IntersectionResults pointResults;
+      if (
+        !pul::physics::IntersectionPoint(
+          layer, pul::physics::IntersectorPoint{glm::i32vec2(x, y)}
+        , pointResults
+        )
+      ) {
+        results.collision = true;
+        results.origin = glm::i32vec2(x, y);
+      }
+    }
+  );
+
+  return results.collision;
+}
+
+std::vector<pul::physics::IntersectorRay> RandomRays(
+  std::mt19937 & rng, pul::physics::TilemapLayer const & layer
+, size_t count, float length
+) {
+  glm::vec2 const
+    texelMin = glm::vec2(layer.TexelMin())
+  , texelMax = glm::vec2(layer.TexelMax() + glm::i32vec2(1))
+  ;
+
+  std::uniform_real_distribution<float>
+    originX(texelMin.x, texelMax.x)
+  , originY(texelMin.y, texelMax.y)
+  , angle(0.0f, 2.0f*pul::Pi)
+  ;
+
+  std::vector<pul::physics::IntersectorRay> rays;
+  rays.reserve(count);
+  for (size_t i = 0ul; i < count; ++ i) {
+    glm::vec2 const origin = glm::vec2(originX(rng), originY(rng));
+    float const theta = angle(rng);
+    rays.emplace_back(
+      pul::physics::IntersectorRay::Construct(
+        origin, origin + glm::vec2(glm::cos(theta), glm::sin(theta))*length
+      )
+    );
+  }
+
+  return rays;
+}
+
+// best of a few repetitions, so the first pass warming caches doesn't count
+template <typename Fn>
+double TimeNsPerQuery(size_t const count, Fn && fn) {
+  double best = std::numeric_limits<double>::max();
+  for (size_t repetition = 0ul; repetition < 3ul; ++ repetition) {
+    auto const begin = std::chrono::steady_clock::now();
+    for (size_t i = 0ul; i < count; ++ i) { fn(i); }
+    auto const end = std::chrono::steady_clock::now();
+
+    best =
+      std::min(
+        best
+      , std::chrono::duration<double, std::nano>(end - begin).count()
+        / static_cast<double>(count)
+      );
+  }
+
+  return best;
+}
+
+void BenchmarkPoints(
+  std::mt19937 & rng, BenchMap const & map, size_t const count
+) {
+  auto const & layer = map.layer;
+  auto const legacyTilesets = ::LegacyTilesets(map);
+
+  size_t legacyTileCount = 0ul;
+  for (auto const & tileset : legacyTilesets)
+    { legacyTileCount += tileset.size(); }
+
+  // distance fields are only read by sphere tracing, not by point queries, &
+  // texel channels are only stored for tiles with mixed channels
+  spdlog::info(
+    "tile storage | legacy {} bytes/tile | packed {} bytes/tile "
+    "(mask {} bytes) + distance field {} bytes "
+    "+ texel channels {} bytes/mixed tile"
+  , sizeof(LegacyTile), sizeof(pul::physics::Tile)
+  , sizeof(pul::physics::Tile::mask)
+  , sizeof(pul::physics::Tile::DistanceField)
+  , sizeof(pul::physics::Tile::TexelChannels)
+  );
+
+  spdlog::info(
+    "collision set | legacy {} KiB ({} tiles) | packed {} KiB "
+    "+ distance fields {} KiB + texel channels {} KiB ({} oriented tiles)"
+  , legacyTileCount * sizeof(LegacyTile) / 1024ul, legacyTileCount
+  , layer.orientedTiles.size() * sizeof(pul::physics::Tile) / 1024ul
+  , layer.orientedDistanceFields.size()
+      * sizeof(pul::physics::Tile::DistanceField) / 1024ul
+  , layer.mixedTexelChannels.size()
+      * sizeof(pul::physics::Tile::TexelChannels) / 1024ul
+  , layer.orientedTiles.size()
+  );
+
+  std::uniform_int_distribution<int32_t>
+    originX(layer.TexelMin().x, layer.TexelMax().x)
+  , originY(layer.TexelMin().y, layer.TexelMax().y)
+  ;
+
+  std::vector<glm::i32vec2> points;
+  points.reserve(count);
+  for (size_t i = 0ul; i < count; ++ i)
+    { points.emplace_back(originX(rng), originY(rng)); }
+
+  std::vector<uint8_t> legacyResults(count), packedResults(count);
+
+  double const legacyNs =
+    ::TimeNsPerQuery(count, [&](size_t i) {
+      pul::physics::IntersectionResults results;
+      legacyResults[i] =
+        ::LegacyPoint(
+          layer, legacyTilesets, pul::physics::IntersectorPoint{points[i]}
+        , results
+        );
+    });
+
+  double const packedNs =
+    ::TimeNsPerQuery(count, [&](size_t i) {
+      pul::physics::IntersectionResults results;
+      packedResults[i] =
+        pul::physics::IntersectionPoint(
+          layer, pul::physics::IntersectorPoint{points[i]}, results
+        );
+    });
+
+  size_t mismatches = 0ul, legacyHits = 0ul, packedHits = 0ul;
+  for (size_t i = 0ul; i < count; ++ i) {
+    legacyHits += legacyResults[i];
+    packedHits += packedResults[i];
+    mismatches += legacyResults[i] != packedResults[i];
+  }
+
+  ::Record("point", "legacy", "", legacyNs, legacyHits, 0ul);
+  ::Record("point", "packed", "", packedNs, packedHits, mismatches);
+
+  // -- batched, as the players' wall checks are issued, at every instruction
+  //    set the CPU supports
+  std::vector<pul::physics::IntersectorPoint> intersectors;
+  intersectors.reserve(count);
+  for (auto const & point : points)
+    { intersectors.emplace_back(pul::physics::IntersectorPoint{point}); }
+
+  for (size_t const batchSize : { 8ul, 64ul }) {
+    size_t const batches = count / batchSize;
+
+    for (
+      size_t level = 0ul;
+      level <= Idx(pul::physics::DetectedSimdLevel());
+      ++ level
+    ) {
+      pul::physics::OverrideSimdLevel(
+        static_cast<pul::physics::SimdLevel>(level)
+      );
+
+      std::vector<pul::physics::IntersectionResults> results(count);
+
+      double const batchNs =
+        ::TimeNsPerQuery(batches, [&](size_t batch) {
+          pul::physics::IntersectionPointBatch(
+            layer
+          , std::span(intersectors).subspan(batch*batchSize, batchSize)
+          , std::span(results).subspan(batch*batchSize, batchSize)
+          );
+        });
+
+      size_t batchHits = 0ul, batchMismatches = 0ul;
+      for (size_t i = 0ul; i < batches*batchSize; ++ i) {
+        batchHits += results[i].collision;
+        batchMismatches += results[i].collision != packedResults[i];
+      }
+
+      ::Record(
+        "point-batch"
+      , ToStr(static_cast<pul::physics::SimdLevel>(level))
+      , fmt::format("batch={}", batchSize)
+      , batchNs / static_cast<double>(batchSize)
+      , batchHits, batchMismatches
+      );
+    }
+  }
+
+  pul::physics::OverrideSimdLevel(pul::physics::DetectedSimdLevel());
+}
+
+void BenchmarkRaycasts(
+  std::mt19937 & rng, pul::physics::TilemapLayer const & layer
+, size_t const count
+) {
+  for (float const length : { 16.0f, 64.0f, 256.0f, 998.0f }) {
+    auto const rays = ::RandomRays(rng, layer, count, length);
+
+    std::vector<pul::physics::IntersectionResults>
+      legacyResults(count), sdfResults(count), batchResults(count)
+    , legacyInverseResults(count), sdfInverseResults(count)
+    ;
+
+    double const legacyNs =
+      ::TimeNsPerQuery(count, [&](size_t i) {
+        ::LegacyRaycast(layer, rays[i], legacyResults[i]);
+      });
+
+    double const sdfNs =
+      ::TimeNsPerQuery(count, [&](size_t i) {
+        pul::physics::IntersectionRaycast(layer, rays[i], sdfResults[i]);
+      });
+
+    // batched as the projectiles of a tick are cast
+    size_t constexpr batchSize = 64ul;
+    size_t const batches = count / batchSize;
+    double const batchNs =
+      ::TimeNsPerQuery(batches, [&](size_t batch) {
+        pul::physics::IntersectionRaycastBatch(
+          layer
+        , std::span(rays).subspan(batch*batchSize, batchSize)
+        , std::span(batchResults).subspan(batch*batchSize, batchSize)
+        );
+      }) / static_cast<double>(batchSize);
+
+    double const legacyInverseNs =
+      ::TimeNsPerQuery(count, [&](size_t i) {
+        ::LegacyInverseRaycast(layer, rays[i], legacyInverseResults[i]);
+      });
+
+    double const sdfInverseNs =
+      ::TimeNsPerQuery(count, [&](size_t i) {
+        pul::physics::InverseIntersectionRaycast(
+          layer, rays[i], sdfInverseResults[i]
+        );
+      });
+
+    std::vector<uint8_t> visible(count);
+    double const lineOfSightNs =
+      ::TimeNsPerQuery(count, [&](size_t i) {
+        visible[i] =
+          pul::physics::LineOfSight(
+            layer, rays[i].beginOrigin, rays[i].endOrigin
+          );
+      });
+
+    auto const compare =
+      [count](
+        std::vector<pul::physics::IntersectionResults> const & reference
+      , std::vector<pul::physics::IntersectionResults> const & results
+      , size_t & referenceHits, size_t & hits, size_t & mismatches
+      ) {
+        referenceHits = hits = mismatches = 0ul;
+        for (size_t i = 0ul; i < count; ++ i) {
+          referenceHits += reference[i].collision;
+          hits += results[i].collision;
+          if (
+              reference[i].collision != results[i].collision
+           || reference[i].origin != results[i].origin
+          ) {
+            ++ mismatches;
+          }
+        }
+      };
+
+    auto const parameters = fmt::format("length={}", length);
+    size_t referenceHits, hits, mismatches;
+
+    compare(legacyResults, sdfResults, referenceHits, hits, mismatches);
+    ::Record("raycast", "per-texel", parameters, legacyNs, referenceHits, 0ul);
+    ::Record("raycast", "sdf", parameters, sdfNs, hits, mismatches);
+
+    // rays past the last full batch are never cast by it
+    size_t batchHits = 0ul, batchMismatches = 0ul;
+    for (size_t i = 0ul; i < batches*batchSize; ++ i) {
+      batchHits += batchResults[i].collision;
+      batchMismatches +=
+          batchResults[i].collision != sdfResults[i].collision
+       || batchResults[i].origin != sdfResults[i].origin
+       || batchResults[i].normal != sdfResults[i].normal
+      ;
+    }
+    ::Record(
+      "raycast", "sdf-batch", fmt::format("{} batch={}", parameters, batchSize)
+    , batchNs, batchHits, batchMismatches
+    );
+
+    compare(
+      legacyInverseResults, sdfInverseResults, referenceHits, hits, mismatches
+    );
+    ::Record(
+      "raycast-inverse", "per-texel", parameters, legacyInverseNs
+    , referenceHits, 0ul
+    );
+    ::Record(
+      "raycast-inverse", "sdf", parameters, sdfInverseNs, hits, mismatches
+    );
+
+    // a ray that collides has no line of sight, that's the only difference
+    size_t blocked = 0ul;
+    mismatches = 0ul;
+    for (size_t i = 0ul; i < count; ++ i) {
+      blocked += !visible[i];
+      mismatches += !visible[i] != sdfResults[i].collision;
+    }
+    ::Record(
+      "line-of-sight", "pyramid", parameters, lineOfSightNs, blocked
+    , mismatches
+    );
+  }
+}
+
+// rays as long as the map diagonal from random empty texels, so they can cross
+// all of it. Compared against the per-texel raycast both with and without the
+// cap lines used to have
+void BenchmarkDiagonalRaycasts(
+  std::mt19937 & rng, pul::physics::TilemapLayer const & layer
+, size_t const count
+) {
+  glm::vec2 const
+    texelMin = glm::vec2(layer.TexelMin())
+  , texelMax = glm::vec2(layer.TexelMax() + glm::i32vec2(1))
+  ;
+  float const diagonal = glm::length(texelMax - texelMin);
+
+  std::uniform_real_distribution<float>
+    originX(texelMin.x, texelMax.x)
+  , originY(texelMin.y, texelMax.y)
+  , angle(0.0f, 2.0f*pul::Pi)
+  ;
+
+  std::vector<pul::physics::IntersectorRay> rays;
+  rays.reserve(count);
+  while (rays.size() < count) {
+    glm::vec2 const origin = glm::vec2(originX(rng), originY(rng));
+
+    // starting inside of geometry would only measure the first texel
+    pul::physics::IntersectionResults results;
+    if (
+      pul::physics::IntersectionPoint(
+        layer, pul::physics::IntersectorPoint{glm::round(origin)}, results
+      )
+    ) {
+      continue;
+    }
+
+    float const theta = angle(rng);
+    rays.emplace_back(
+      pul::physics::IntersectorRay::Construct(
+        origin, origin + glm::vec2(glm::cos(theta), glm::sin(theta))*diagonal
+      )
+    );
+  }
+
+  std::vector<pul::physics::IntersectionResults>
+    referenceResults(count), cappedResults(count), sdfResults(count);
+
+  double const referenceNs =
+    ::TimeNsPerQuery(count, [&](size_t i) {
+      ::LegacyRaycast(layer, rays[i], referenceResults[i]);
+    });
+
+  double const cappedNs =
+    ::TimeNsPerQuery(count, [&](size_t i) {
+      ::LegacyRaycast(
+        layer, rays[i], cappedResults[i], legacyBresenhamMaxSteps - 1u
+      );
+    });
+
+  double const sdfNs =
+    ::TimeNsPerQuery(count, [&](size_t i) {
+      pul::physics::IntersectionRaycast(layer, rays[i], sdfResults[i]);
+    });
+
+  size_t mismatches = 0ul, hits = 0ul, cappedMisses = 0ul, sdfHits = 0ul;
+  for (size_t i = 0ul; i < count; ++ i) {
+    hits += referenceResults[i].collision;
+    sdfHits += sdfResults[i].collision;
+    cappedMisses +=
+      referenceResults[i].collision && !cappedResults[i].collision;
+    if (
+        referenceResults[i].collision != sdfResults[i].collision
+     || referenceResults[i].origin != sdfResults[i].origin
+    ) {
+      ++ mismatches;
+    }
+  }
+
+  auto const parameters = fmt::format("length={:.0f}", diagonal);
+  ::Record("raycast-map", "per-texel", parameters, referenceNs, hits, 0ul);
+  ::Record(
+    "raycast-map", "capped", parameters, cappedNs, hits - cappedMisses
+  , cappedMisses
+  );
+  ::Record("raycast-map", "sdf", parameters, sdfNs, sdfHits, mismatches);
+}
+
+// player sized hitboxes scattered over the map, queried through the
+// broadphase and against every entity
+void BenchmarkEntities(
+  std::mt19937 & rng, pul::physics::TilemapLayer const & layer
+, size_t const count
+) {
+  glm::vec2 constexpr dimensions = glm::vec2(15.0f, 50.0f);
+
+  glm::vec2 const
+    texelMin = glm::vec2(layer.TexelMin())
+  , texelMax = glm::vec2(layer.TexelMax() + glm::i32vec2(1))
+  ;
+
+  std::uniform_real_distribution<float>
+    originX(texelMin.x, texelMax.x)
+  , originY(texelMin.y, texelMax.y)
+  ;
+
+  for (size_t const entityCount : { 8ul, 64ul, 512ul }) {
+    pul::physics::EntityBroadphase broadphase;
+    for (size_t i = 0ul; i < entityCount; ++ i) {
+      broadphase.Update(
+        static_cast<entt::entity>(i)
+      , glm::vec2(originX(rng), originY(rng)), dimensions
+      );
+    }
+
+    pul::physics::EntityIntersectionResults results;
+
+    for (float const length : { 64.0f, 256.0f, 998.0f }) {
+      auto const rays = ::RandomRays(rng, layer, count, length);
+      std::vector<size_t> bruteHits(count), broadphaseHits(count);
+
+      double const bruteNs =
+        ::TimeNsPerQuery(count, [&](size_t i) {
+          glm::vec2 const
+            rayBegin = glm::vec2(rays[i].beginOrigin)
+          , rayEnd = glm::vec2(rays[i].endOrigin)
+          ;
+
+          size_t hits = 0ul;
+          for (auto const & record : broadphase.records) {
+            float intersectionLength;
+            hits +=
+              pul::physics::IntersectionRayAabb(
+                rayBegin, rayEnd, record.aabbOrigin, record.aabbDimensions
+              , intersectionLength
+              );
+          }
+          bruteHits[i] = hits;
+        });
+
+      double const broadphaseNs =
+        ::TimeNsPerQuery(count, [&](size_t i) {
+          pul::physics::EntityIntersectionRaycast(broadphase, rays[i], results);
+          broadphaseHits[i] = results.entities.size();
+        });
+
+      size_t bruteTotal = 0ul, broadphaseTotal = 0ul, mismatches = 0ul;
+      for (size_t i = 0ul; i < count; ++ i) {
+        bruteTotal += bruteHits[i];
+        broadphaseTotal += broadphaseHits[i];
+        mismatches += bruteHits[i] != broadphaseHits[i];
+      }
+
+      auto const parameters =
+        fmt::format("entities={} length={}", entityCount, length);
+      ::Record("entity-raycast", "brute", parameters, bruteNs, bruteTotal, 0ul);
+      ::Record(
+        "entity-raycast", "broadphase", parameters, broadphaseNs
+      , broadphaseTotal, mismatches
+      );
+    }
+
+    for (float const radius : { 16.0f, 64.0f, 256.0f }) {
+      std::vector<pul::physics::IntersectorCircle> circles;
+      circles.reserve(count);
+      for (size_t i = 0ul; i < count; ++ i) {
+        circles.emplace_back(
+          pul::physics::IntersectorCircle {
+            glm::round(glm::vec2(originX(rng), originY(rng))), radius
+          }
+        );
+      }
+
+      std::vector<size_t> bruteHits(count), broadphaseHits(count);
+
+      double const bruteNs =
+        ::TimeNsPerQuery(count, [&](size_t i) {
+          glm::vec2 const circleOrigin = glm::vec2(circles[i].origin);
+
+          size_t hits = 0ul;
+          for (auto const & record : broadphase.records) {
+            glm::vec2 closestOrigin;
+            hits +=
+              pul::physics::IntersectionCircleAabb(
+                circleOrigin, circles[i].radius
+              , record.aabbOrigin, record.aabbDimensions
+              , closestOrigin
+              );
+          }
+          bruteHits[i] = hits;
+        });
+
+      double const broadphaseNs =
+        ::TimeNsPerQuery(count, [&](size_t i) {
+          pul::physics::EntityIntersectionCircle(
+            broadphase, circles[i], results
+          );
+          broadphaseHits[i] = results.entities.size();
+        });
+
+      size_t bruteTotal = 0ul, broadphaseTotal = 0ul, mismatches = 0ul;
+      for (size_t i = 0ul; i < count; ++ i) {
+        bruteTotal += bruteHits[i];
+        broadphaseTotal += broadphaseHits[i];
+        mismatches += bruteHits[i] != broadphaseHits[i];
+      }
+
+      auto const parameters =
+        fmt::format("entities={} radius={}", entityCount, radius);
+      ::Record("entity-circle", "brute", parameters, bruteNs, bruteTotal, 0ul);
+      ::Record(
+        "entity-circle", "broadphase", parameters, broadphaseNs
+      , broadphaseTotal, mismatches
+      );
+    }
+  }
+}
+
+// entities are placed along rays with more of them than a ray can keep hits
+// of, each ray has to pierce them nearest first & drop the furthest ones once
+// full, the same whichever way it's cast. Returns the mismatches
+size_t BenchmarkPiercing(std::mt19937 & rng, size_t const count) {
+  size_t constexpr lineCount = 64ul;
+  size_t constexpr entitiesPerLine =
+    pul::physics::EntityRaycastHits::capacity + 4ul;
+  glm::vec2 constexpr dimensions = glm::vec2(12.0f);
+
+  std::uniform_real_distribution<float>
+    originX(-4096.0f, 4096.0f)
+  , angle(0.0f, 2.0f*pul::Pi)
+  , spacing(40.0f, 160.0f)
+  ;
+
+  struct Line {
+    pul::physics::IntersectorRay ray;
+    // entities in the order the ray reaches them
+    std::vector<entt::entity> entities;
+    entt::entity ignoredEntity = entt::null;
+  };
+
+  pul::physics::EntityBroadphase broadphase;
+  std::vector<Line> lines(lineCount);
+
+  for (size_t lineIdx = 0ul; lineIdx < lineCount; ++ lineIdx) {
+    auto & line = lines[lineIdx];
+
+    // lines are far enough apart to never cross each other
+    glm::vec2 const begin =
+      glm::round(glm::vec2(originX(rng), static_cast<float>(lineIdx)*8192.0f));
+    float const theta = angle(rng);
+    glm::vec2 const direction = glm::vec2(glm::cos(theta), glm::sin(theta));
+
+    std::vector<float> distances;
+    float distance = 20.0f;
+    for (size_t it = 0ul; it < entitiesPerLine; ++ it) {
+      distances.emplace_back(distance);
+      distance += spacing(rng);
+    }
+
+    line.ray =
+      pul::physics::IntersectorRay::Construct(
+        begin, glm::round(begin + direction*(distance + 20.0f))
+      );
+
+    // entities are centered on the ray as it was rounded
+    glm::vec2 const
+      rayBegin = glm::vec2(line.ray.beginOrigin)
+    , rayNormal = glm::normalize(glm::vec2(line.ray.endOrigin) - rayBegin)
+    ;
+
+    // inserted out of order, so that the hits can't follow the records
+    std::vector<size_t> insertOrder(entitiesPerLine);
+    for (size_t it = 0ul; it < entitiesPerLine; ++ it) { insertOrder[it] = it; }
+    std::shuffle(insertOrder.begin(), insertOrder.end(), rng);
+
+    for (size_t const it : insertOrder) {
+      broadphase.Update(
+        static_cast<entt::entity>(lineIdx*entitiesPerLine + it)
+      , rayBegin + rayNormal*distances[it], dimensions
+      );
+    }
+
+    for (size_t it = 0ul; it < entitiesPerLine; ++ it) {
+      line.entities.emplace_back(
+        static_cast<entt::entity>(lineIdx*entitiesPerLine + it)
+      );
+    }
+
+    // every other line ignores one of its entities, as the shooter would be
+    if (lineIdx % 2ul) {
+      line.ignoredEntity = line.entities[2];
+      line.entities.erase(line.entities.begin() + 2);
+    }
+  }
+
+  size_t totalMismatches = 0ul;
+
+  for (size_t const maxHits : { 1ul, 3ul, 8ul, entitiesPerLine }) {
+    size_t const keptHits =
+      std::min(maxHits, pul::physics::EntityRaycastHits::capacity);
+
+    pul::physics::EntityRaycastHits hits;
+    hits.maxHits = maxHits;
+
+    // -- both directions of every line
+    size_t totalHits = 0ul, mismatches = 0ul;
+    for (auto const & line : lines)
+    for (bool const reversed : { false, true }) {
+      auto ray = line.ray;
+      auto entities = line.entities;
+      if (reversed) {
+        std::swap(ray.beginOrigin, ray.endOrigin);
+        std::reverse(entities.begin(), entities.end());
+      }
+
+      pul::physics::EntityIntersectionRaycastNearest(
+        broadphase, ray, line.ignoredEntity, hits
+      );
+      totalHits += hits.size;
+
+      bool matches = hits.size == keptHits;
+      for (size_t it = 0ul; matches && it < hits.size; ++ it) {
+        matches =
+            hits.hits[it].entity == entities[it]
+         && (it == 0ul || hits.hits[it-1ul].distance <= hits.hits[it].distance)
+        ;
+      }
+
+      if (!matches) {
+        spdlog::error(
+          "piercing ray ({}, {}) .. ({}, {}) max hits {} kept {} hits"
+        , ray.beginOrigin.x, ray.beginOrigin.y
+        , ray.endOrigin.x, ray.endOrigin.y
+        , maxHits, hits.size
+        );
+      }
+
+      mismatches += !matches;
+    }
+
+    double const ns =
+      ::TimeNsPerQuery(count, [&](size_t i) {
+        auto const & line = lines[i % lineCount];
+        pul::physics::EntityIntersectionRaycastNearest(
+          broadphase, line.ray, line.ignoredEntity, hits
+        );
+      });
+
+    ::Record(
+      "entity-pierce", "broadphase", fmt::format("max-hits={}", maxHits), ns
+    , totalHits, mismatches
+    );
+    totalMismatches += mismatches;
+  }
+
+  return totalMismatches;
+}
+
+// a player-only layer is placed over the map, overlapping its tiles. Filtered
+// queries on the combined layer are compared against separately built layers;
+// projectiles only see the original map, players everything
+void BenchmarkChannels(
+  std::mt19937 & rng, BenchMap const & map, size_t const count
+) {
+  using Channel = pul::core::CollisionChannel;
+
+  BenchMap combined = map, merged = map;
+
+  std::uniform_int_distribution<int32_t>
+    tileX(map.layer.tileMin.x, map.layer.tileMax.x)
+  , tileY(map.layer.tileMin.y, map.layer.tileMax.y)
+  ;
+  std::uniform_int_distribution<size_t>
+    tileDistribution(0ul, map.tilesets[0].tiles.size()-1ul);
+
+  auto & playerTiles = combined.PlacementsOf(0ul, Channel::Player);
+  auto & mergedTiles = merged.PlacementsOf(0ul, Channel::All);
+
+  size_t const tileCount =
+      static_cast<size_t>(map.layer.tileMax.x - map.layer.tileMin.x + 1)
+    * static_cast<size_t>(map.layer.tileMax.y - map.layer.tileMin.y + 1)
+    / 8ul;
+
+  for (size_t i = 0ul; i < tileCount; ++ i) {
+    size_t const tileIdx = tileDistribution(rng);
+    glm::i32vec2 const origin = glm::i32vec2(tileX(rng), tileY(rng));
+
+    for (auto * placements : { &playerTiles, &mergedTiles }) {
+      placements->tileIndices.emplace_back(tileIdx);
+      placements->tileOrigins.emplace_back(origin);
+      placements->tileOrientations.emplace_back(
+        pul::core::TileOrientation::None
+      );
+    }
+  }
+
+  combined.ConstructLayer();
+  merged.ConstructLayer();
+
+  size_t mixedTiles = 0ul;
+  for (auto const & tile : combined.layer.orientedTiles)
+    { mixedTiles += tile.Mixed(); }
+  spdlog::info(
+    "channels | {} player-only tiles, {} of {} oriented tiles mixed"
+  , tileCount, mixedTiles, combined.layer.orientedTiles.size()
+  );
+
+  auto const rays = ::RandomRays(rng, map.layer, count, 256.0f);
+
+  auto const benchmark =
+    [&](
+      Channel const channels, pul::physics::TilemapLayer const & reference
+    ) {
+      std::vector<pul::physics::IntersectionResults>
+        referenceResults(count), results(count);
+
+      double const referenceNs =
+        ::TimeNsPerQuery(count, [&](size_t i) {
+          pul::physics::IntersectionRaycast(
+            reference, rays[i], referenceResults[i]
+          );
+        });
+
+      double const filteredNs =
+        ::TimeNsPerQuery(count, [&](size_t i) {
+          pul::physics::IntersectionRaycast(
+            combined.layer, rays[i], results[i], channels
+          );
+        });
+
+      size_t referenceHits = 0ul, hits = 0ul, mismatches = 0ul;
+      for (size_t i = 0ul; i < count; ++ i) {
+        referenceHits += referenceResults[i].collision;
+        hits += results[i].collision;
+        mismatches +=
+            referenceResults[i].collision != results[i].collision
+         || referenceResults[i].origin != results[i].origin
+        ;
+      }
+
+      auto const parameters = fmt::format("channels={}", ToStr(channels));
+      ::Record(
+        "raycast-channels", "separate", parameters, referenceNs, referenceHits
+      , 0ul
+      );
+      ::Record(
+        "raycast-channels", "combined", parameters, filteredNs, hits
+      , mismatches
+      );
+    };
+
+  benchmark(Channel::Projectile, map.layer);
+  benchmark(Channel::Player, merged.layer);
+}
+
+} // -- anon namespace
+
+int main(int argc, char const ** argv) {
+  spdlog::set_pattern("%v");
+
+  auto options = ::StartupOptions();
+  options.parse_args(argc, argv);
+
+  auto const mapFilename = options.get<std::string>("-m");
+  auto const count = static_cast<size_t>(options.get<int>("-n"));
+  auto const format = options.get<std::string>("-f");
+  std::mt19937 rng(static_cast<uint32_t>(options.get<int>("-s")));
+
+  if (format != "text" && format != "json") {
+    spdlog::error("unknown output format '{}'", format);
+    return 1;
+  }
+
+  // only the records are written out as json, errors still get through
+  if (format == "json") { spdlog::set_level(spdlog::level::warn); }
+
+  BenchMap map;
+  if (mapFilename == "") {
+    map = ::SyntheticMap(rng);
+  } else if (!::LoadTiledMap(mapFilename, map)) {
+    return 1;
+  }
+
+  glm::i32vec2 const mapTiles = map.layer.tileMax - map.layer.tileMin + 1;
+  spdlog::info(
+    "map '{}' {}x{} tiles"
+  , mapFilename == "" ? "synthetic" : mapFilename
+  , mapTiles.x, mapTiles.y
+  );
+
+  // a dense array of 40 byte tile records is what the layer used to store
+  spdlog::info(
+    "tile records | dense {} KiB | chunked {} KiB ({} chunks)"
+  , static_cast<size_t>(mapTiles.x) * mapTiles.y * 40ul / 1024ul
+  , (
+      map.layer.chunks.size() * sizeof(pul::physics::TilemapLayer::Chunk)
+    + map.layer.chunkTable.size() * sizeof(uint32_t)
+    ) / 1024ul
+  , map.layer.chunks.size()
+  );
+
+  ::BenchmarkPoints(rng, map, count);
+  ::BenchmarkRaycasts(rng, map.layer, count);
+  ::BenchmarkDiagonalRaycasts(rng, map.layer, count);
+  ::BenchmarkEntities(rng, map.layer, count);
+  ::BenchmarkChannels(rng, map, count);
+
+  // placed last so the other benchmarks keep their queries for a given seed
+  size_t const piercingMismatches = ::BenchmarkPiercing(rng, count);
+
+  if (format == "json") {
+    ::OutputRecordsJson(mapFilename == "" ? "synthetic" : mapFilename, count);
+  } else {
+    ::OutputRecordsText();
+  }
+
+  // the hit order of piercing rays is checked rather than compared against
+  // another implementation, so it fails the run
+  return piercingMismatches == 0ul ? 0 : 1;
+}
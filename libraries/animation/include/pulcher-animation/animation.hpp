@@ -2,11 +2,19 @@
 
 #include <pulcher-gfx/sokol.hpp>
 #include <pulcher-gfx/spritesheet.hpp>
+#include <pulcher-util/enum.hpp>
+#include <pulcher-util/job-pool.hpp>
 #include <pulcher-util/log.hpp>
 
+#include <algorithm>
+#include <array>
 #include <cstdint>
 #include <map>
 #include <memory>
+#include <span>
+#include <string_view>
+#include <thread>
+#include <utility>
 #include <vector>
 
 namespace pul::animation {
@@ -34,7 +42,10 @@ namespace pul::animation {
     Pieces are connected together using "parent" and thus they get
     skeletal-esque animation as their offsets are compounded together.
 
-  TODO change std::string to size_t and use std::hash
+  Piece & state labels are interned to indices of their animator when loaded,
+    so animating an instance only indexes arrays. Labels are kept sorted, thus
+    an index is only stable until pieces or states are added or removed (by
+    the editor), after which instances have to be reconstructed.
 
   */
 
@@ -84,6 +95,16 @@ namespace pul::animation {
     VariationType type;
   };
 
+  // pieces that gameplay drives every tick; animators resolve them once so
+  // that looking them up is indexing rather than a search over the labels
+  enum class GameplayPiece : size_t {
+    Particle
+  , Legs, Body, ArmBack, ArmFront, Head
+  , WeaponPlaceholder, Weapons
+  , Pickups, PickupBg
+  , Size
+  };
+
   struct Animator {
     // -- structs
     struct State {
@@ -115,10 +136,18 @@ namespace pul::animation {
     };
 
     struct Piece {
-      std::map<std::string, pul::animation::Animator::State> states = {};
+      // parallel, sorted by label
+      std::vector<std::string> stateLabels = {};
+      std::vector<pul::animation::Animator::State> states = {};
       glm::u32vec2 dimensions = {};
       glm::i32vec2 origin = {};
       int16_t renderDepth = 0; // valid from -127 .. 128
+
+      // -1ul if there is no state with the label
+      size_t StateIdx(std::string_view label) const;
+
+      // index of the state with the label, added if it doesn't exist yet
+      size_t InternState(std::string const & label);
     };
 
     struct SkeletalPiece {
@@ -127,20 +156,133 @@ namespace pul::animation {
       std::vector<SkeletalPiece> children = {};
     };
 
+    // a skeletal piece of the flattened skeleton
+    struct FlatSkeletal {
+      size_t pieceIdx = -1ul;
+      size_t parentIdx = -1ul; // -1ul for the roots of the skeleton
+      glm::i32vec2 origin = {};
+      size_t vertexOffset = 0ul; // of the piece's vertices in an instance
+    };
+
     // -- members
     pul::gfx::Spritesheet spritesheet;
-    std::map<std::string, pul::animation::Animator::Piece> pieces;
+    // parallel, sorted by label
+    std::vector<std::string> pieceLabels;
+    std::vector<pul::animation::Animator::Piece> pieces;
     std::vector<SkeletalPiece> skeleton;
+    // the skeleton in depth-first order, so every skeletal comes after its
+    // parent & updating is a single pass; built by ResolveSkeleton
+    std::vector<FlatSkeletal> flatSkeleton;
     glm::uvec2 uvCoordOffset = glm::uvec2(0);
     std::string label;
     std::string filename;
+
+    // -1ul for gameplay pieces the animator doesn't have; built by
+    // ResolveSkeleton
+    std::array<size_t, Idx(GameplayPiece::Size)> gameplayPieceIndices =
+      [] {
+        std::array<size_t, Idx(GameplayPiece::Size)> indices;
+        indices.fill(-1ul);
+        return indices;
+      }();
+
+    // -- functions
+    // -1ul if there is no piece with the label
+    size_t PieceIdx(std::string_view pieceLabel) const;
+
+    // index of the piece with the label, added if it doesn't exist yet
+    size_t InternPiece(std::string const & pieceLabel);
+
+    // has to be called after the skeleton or pieces changed, the skeleton
+    // interns the pieces it's missing & is flattened again, and the gameplay
+    // pieces are resolved again
+    void ResolveSkeleton();
+  };
+
+  // a skeletal piece as a single record, which the vertex shader expands into
+  // the quad corners origin + axisX*v.x + axisY*v.y (and likewise for the uv
+  // coords) for v of the unit quad. Vertex wrapping & flips are folded into
+  // the axes, an invisible piece has no extent
+  struct PieceRecord {
+    glm::vec2 origin = glm::vec2(0.0f);
+    glm::vec2 axisX = glm::vec2(0.0f);
+    glm::vec2 axisY = glm::vec2(0.0f);
+    glm::vec2 uvCoordOrigin = glm::vec2(0.0f);
+    glm::vec2 uvCoordAxis = glm::vec2(0.0f);
+    float depth = 0.0f;
   };
 
+  struct Instance;
+
   struct System {
     std::map<std::string, std::shared_ptr<Animator>> animators;
 
     sg_pipeline sgPipeline;
     sg_shader sgProgram;
+
+    // expands piece records into quads with one instance per piece
+    sg_pipeline sgPipelineInstanced;
+    sg_shader sgProgramInstanced;
+
+    // whether pieces are streamed as records instead of six vertices each,
+    // instancedPieces follows useInstancedPieces on the next update
+    bool useInstancedPieces = true;
+    bool instancedPieces = true;
+
+    // visible instances that share a spritesheet are drawn together
+    struct Batch {
+      sg_image image = {};
+      glm::vec2 resolution = {};
+      std::vector<Instance *> instances = {};
+      // of vertices, or of piece records if instanced
+      size_t elementBegin = 0ul;
+      size_t elementCount = 0ul;
+    };
+
+    // every frame the vertices of all batches are baked with their instance
+    // origin into a single stream, uploaded once & drawn once per batch.
+    // Batches & vertex vectors are kept around to reuse their allocations
+    std::vector<Batch> batches = {};
+    std::vector<glm::vec3> batchOrigins = {};
+    std::vector<glm::vec2> batchUvCoords = {};
+    std::vector<PieceRecord> batchPieceRecords = {};
+    pul::gfx::SgBuffer sgBufferOrigin = {};
+    pul::gfx::SgBuffer sgBufferUvCoord = {};
+    pul::gfx::SgBuffer sgBufferPieceRecord = {};
+    size_t sgBufferCapacity = 0ul; // in vertices
+    size_t sgBufferPieceRecordCapacity = 0ul;
+    size_t bakeFrame = 0ul;
+
+    // destroyed instances by animator & vertex count; their containers are
+    // handed to new instances of the same kind, so short-lived particles
+    // don't allocate once the pool has grown to their peak count. Pooled
+    // instances keep their animator alive, so keys can't be reused, but they
+    // go stale once the animator is rebuilt & are cleared with it. Instances
+    // destroyed while their bucket is full are freed instead
+    std::map<
+      std::pair<Animator const *, size_t>, std::vector<Instance>
+    > instancePool = {};
+    size_t instancePoolBucketCapacity = 256ul;
+    size_t instancesReused = 0ul;
+    size_t instancesAllocated = 0ul;
+
+    // instances are updated in chunks on the job pool, by the main thread &
+    // updateWorkerCount workers; the pool follows it on the next update. The
+    // pool is rebuilt by the plugin & torn down with the system on shutdown
+    size_t updateWorkerCount =
+      std::max(std::thread::hardware_concurrency(), 1u) - 1u;
+    pul::util::JobPool updateJobPool = {};
+    std::vector<Instance *> updateInstances = {};
+
+    // of the last rendered frame, for diagnostics
+    size_t drawCalls = 0ul;
+    size_t drawnInstances = 0ul;
+    size_t elementsUploaded = 0ul;
+
+    // of the last updated frame, for diagnostics
+    size_t piecesRecomputed = 0ul;
+    size_t piecesSkipped = 0ul;
+    double updateMs = 0.0;
   };
 
   struct Instance {
@@ -148,7 +290,7 @@ namespace pul::animation {
     std::shared_ptr<Animator> animator = {};
 
     struct StateInfo {
-      std::string label;
+      size_t stateIdx = -1ul;
       float deltaTime = 0.0f;
       size_t componentIt = 0ul;
       float angle = 0.0f;
@@ -161,16 +303,55 @@ namespace pul::animation {
       bool flipVertWrap = false;
 
       std::shared_ptr<Animator> animator;
-      std::string pieceLabel;
+      size_t pieceIdx = -1ul;
 
       VariationRuntimeInfo variationRti = {};
 
       glm::mat3 cachedLocalSkeletalMatrix = glm::mat3(0.0f);
 
-      void Apply(std::string const & nLabel, bool force = false);
+      // everything the vertices of the piece were last computed from, they
+      // are only recomputed once any of it changes; frame advances, applied
+      // states, angle & flip (through the tile & skeletal matrix), wrapping &
+      // visibility. The origin of the instance is applied when batching
+      struct VertexInputs {
+        glm::mat3 localSkeletalMatrix = glm::mat3(0.0f);
+        glm::vec2 uvCoordWrap = glm::vec2(0.0f);
+        glm::vec2 vertWrap = glm::vec2(0.0f);
+        glm::u32vec2 tile = {};
+        glm::u32vec2 dimensions = {};
+        glm::uvec2 uvCoordOffset = {};
+        int16_t renderDepth = 0;
+        bool uvFlip = false;
+        bool flipVertWrap = false;
+        bool visible = false;
+        bool hasComponent = false;
+
+        bool operator==(VertexInputs const &) const = default;
+      };
+
+      VertexInputs vertexInputs = {};
+
+      // label of the current state, empty if the piece has no states
+      std::string const & Label() const;
+
+      void Apply(size_t nStateIdx, bool force = false);
+      void Apply(std::string_view nLabel, bool force = false);
     };
 
-    std::map<std::string, StateInfo> pieceToState = {};
+    // indexed by the pieces of the animator
+    std::vector<StateInfo> pieceToState = {};
+
+    // state of the piece with the label, searched for on every call; pieces
+    // looked up every tick should be a GameplayPiece instead
+    StateInfo & PieceState(std::string_view pieceLabel);
+
+    // state of a piece resolved by the animator, without any search
+    StateInfo & PieceState(GameplayPiece piece);
+
+    // handed out for pieces the animator doesn't have, so that callers don't
+    // have to check; the first miss of the instance is reported
+    StateInfo unknownPieceState = {};
+    bool reportedUnknownPiece = false;
 
     // if set to false, the matrix will no longer be recalculated every render
     // frame. This allows an animation matrix to not have to be set every frame
@@ -180,18 +361,56 @@ namespace pul::animation {
 
     glm::vec2 origin = glm::vec2(0.0);
 
-    std::unique_ptr<pul::gfx::SgBuffer> sgBufferOrigin = {};
-    std::unique_ptr<pul::gfx::SgBuffer> sgBufferUvCoord = {};
-    sg_bindings sgBindings = {};
+    // vertices of the instance, relative to its origin
     size_t drawCallCount = 0ul;
 
+    // set whenever a piece recomputes its vertices; otherwise the batch stream
+    // still holds them if they were baked there last frame at the same origin
+    bool verticesDirty = true;
+    size_t bakedFrame = -1ul;
+    size_t bakedElementBegin = -1ul;
+    glm::vec2 bakedOrigin = glm::vec2(0.0f);
+
     bool visible = true;
 
-    // keep origin/uv coord buffer data around for streaming updates
+    // streamed into the batch of the spritesheet when rendering, either the
+    // vertices or a record per piece depending on System::instancedPieces
     std::vector<glm::vec2> uvCoordBufferData = {};
     std::vector<glm::vec3> originBufferData = {};
+    std::vector<PieceRecord> pieceRecords = {};
+
+    // what's accumulated down the skeleton while updating, parallel to
+    // Animator::flatSkeleton
+    struct SkeletalAccumulator {
+      glm::mat3 matrix = glm::mat3(1.0f);
+      float rotation = 0.0f;
+      bool flip = false;
+    };
+    std::vector<SkeletalAccumulator> skeletalAccumulators = {};
   };
 
+  // the six vertices of a piece, relative to the origin of its instance
+  void ComputePieceVertices(
+    Instance::StateInfo::VertexInputs const & inputs
+  , glm::vec2 const & invResolution
+  , std::span<glm::vec2, 6ul> uvCoords
+  , std::span<glm::vec3, 6ul> origins
+  );
+
+  // the piece as a record that expands into the same vertices
+  PieceRecord PackPieceRecord(
+    Instance::StateInfo::VertexInputs const & inputs
+  , glm::vec2 const & invResolution
+  );
+
+  // the vertex shader's expansion of a record, vertex is of the unit quad
+  glm::vec3 ExpandPieceRecordOrigin(
+    PieceRecord const & record, glm::vec2 const & vertex
+  );
+  glm::vec2 ExpandPieceRecordUvCoord(
+    PieceRecord const & record, glm::vec2 const & vertex
+  );
+
   struct ComponentInstance {
     pul::animation::Instance instance;
   };
@@ -199,3 +418,4 @@ namespace pul::animation {
 }
 
 char const * ToStr(pul::animation::VariationType type);
+char const * ToStr(pul::animation::GameplayPiece piece);
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <pulcher-animation/animation.hpp>
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// -- loading of animators, either from the spritesheet json files the editor
+//    saves or from a binary database compiled from them. Shared by the
+//    animation plugin and tools that have to load animations the same way.
+//    Neither loads the spritesheet images, they are only named by
+//    spritesheet.filename so that the caller can construct them
+
+namespace pul::animation {
+
+  // bumped whenever the layout of the database changes
+  uint32_t constexpr DatabaseVersion = 1u;
+
+  // loads the animators of every spritesheet json file listed by the data
+  // file. Returns the files that were read, the data file first, empty if the
+  // data file couldn't be loaded
+  std::vector<std::string> LoadAnimatorsJson(
+    std::string const & dataFilename
+  , std::map<std::string, std::shared_ptr<Animator>> & animators
+  );
+
+  // 64-bit FNV-1a of the contents of the file, 0 if it can't be read
+  uint64_t HashFile(std::string const & filename);
+
+  // compiles the animators into flat tables of a binary database, along with
+  // the hashes of the source files they were loaded from. Nothing is written
+  // if there are no sources or any of them can't be read
+  bool WriteAnimatorDatabase(
+    std::string const & filename
+  , std::map<std::string, std::shared_ptr<Animator>> const & animators
+  , std::vector<std::string> const & sourceFilenames
+  );
+
+  // memory-maps the database & builds the animators straight from its tables.
+  // Fails without touching the animators if the database is missing, of
+  // another version, malformed or any of its source files changed since it
+  // was written
+  bool LoadAnimatorDatabase(
+    std::string const & filename
+  , std::map<std::string, std::shared_ptr<Animator>> & animators
+  );
+}
@@ -1,7 +1,101 @@
 #include <pulcher-animation/animation.hpp>
 
+#include <pulcher-util/consts.hpp>
 #include <pulcher-util/log.hpp>
 
+#include <algorithm>
+
+namespace {
+
+// labels are sorted, so lookups are binary searches
+size_t LabelIdx(
+  std::vector<std::string> const & labels, std::string_view const label
+) {
+  auto const it = std::lower_bound(labels.begin(), labels.end(), label);
+  if (it == labels.end() || *it != label) { return -1ul; }
+  return static_cast<size_t>(it - labels.begin());
+}
+
+// inserts the label at its sorted position along with a default element
+template <typename T> size_t InternLabel(
+  std::vector<std::string> & labels, std::vector<T> & elements
+, std::string const & label
+) {
+  auto const it = std::lower_bound(labels.begin(), labels.end(), label);
+  size_t const idx = static_cast<size_t>(it - labels.begin());
+  if (it != labels.end() && *it == label) { return idx; }
+
+  labels.insert(it, label);
+  elements.insert(elements.begin() + idx, T{});
+  return idx;
+}
+
+void FlattenSkeleton(
+  pul::animation::Animator & animator
+, std::vector<pul::animation::Animator::SkeletalPiece> const & skeletals
+, size_t const parentIdx
+) {
+  for (auto const & skeletal : skeletals) {
+    size_t const skeletalIdx = animator.flatSkeleton.size();
+
+    pul::animation::Animator::FlatSkeletal flatSkeletal;
+    flatSkeletal.pieceIdx = animator.PieceIdx(skeletal.label);
+    flatSkeletal.parentIdx = parentIdx;
+    flatSkeletal.origin = skeletal.origin;
+    flatSkeletal.vertexOffset = skeletalIdx*6ul;
+    animator.flatSkeleton.emplace_back(flatSkeletal);
+
+    ::FlattenSkeleton(animator, skeletal.children, skeletalIdx);
+  }
+}
+
+void InternSkeleton(
+  pul::animation::Animator & animator
+, std::vector<pul::animation::Animator::SkeletalPiece> const & skeletals
+) {
+  for (auto const & skeletal : skeletals) {
+    animator.InternPiece(skeletal.label);
+    ::InternSkeleton(animator, skeletal.children);
+  }
+}
+
+} // -- namespace
+
+size_t pul::animation::Animator::Piece::StateIdx(
+  std::string_view const label
+) const {
+  return ::LabelIdx(stateLabels, label);
+}
+
+size_t pul::animation::Animator::Piece::InternState(
+  std::string const & label
+) {
+  return ::InternLabel(stateLabels, states, label);
+}
+
+size_t pul::animation::Animator::PieceIdx(
+  std::string_view const pieceLabel
+) const {
+  return ::LabelIdx(pieceLabels, pieceLabel);
+}
+
+size_t pul::animation::Animator::InternPiece(std::string const & pieceLabel) {
+  return ::InternLabel(pieceLabels, pieces, pieceLabel);
+}
+
+void pul::animation::Animator::ResolveSkeleton() {
+  // interning can shift indices, so resolve only once every piece exists
+  ::InternSkeleton(*this, skeleton);
+
+  flatSkeleton.clear();
+  ::FlattenSkeleton(*this, skeleton, -1ul);
+
+  for (size_t it = 0ul; it < Idx(GameplayPiece::Size); ++ it) {
+    gameplayPieceIndices[it] =
+      this->PieceIdx(ToStr(static_cast<GameplayPiece>(it)));
+  }
+}
+
 size_t pul::animation::Animator::State::VariationIdxLookup(
   VariationRuntimeInfo const & variationRti
 ) {
@@ -53,18 +147,36 @@ pul::animation::Animator::State::ComponentLookup(
   }
 }
 
+std::string const & pul::animation::Instance::StateInfo::Label() const {
+  static std::string const empty = "";
+  if (stateIdx == -1ul) { return empty; }
+  return animator->pieces[pieceIdx].stateLabels[stateIdx];
+}
+
+void pul::animation::Instance::StateInfo::Apply(
+  std::string_view const nLabel, bool force
+) {
+  // scratch states of unknown pieces, already reported by PieceState
+  if (pieceIdx == -1ul) { return; }
+
+  // unknown labels leave the piece without a state, so nothing is rendered
+  this->Apply(animator->pieces[pieceIdx].StateIdx(nLabel), force);
+}
+
 void pul::animation::Instance::StateInfo::Apply(
-  std::string const & nLabel, bool force
+  size_t const nStateIdx, bool force
 ) {
-  if (!force && label == nLabel) { return; }
-  label = nLabel;
+  if (!force && stateIdx == nStateIdx) { return; }
+  stateIdx = nStateIdx;
   deltaTime = 0.0f;
   componentIt = 0ul;
   animationFinished = false;
 
   variationRti = {};
 
-  auto const & state = animator->pieces[pieceLabel].states[label];
+  if (stateIdx == -1ul) { return; }
+
+  auto const & state = animator->pieces[pieceIdx].states[stateIdx];
 
   switch (state.variationType) {
     default: spdlog::error("variation type default"); break;
@@ -78,6 +190,157 @@ void pul::animation::Instance::StateInfo::Apply(
   }
 }
 
+pul::animation::Instance::StateInfo &
+pul::animation::Instance::PieceState(std::string_view const pieceLabel) {
+  size_t const pieceIdx = animator ? animator->PieceIdx(pieceLabel) : -1ul;
+  if (pieceIdx < pieceToState.size()) { return pieceToState[pieceIdx]; }
+
+  if (!reportedUnknownPiece) {
+    spdlog::error(
+      "no piece '{}' for '{}'"
+    , pieceLabel, animator ? animator->label : animatorLabel
+    );
+    reportedUnknownPiece = true;
+  }
+
+  // written by the caller, so it's cleared on every miss
+  unknownPieceState = {};
+  return unknownPieceState;
+}
+
+pul::animation::Instance::StateInfo &
+pul::animation::Instance::PieceState(
+  pul::animation::GameplayPiece const piece
+) {
+  size_t const pieceIdx =
+    animator ? animator->gameplayPieceIndices[Idx(piece)] : -1ul;
+  if (pieceIdx < pieceToState.size()) { return pieceToState[pieceIdx]; }
+
+  // the label search reports the miss
+  return this->PieceState(std::string_view{ToStr(piece)});
+}
+
+void pul::animation::ComputePieceVertices(
+  pul::animation::Instance::StateInfo::VertexInputs const & inputs
+, glm::vec2 const & invResolution
+, std::span<glm::vec2, 6ul> uvCoords
+, std::span<glm::vec3, 6ul> origins
+) {
+  // if there are no components to render, output a degenerate tile
+  if (!inputs.hasComponent) {
+    for (size_t it = 0ul; it < 6ul; ++ it) {
+      uvCoords[it] = glm::vec2(-1);
+      origins[it] = glm::vec3(-1);
+    }
+    return;
+  }
+
+  auto const pieceDimensions = glm::vec2(inputs.dimensions);
+
+  for (size_t it = 0ul; it < 6ul; ++ it) {
+    auto v = pul::util::TriangleVertexArray()[it];
+    auto uv = v;
+
+    // apply uv clipping/wrapping if requested (non 1.0 value)
+    uv *= inputs.uvCoordWrap;
+    v  *= inputs.vertWrap;
+
+    if (inputs.flipVertWrap) {
+      v = glm::vec2(1.0f) - v;
+    }
+
+    // flip uv coords if requested
+    if (inputs.uvFlip) { uv.x = 1.0f - uv.x; }
+
+    uvCoords[it] =
+      (
+          (uv*pieceDimensions + glm::vec2(inputs.tile)*pieceDimensions)
+        + glm::vec2(inputs.uvCoordOffset)
+      )
+      * invResolution
+    ;
+
+    auto origin = glm::vec3(v*pieceDimensions, 1.0f);
+
+    origin = inputs.localSkeletalMatrix * origin;
+
+    // produce degenerate triangle if not visible
+    if (!inputs.visible)
+      { origin = glm::vec3(-99999.0f); }
+
+    origins[it] =
+      glm::vec3(origin.x, origin.y, static_cast<float>(inputs.renderDepth));
+  }
+}
+
+pul::animation::PieceRecord pul::animation::PackPieceRecord(
+  pul::animation::Instance::StateInfo::VertexInputs const & inputs
+, glm::vec2 const & invResolution
+) {
+  pul::animation::PieceRecord record;
+
+  // degenerate tile, same as the vertices
+  if (!inputs.hasComponent) {
+    record.origin = glm::vec2(-1.0f);
+    record.uvCoordOrigin = glm::vec2(-1.0f);
+    record.depth = -1.0f;
+    return record;
+  }
+
+  auto const pieceDimensions = glm::vec2(inputs.dimensions);
+  auto const & matrix = inputs.localSkeletalMatrix;
+
+  if (inputs.visible) {
+    // wrapping scales the quad, flipping mirrors it around its far corner
+    glm::vec2 const extent =
+      inputs.vertWrap * pieceDimensions * (inputs.flipVertWrap ? -1.0f : 1.0f);
+
+    record.origin = glm::vec2(matrix[2]);
+    record.axisX = glm::vec2(matrix[0]) * extent.x;
+    record.axisY = glm::vec2(matrix[1]) * extent.y;
+
+    if (inputs.flipVertWrap) {
+      record.origin +=
+        glm::vec2(matrix[0]) * pieceDimensions.x
+      + glm::vec2(matrix[1]) * pieceDimensions.y
+      ;
+    }
+  } else {
+    record.origin = glm::vec2(-99999.0f);
+  }
+
+  glm::vec2 uvCoordOrigin =
+    glm::vec2(inputs.tile)*pieceDimensions + glm::vec2(inputs.uvCoordOffset);
+  glm::vec2 uvCoordAxis = inputs.uvCoordWrap * pieceDimensions;
+
+  if (inputs.uvFlip) {
+    uvCoordOrigin.x += pieceDimensions.x;
+    uvCoordAxis.x = -uvCoordAxis.x;
+  }
+
+  record.uvCoordOrigin = uvCoordOrigin * invResolution;
+  record.uvCoordAxis = uvCoordAxis * invResolution;
+  record.depth = static_cast<float>(inputs.renderDepth);
+
+  return record;
+}
+
+glm::vec3 pul::animation::ExpandPieceRecordOrigin(
+  pul::animation::PieceRecord const & record, glm::vec2 const & vertex
+) {
+  return
+    glm::vec3(
+      record.origin + record.axisX*vertex.x + record.axisY*vertex.y
+    , record.depth
+    );
+}
+
+glm::vec2 pul::animation::ExpandPieceRecordUvCoord(
+  pul::animation::PieceRecord const & record, glm::vec2 const & vertex
+) {
+  return record.uvCoordOrigin + record.uvCoordAxis*vertex;
+}
+
 char const * ToStr(pul::animation::VariationType type) {
   switch (type) {
     default: return "n/a";
@@ -87,6 +350,23 @@ char const * ToStr(pul::animation::VariationType type) {
   }
 }
 
+char const * ToStr(pul::animation::GameplayPiece piece) {
+  switch (piece) {
+    default: return "n/a";
+    case pul::animation::GameplayPiece::Particle: return "particle";
+    case pul::animation::GameplayPiece::Legs: return "legs";
+    case pul::animation::GameplayPiece::Body: return "body";
+    case pul::animation::GameplayPiece::ArmBack: return "arm-back";
+    case pul::animation::GameplayPiece::ArmFront: return "arm-front";
+    case pul::animation::GameplayPiece::Head: return "head";
+    case pul::animation::GameplayPiece::WeaponPlaceholder:
+      return "weapon-placeholder";
+    case pul::animation::GameplayPiece::Weapons: return "weapons";
+    case pul::animation::GameplayPiece::Pickups: return "pickups";
+    case pul::animation::GameplayPiece::PickupBg: return "pickup-bg";
+  }
+}
+
 pul::animation::VariationType pul::animation::ToVariationType(
   char const * label
 ) {
@@ -0,0 +1,993 @@
+#include <pulcher-animation/database.hpp>
+
+#include <pulcher-util/log.hpp>
+
+#include <cjson/cJSON.h>
+
+#if defined(__unix__)
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#elif defined(_WIN32) || defined(_WIN64)
+  #include <fileapi.h>
+  #include <handleapi.h>
+  #include <memoryapi.h>
+#endif
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <string_view>
+#include <type_traits>
+
+namespace {
+
+// -----------------------------------------------------------------------------
+// -- json ---------------------------------------------------------------------
+
+void JsonParseRecursiveSkeleton(
+  cJSON * skeletalParentJson
+, std::vector<pul::animation::Animator::SkeletalPiece> & skeletals
+) {
+  if (!skeletalParentJson) { return; }
+  cJSON * skeletalChildJson;
+  cJSON_ArrayForEach(
+    skeletalChildJson
+  , cJSON_GetObjectItemCaseSensitive(skeletalParentJson, "skeleton")
+  ) {
+    pul::animation::Animator::SkeletalPiece skeletal;
+    skeletal.label =
+      cJSON_GetObjectItemCaseSensitive(skeletalChildJson, "label")->valuestring;
+    skeletal.origin.x =
+      cJSON_GetObjectItemCaseSensitive(skeletalChildJson, "origin-x")->valueint;
+    skeletal.origin.y =
+      cJSON_GetObjectItemCaseSensitive(skeletalChildJson, "origin-y")->valueint;
+    JsonParseRecursiveSkeleton(skeletalChildJson, skeletal.children);
+    skeletals.emplace_back(std::move(skeletal));
+  }
+}
+
+std::vector<pul::animation::Component> JsonLoadComponents(
+  cJSON * componentsJson
+) {
+  std::vector<pul::animation::Component> components;
+
+  cJSON * componentJson;
+  cJSON_ArrayForEach(componentJson, componentsJson) {
+    pul::animation::Component component;
+    component.tile.x =
+      cJSON_GetObjectItemCaseSensitive(componentJson, "x")->valueint;
+
+    component.tile.y =
+      cJSON_GetObjectItemCaseSensitive(componentJson, "y")->valueint;
+
+    component.msDeltaTimeOverride =
+      cJSON_GetObjectItemCaseSensitive(componentJson, "ms-delta-time-override")
+        ->valueint;
+
+    if (
+      auto offX =
+        cJSON_GetObjectItemCaseSensitive(componentJson, "origin-offset-x")
+    ) {
+      component.originOffset.x = offX->valueint;
+    }
+
+    if (
+      auto offY =
+        cJSON_GetObjectItemCaseSensitive(componentJson, "origin-offset-y")
+    ) {
+      component.originOffset.y = offY->valueint;
+    }
+
+    components.emplace_back(component);
+  }
+
+  return components;
+}
+
+cJSON * LoadJsonFile(std::string const & filename) {
+  // load file
+  auto file = std::ifstream{filename};
+  if (file.eof() || !file.good()) {
+    spdlog::error("could not load spritesheet '{}'", filename);
+    return nullptr;
+  }
+
+  auto str =
+    std::string {
+      std::istreambuf_iterator<char>(file)
+    , std::istreambuf_iterator<char>()
+    };
+
+  auto fileDataJson = cJSON_Parse(str.c_str());
+
+  if (fileDataJson == nullptr) {
+    spdlog::critical(
+      " -- failed to parse json for '{}'; '{}'"
+    , filename
+    , cJSON_GetErrorPtr()
+    );
+  }
+
+  return fileDataJson;
+}
+
+void LoadAnimation(
+  std::string const & filename
+, std::map<
+    std::string
+  , std::shared_ptr<pul::animation::Animator>
+  > & animators
+) {
+
+  cJSON * fileDataJson = ::LoadJsonFile(filename);
+  if (!fileDataJson) { return; }
+
+  // iterate thru each spritesheet contained in file
+  cJSON * sheetJson;
+  cJSON_ArrayForEach(
+    sheetJson
+  , cJSON_GetObjectItemCaseSensitive(fileDataJson, "spritesheets")
+  ) {
+    auto animator = std::make_shared<pul::animation::Animator>();
+    animator->filename = filename;
+    animator->label =
+      std::string{
+        cJSON_GetObjectItemCaseSensitive(sheetJson, "label")->valuestring
+      };
+
+    animator->uvCoordOffset = {
+      cJSON_GetObjectItemCaseSensitive(sheetJson, "uv-offset-x")->valueint
+    , cJSON_GetObjectItemCaseSensitive(sheetJson, "uv-offset-y")->valueint
+    };
+
+    spdlog::debug("loading animation spritesheet '{}'", animator->label);
+    // store animator
+    animators[animator->label] = animator;
+
+    // the image is constructed by the caller
+    animator->spritesheet.filename =
+      cJSON_GetObjectItemCaseSensitive(sheetJson, "filename")->valuestring;
+
+    cJSON * pieceJson;
+    cJSON_ArrayForEach(
+      pieceJson, cJSON_GetObjectItemCaseSensitive(sheetJson, "animation-piece")
+    ) {
+      std::string pieceLabel =
+        cJSON_GetObjectItemCaseSensitive(pieceJson, "label")->valuestring;
+
+      pul::animation::Animator::Piece piece;
+
+      piece.dimensions.x =
+        cJSON_GetObjectItemCaseSensitive(pieceJson, "dimension-x")->valueint;
+      piece.dimensions.y =
+        cJSON_GetObjectItemCaseSensitive(pieceJson, "dimension-y")->valueint;
+
+      piece.origin.x =
+        cJSON_GetObjectItemCaseSensitive(pieceJson, "origin-x")->valueint;
+      piece.origin.y =
+        cJSON_GetObjectItemCaseSensitive(pieceJson, "origin-y")->valueint;
+
+      {
+        auto depth =
+          cJSON_GetObjectItemCaseSensitive(pieceJson, "render-order")->valueint;
+        if (depth < -127 || depth >= 127) {
+          spdlog::error(
+            "render-depth for '{}' of '{}' is OOB ({}); "
+            "range must be from -127 to 127"
+          , pieceLabel, animator->label, depth
+          );
+          depth = 0;
+        }
+        piece.renderDepth = depth;
+      }
+
+      cJSON * stateJson;
+      cJSON_ArrayForEach(
+        stateJson, cJSON_GetObjectItemCaseSensitive(pieceJson, "states")
+      ) {
+        std::string stateLabel =
+          cJSON_GetObjectItemCaseSensitive(stateJson, "label")->valuestring;
+
+        pul::animation::Animator::State state;
+
+        state.msDeltaTime =
+          cJSON_GetObjectItemCaseSensitive(
+            stateJson, "ms-delta-time"
+          )->valueint;
+
+        state.rotationMirrored =
+          cJSON_GetObjectItemCaseSensitive(stateJson, "rotation-mirrored")
+            ->valueint
+        ;
+
+        state.originInterpolates =
+          cJSON_GetObjectItemCaseSensitive(stateJson, "origin-interpolates")
+            ->valueint
+        ;
+
+        state.loops =
+          cJSON_GetObjectItemCaseSensitive(stateJson, "loops")
+            ->valueint
+        ;
+
+        state.rotatePixels =
+          cJSON_GetObjectItemCaseSensitive(stateJson, "rotate-pixels")
+            ->valueint
+        ;
+
+        state.flipXAxis =
+          cJSON_GetObjectItemCaseSensitive(stateJson, "flip-x-axis")
+            ->valueint
+        ;
+
+        cJSON * variationJson;
+        cJSON_ArrayForEach(
+          variationJson
+        , cJSON_GetObjectItemCaseSensitive(stateJson, "variations")
+        ) {
+          pul::animation::Variation variation;
+
+          state.variationType =
+            pul::animation::ToVariationType(
+              cJSON_GetObjectItemCaseSensitive(
+                stateJson, "variationType"
+              )->valuestring
+            );
+
+          switch (state.variationType) {
+            default: break;
+            case pul::animation::VariationType::Normal:
+              variation.normal.data =
+                ::JsonLoadComponents(
+                  cJSON_GetObjectItemCaseSensitive(variationJson, "default")
+                );
+            break;
+            case pul::animation::VariationType::Random:
+              variation.random.data =
+                ::JsonLoadComponents(
+                  cJSON_GetObjectItemCaseSensitive(variationJson, "default")
+                );
+            break;
+            case pul::animation::VariationType::Range:
+              variation.range.rangeMax =
+                cJSON_GetObjectItemCaseSensitive(
+                  variationJson, "angle-range-max"
+                )->valuedouble
+              ;
+
+              variation.range.data[0] =
+                ::JsonLoadComponents(
+                  cJSON_GetObjectItemCaseSensitive(variationJson, "default")
+                );
+
+              variation.range.data[1] =
+                ::JsonLoadComponents(
+                  cJSON_GetObjectItemCaseSensitive(variationJson, "flipped")
+                );
+            break;
+          }
+
+          state.variations.emplace_back(std::move(variation));
+        }
+
+        piece.states[piece.InternState(stateLabel)] = std::move(state);
+      }
+
+      auto const pieceIdx = animator->InternPiece(pieceLabel);
+      animator->pieces[pieceIdx] = std::move(piece);
+    }
+
+    // load skeleton
+    ::JsonParseRecursiveSkeleton(sheetJson, animator->skeleton);
+    animator->ResolveSkeleton();
+  }
+
+  cJSON_Delete(fileDataJson);
+}
+
+
+// -----------------------------------------------------------------------------
+// -- mapped files -------------------------------------------------------------
+
+// read-only view of a whole file, memory-mapped on unix & windows and read in
+// whole elsewhere; data is null if the file can't be read or is empty
+struct MappedFile {
+  std::byte const * data = nullptr;
+  size_t size = 0ul;
+
+  explicit MappedFile(std::string const & filename);
+  ~MappedFile();
+
+  MappedFile(MappedFile const &) = delete;
+  MappedFile & operator=(MappedFile const &) = delete;
+
+  #if !defined(__unix__) && !defined(_WIN32) && !defined(_WIN64)
+    std::vector<std::byte> buffer;
+  #endif
+};
+
+MappedFile::MappedFile(std::string const & filename) {
+  #if defined(__unix__)
+    int const fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) { return; }
+
+    struct stat fileStat;
+    if (::fstat(fd, &fileStat) == 0 && fileStat.st_size > 0) {
+      auto const fileSize = static_cast<size_t>(fileStat.st_size);
+      void * mapping = ::mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (mapping != MAP_FAILED) {
+        this->data = static_cast<std::byte const *>(mapping);
+        this->size = fileSize;
+      }
+    }
+
+    ::close(fd);
+  #elif defined(_WIN32) || defined(_WIN64)
+    ::HANDLE const file =
+      ::CreateFileA(
+        filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr
+      , OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr
+      );
+    if (file == INVALID_HANDLE_VALUE) { return; }
+
+    ::LARGE_INTEGER fileSize;
+    if (::GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0) {
+      ::HANDLE const mapping =
+        ::CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+      if (mapping) {
+        void const * view = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (view) {
+          this->data = static_cast<std::byte const *>(view);
+          this->size = static_cast<size_t>(fileSize.QuadPart);
+        }
+
+        // the view keeps the mapping alive on its own
+        ::CloseHandle(mapping);
+      }
+    }
+
+    ::CloseHandle(file);
+  #else
+    auto file = std::ifstream{filename, std::ios::binary | std::ios::ate};
+    if (!file.good()) { return; }
+
+    this->buffer.resize(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(
+      reinterpret_cast<char *>(this->buffer.data())
+    , static_cast<std::streamsize>(this->buffer.size())
+    );
+
+    if (file.good() && this->buffer.size() > 0ul) {
+      this->data = this->buffer.data();
+      this->size = this->buffer.size();
+    }
+  #endif
+}
+
+MappedFile::~MappedFile() {
+  #if defined(__unix__)
+    if (this->data)
+      { ::munmap(const_cast<std::byte *>(this->data), this->size); }
+  #elif defined(_WIN32) || defined(_WIN64)
+    if (this->data) { ::UnmapViewOfFile(this->data); }
+  #endif
+}
+
+// -----------------------------------------------------------------------------
+// -- database layout ----------------------------------------------------------
+
+// The database is a header followed by flat tables of plain records, each
+// aligned to 8 bytes. Records refer to each other by ranges into the tables &
+// to labels by ranges into the string table; nested lists (pieces of an
+// animator, states of a piece, ...) are contiguous. Children of a skeletal
+// piece always come after it
+
+std::array<char, 4ul> constexpr databaseMagic = {{ 'P', 'U', 'L', 'A' }};
+
+struct DbRange {
+  uint32_t begin = 0u;
+  uint32_t count = 0u;
+};
+
+struct DbTable {
+  uint64_t offset = 0ul; // bytes from the start of the database
+  uint64_t count = 0ul;
+};
+
+struct DbHeader {
+  std::array<char, 4ul> magic = databaseMagic;
+  uint32_t version = pul::animation::DatabaseVersion;
+  DbTable sources, animators, pieces, states, variations, components;
+  DbTable skeletals, strings;
+};
+
+struct DbSource {
+  DbRange filename;
+  uint32_t padding = 0u;
+  uint64_t hash = 0ul;
+};
+
+struct DbAnimator {
+  DbRange label, filename, spritesheetFilename;
+  std::array<uint32_t, 2ul> uvCoordOffset = {};
+  DbRange pieces;
+  DbRange skeleton;
+};
+
+struct DbPiece {
+  DbRange label;
+  std::array<uint32_t, 2ul> dimensions = {};
+  std::array<int32_t, 2ul> origin = {};
+  int32_t renderDepth = 0;
+  DbRange states;
+};
+
+uint32_t constexpr dbStateRotationMirrored   = 1u << 0u;
+uint32_t constexpr dbStateOriginInterpolates = 1u << 1u;
+uint32_t constexpr dbStateRotatePixels       = 1u << 2u;
+uint32_t constexpr dbStateFlipXAxis          = 1u << 3u;
+uint32_t constexpr dbStateLoops              = 1u << 4u;
+
+struct DbState {
+  DbRange label;
+  uint32_t variationType = 0u;
+  uint32_t msDeltaTime = 0u;
+  uint32_t flags = 0u;
+  DbRange variations;
+};
+
+struct DbVariation {
+  float rangeMax = 0.0f;
+  // normal, random, range default & range flipped components
+  std::array<DbRange, 4ul> components = {};
+};
+
+struct DbSkeletal {
+  DbRange label;
+  std::array<int32_t, 2ul> origin = {};
+  DbRange children;
+};
+
+// components are stored as they are & copied out in bulk
+static_assert(std::is_trivially_copyable_v<pul::animation::Component>);
+
+// -----------------------------------------------------------------------------
+// -- database writing ---------------------------------------------------------
+
+struct DatabaseWriter {
+  std::vector<DbSource> sources;
+  std::vector<DbAnimator> animators;
+  std::vector<DbPiece> pieces;
+  std::vector<DbState> states;
+  std::vector<DbVariation> variations;
+  std::vector<pul::animation::Component> components;
+  std::vector<DbSkeletal> skeletals;
+  std::vector<char> strings;
+
+  DbRange String(std::string const & str);
+  DbRange Components(std::vector<pul::animation::Component> const & data);
+  DbRange Skeletals(
+    std::vector<pul::animation::Animator::SkeletalPiece> const & skeleton
+  );
+
+  void Animator(pul::animation::Animator const & animator);
+};
+
+DbRange DatabaseWriter::String(std::string const & str) {
+  DbRange range;
+  range.begin = static_cast<uint32_t>(this->strings.size());
+  range.count = static_cast<uint32_t>(str.size());
+  this->strings.insert(this->strings.end(), str.begin(), str.end());
+  return range;
+}
+
+DbRange DatabaseWriter::Components(
+  std::vector<pul::animation::Component> const & data
+) {
+  DbRange range;
+  range.begin = static_cast<uint32_t>(this->components.size());
+  range.count = static_cast<uint32_t>(data.size());
+  this->components.insert(this->components.end(), data.begin(), data.end());
+  return range;
+}
+
+DbRange DatabaseWriter::Skeletals(
+  std::vector<pul::animation::Animator::SkeletalPiece> const & skeleton
+) {
+  // siblings are contiguous, their children are appended after them
+  DbRange range;
+  range.begin = static_cast<uint32_t>(this->skeletals.size());
+  range.count = static_cast<uint32_t>(skeleton.size());
+  this->skeletals.resize(range.begin + range.count);
+
+  for (size_t it = 0ul; it < skeleton.size(); ++ it) {
+    auto & dbSkeletal = this->skeletals[range.begin + it];
+    dbSkeletal.label = this->String(skeleton[it].label);
+    dbSkeletal.origin = {{ skeleton[it].origin.x, skeleton[it].origin.y }};
+  }
+
+  for (size_t it = 0ul; it < skeleton.size(); ++ it) {
+    DbRange const children = this->Skeletals(skeleton[it].children);
+    this->skeletals[range.begin + it].children = children;
+  }
+
+  return range;
+}
+
+void DatabaseWriter::Animator(pul::animation::Animator const & animator) {
+  DbAnimator dbAnimator;
+  dbAnimator.label = this->String(animator.label);
+  dbAnimator.filename = this->String(animator.filename);
+  dbAnimator.spritesheetFilename = this->String(animator.spritesheet.filename);
+  dbAnimator.uvCoordOffset =
+    {{ animator.uvCoordOffset.x, animator.uvCoordOffset.y }};
+
+  // pieces & their states are kept in their sorted order
+  dbAnimator.pieces.begin = static_cast<uint32_t>(this->pieces.size());
+  dbAnimator.pieces.count = static_cast<uint32_t>(animator.pieces.size());
+
+  for (size_t pieceIt = 0ul; pieceIt < animator.pieces.size(); ++ pieceIt) {
+    auto const & piece = animator.pieces[pieceIt];
+
+    DbPiece dbPiece;
+    dbPiece.label = this->String(animator.pieceLabels[pieceIt]);
+    dbPiece.dimensions = {{ piece.dimensions.x, piece.dimensions.y }};
+    dbPiece.origin = {{ piece.origin.x, piece.origin.y }};
+    dbPiece.renderDepth = piece.renderDepth;
+    dbPiece.states.begin = static_cast<uint32_t>(this->states.size());
+    dbPiece.states.count = static_cast<uint32_t>(piece.states.size());
+
+    for (size_t stateIt = 0ul; stateIt < piece.states.size(); ++ stateIt) {
+      auto const & state = piece.states[stateIt];
+
+      DbState dbState;
+      dbState.label = this->String(piece.stateLabels[stateIt]);
+      dbState.variationType = static_cast<uint32_t>(state.variationType);
+      dbState.msDeltaTime = state.msDeltaTime;
+      dbState.flags =
+          (state.rotationMirrored   ? dbStateRotationMirrored   : 0u)
+        | (state.originInterpolates ? dbStateOriginInterpolates : 0u)
+        | (state.rotatePixels       ? dbStateRotatePixels       : 0u)
+        | (state.flipXAxis          ? dbStateFlipXAxis          : 0u)
+        | (state.loops              ? dbStateLoops              : 0u)
+      ;
+      dbState.variations.begin = static_cast<uint32_t>(this->variations.size());
+      dbState.variations.count = static_cast<uint32_t>(state.variations.size());
+
+      for (auto const & variation : state.variations) {
+        DbVariation dbVariation;
+        dbVariation.rangeMax = variation.range.rangeMax;
+        dbVariation.components = {{
+          this->Components(variation.normal.data)
+        , this->Components(variation.random.data)
+        , this->Components(variation.range.data[0])
+        , this->Components(variation.range.data[1])
+        }};
+        this->variations.emplace_back(dbVariation);
+      }
+
+      this->states.emplace_back(dbState);
+    }
+
+    this->pieces.emplace_back(dbPiece);
+  }
+
+  dbAnimator.skeleton = this->Skeletals(animator.skeleton);
+
+  this->animators.emplace_back(dbAnimator);
+}
+
+template <typename T> DbTable AppendTable(
+  std::vector<std::byte> & blob, std::vector<T> const & records
+) {
+  blob.resize((blob.size() + 7ul) & ~7ul);
+
+  DbTable table;
+  table.offset = blob.size();
+  table.count = records.size();
+
+  size_t const bytes = records.size() * sizeof(T);
+  blob.resize(blob.size() + bytes);
+  if (bytes > 0ul)
+    { std::memcpy(blob.data() + table.offset, records.data(), bytes); }
+
+  return table;
+}
+
+// -----------------------------------------------------------------------------
+// -- database reading ---------------------------------------------------------
+
+// tables point straight into the mapped database
+struct DatabaseReader {
+  std::span<DbSource const> sources;
+  std::span<DbAnimator const> animators;
+  std::span<DbPiece const> pieces;
+  std::span<DbState const> states;
+  std::span<DbVariation const> variations;
+  std::span<pul::animation::Component const> components;
+  std::span<DbSkeletal const> skeletals;
+  std::span<char const> strings;
+
+  // false if a table lies outside of the database or is misaligned
+  bool Open(MappedFile const & file, DbHeader const & header);
+
+  bool String(DbRange const & range, std::string & str) const;
+  bool Components(
+    DbRange const & range, std::vector<pul::animation::Component> & data
+  ) const;
+  bool Skeletals(
+    DbRange const & range
+  , std::vector<pul::animation::Animator::SkeletalPiece> & skeleton
+  ) const;
+  bool Animator(
+    DbAnimator const & dbAnimator, pul::animation::Animator & animator
+  ) const;
+};
+
+template <typename T> bool TableOf(
+  MappedFile const & file, DbTable const & table, std::span<T const> & span
+) {
+  if (
+      table.offset % alignof(T) != 0ul
+   || table.offset > file.size
+   || table.count > (file.size - table.offset) / sizeof(T)
+  ) {
+    return false;
+  }
+
+  span =
+    std::span<T const>(
+      reinterpret_cast<T const *>(file.data + table.offset), table.count
+    );
+  return true;
+}
+
+template <typename T> bool InRange(
+  DbRange const & range, std::span<T const> const & span
+) {
+  return range.begin <= span.size() && range.count <= span.size()-range.begin;
+}
+
+bool DatabaseReader::Open(MappedFile const & file, DbHeader const & header) {
+  return
+      ::TableOf(file, header.sources, this->sources)
+   && ::TableOf(file, header.animators, this->animators)
+   && ::TableOf(file, header.pieces, this->pieces)
+   && ::TableOf(file, header.states, this->states)
+   && ::TableOf(file, header.variations, this->variations)
+   && ::TableOf(file, header.components, this->components)
+   && ::TableOf(file, header.skeletals, this->skeletals)
+   && ::TableOf(file, header.strings, this->strings)
+  ;
+}
+
+bool DatabaseReader::String(DbRange const & range, std::string & str) const {
+  if (!::InRange(range, this->strings)) { return false; }
+  str.assign(this->strings.data() + range.begin, range.count);
+  return true;
+}
+
+bool DatabaseReader::Components(
+  DbRange const & range, std::vector<pul::animation::Component> & data
+) const {
+  if (!::InRange(range, this->components)) { return false; }
+  auto const begin = this->components.begin() + range.begin;
+  data.assign(begin, begin + range.count);
+  return true;
+}
+
+bool DatabaseReader::Skeletals(
+  DbRange const & range
+, std::vector<pul::animation::Animator::SkeletalPiece> & skeleton
+) const {
+  if (!::InRange(range, this->skeletals)) { return false; }
+
+  skeleton.resize(range.count);
+  for (size_t it = 0ul; it < range.count; ++ it) {
+    auto const & dbSkeletal = this->skeletals[range.begin + it];
+    auto & skeletal = skeleton[it];
+
+    // children always come after their parent, which also guarantees that a
+    // malformed database can't recurse forever
+    if (
+        dbSkeletal.children.count > 0u
+     && dbSkeletal.children.begin <= range.begin + it
+    ) {
+      return false;
+    }
+
+    skeletal.origin = {dbSkeletal.origin[0], dbSkeletal.origin[1]};
+    if (
+        !this->String(dbSkeletal.label, skeletal.label)
+     || !this->Skeletals(dbSkeletal.children, skeletal.children)
+    ) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool DatabaseReader::Animator(
+  DbAnimator const & dbAnimator, pul::animation::Animator & animator
+) const {
+  if (
+      !this->String(dbAnimator.label, animator.label)
+   || !this->String(dbAnimator.filename, animator.filename)
+   || !this->String(
+        dbAnimator.spritesheetFilename, animator.spritesheet.filename
+      )
+   || !::InRange(dbAnimator.pieces, this->pieces)
+  ) {
+    return false;
+  }
+
+  animator.uvCoordOffset =
+    glm::uvec2(dbAnimator.uvCoordOffset[0], dbAnimator.uvCoordOffset[1]);
+
+  animator.pieceLabels.resize(dbAnimator.pieces.count);
+  animator.pieces.resize(dbAnimator.pieces.count);
+
+  for (size_t pieceIt = 0ul; pieceIt < dbAnimator.pieces.count; ++ pieceIt) {
+    auto const & dbPiece = this->pieces[dbAnimator.pieces.begin + pieceIt];
+    auto & piece = animator.pieces[pieceIt];
+
+    if (
+        !this->String(dbPiece.label, animator.pieceLabels[pieceIt])
+     || !::InRange(dbPiece.states, this->states)
+    ) {
+      return false;
+    }
+
+    piece.dimensions = {dbPiece.dimensions[0], dbPiece.dimensions[1]};
+    piece.origin = {dbPiece.origin[0], dbPiece.origin[1]};
+    piece.renderDepth = static_cast<int16_t>(dbPiece.renderDepth);
+
+    piece.stateLabels.resize(dbPiece.states.count);
+    piece.states.resize(dbPiece.states.count);
+
+    for (size_t stateIt = 0ul; stateIt < dbPiece.states.count; ++ stateIt) {
+      auto const & dbState = this->states[dbPiece.states.begin + stateIt];
+      auto & state = piece.states[stateIt];
+
+      if (
+          !this->String(dbState.label, piece.stateLabels[stateIt])
+       || !::InRange(dbState.variations, this->variations)
+       || dbState.variationType
+            >= static_cast<uint32_t>(pul::animation::VariationType::Size)
+      ) {
+        return false;
+      }
+
+      state.variationType =
+        static_cast<pul::animation::VariationType>(dbState.variationType);
+      state.msDeltaTime = dbState.msDeltaTime;
+      state.rotationMirrored = dbState.flags & dbStateRotationMirrored;
+      state.originInterpolates = dbState.flags & dbStateOriginInterpolates;
+      state.rotatePixels = dbState.flags & dbStateRotatePixels;
+      state.flipXAxis = dbState.flags & dbStateFlipXAxis;
+      state.loops = dbState.flags & dbStateLoops;
+
+      state.variations.resize(dbState.variations.count);
+      for (size_t it = 0ul; it < dbState.variations.count; ++ it) {
+        auto const & dbVariation =
+          this->variations[dbState.variations.begin + it];
+        auto & variation = state.variations[it];
+
+        variation.range.rangeMax = dbVariation.rangeMax;
+        if (
+            !this->Components(dbVariation.components[0], variation.normal.data)
+         || !this->Components(dbVariation.components[1], variation.random.data)
+         || !this->Components(
+              dbVariation.components[2], variation.range.data[0]
+            )
+         || !this->Components(
+              dbVariation.components[3], variation.range.data[1]
+            )
+        ) {
+          return false;
+        }
+      }
+    }
+
+    // lookups are binary searches, so the labels have to be sorted
+    if (!std::is_sorted(piece.stateLabels.begin(), piece.stateLabels.end()))
+      { return false; }
+  }
+
+  if (!std::is_sorted(animator.pieceLabels.begin(), animator.pieceLabels.end()))
+    { return false; }
+
+  if (!this->Skeletals(dbAnimator.skeleton, animator.skeleton))
+    { return false; }
+
+  animator.ResolveSkeleton();
+  return true;
+}
+
+} // -- namespace
+
+std::vector<std::string> pul::animation::LoadAnimatorsJson(
+  std::string const & dataFilename
+, std::map<std::string, std::shared_ptr<pul::animation::Animator>> & animators
+) {
+  std::vector<std::string> sourceFilenames;
+
+  cJSON * dataJson = ::LoadJsonFile(dataFilename);
+  if (!dataJson) { return sourceFilenames; }
+
+  sourceFilenames.emplace_back(dataFilename);
+
+  cJSON * filenameJson;
+  cJSON_ArrayForEach(
+    filenameJson
+  , cJSON_GetObjectItemCaseSensitive(dataJson, "files")
+  ) {
+    spdlog::debug("loading json file '{}'", filenameJson->valuestring);
+    sourceFilenames.emplace_back(filenameJson->valuestring);
+    ::LoadAnimation(sourceFilenames.back(), animators);
+  }
+
+  cJSON_Delete(dataJson);
+
+  return sourceFilenames;
+}
+
+uint64_t pul::animation::HashFile(std::string const & filename) {
+  ::MappedFile const file{filename};
+  if (!file.data) { return 0ul; }
+
+  uint64_t hash = 0xcbf29ce484222325ul;
+  for (size_t it = 0ul; it < file.size; ++ it) {
+    hash ^= static_cast<uint64_t>(file.data[it]);
+    hash *= 0x100000001b3ul;
+  }
+  return hash;
+}
+
+bool pul::animation::WriteAnimatorDatabase(
+  std::string const & filename
+, std::map<
+    std::string, std::shared_ptr<pul::animation::Animator>
+  > const & animators
+, std::vector<std::string> const & sourceFilenames
+) {
+  // a database without sources would never be invalidated, so one compiled
+  // from a data file that failed to load would be used from then on
+  if (sourceFilenames.empty()) {
+    spdlog::error(
+      "animation database '{}' not written, it has no sources", filename
+    );
+    return false;
+  }
+
+  ::DatabaseWriter writer;
+
+  for (auto const & sourceFilename : sourceFilenames) {
+    DbSource source;
+    source.filename = writer.String(sourceFilename);
+    source.hash = pul::animation::HashFile(sourceFilename);
+
+    // likewise a source that can't be read can't be checked for changes
+    if (source.hash == 0ul) {
+      spdlog::error(
+        "animation database '{}' not written, could not read source '{}'"
+      , filename, sourceFilename
+      );
+      return false;
+    }
+
+    writer.sources.emplace_back(source);
+  }
+
+  for (auto const & animatorPair : animators)
+    { writer.Animator(*animatorPair.second); }
+
+  std::vector<std::byte> blob(sizeof(DbHeader));
+
+  DbHeader header;
+  header.sources = ::AppendTable(blob, writer.sources);
+  header.animators = ::AppendTable(blob, writer.animators);
+  header.pieces = ::AppendTable(blob, writer.pieces);
+  header.states = ::AppendTable(blob, writer.states);
+  header.variations = ::AppendTable(blob, writer.variations);
+  header.components = ::AppendTable(blob, writer.components);
+  header.skeletals = ::AppendTable(blob, writer.skeletals);
+  header.strings = ::AppendTable(blob, writer.strings);
+  std::memcpy(blob.data(), &header, sizeof(DbHeader));
+
+  // written next to the database first, so that a database that's being
+  // mapped is never overwritten in place
+  std::string const temporaryFilename = filename + ".tmp";
+  {
+    auto file = std::ofstream{temporaryFilename, std::ios::binary};
+    file.write(
+      reinterpret_cast<char const *>(blob.data())
+    , static_cast<std::streamsize>(blob.size())
+    );
+    if (!file.good()) {
+      spdlog::error("could not write animation database '{}'", filename);
+      return false;
+    }
+  }
+
+  std::error_code error;
+  std::filesystem::rename(temporaryFilename, filename, error);
+  if (error) {
+    spdlog::error(
+      "could not write animation database '{}'; {}", filename, error.message()
+    );
+    return false;
+  }
+
+  return true;
+}
+
+bool pul::animation::LoadAnimatorDatabase(
+  std::string const & filename
+, std::map<std::string, std::shared_ptr<pul::animation::Animator>> & animators
+) {
+  ::MappedFile const file{filename};
+  if (!file.data) { return false; }
+
+  DbHeader header;
+  if (file.size < sizeof(DbHeader)) {
+    spdlog::error("animation database '{}' is malformed", filename);
+    return false;
+  }
+  std::memcpy(&header, file.data, sizeof(DbHeader));
+
+  if (
+      header.magic != ::databaseMagic
+   || header.version != pul::animation::DatabaseVersion
+  ) {
+    spdlog::info("animation database '{}' is of another version", filename);
+    return false;
+  }
+
+  ::DatabaseReader reader;
+  if (!reader.Open(file, header)) {
+    spdlog::error("animation database '{}' is malformed", filename);
+    return false;
+  }
+
+  // -- any change to the sources invalidates the database
+  for (auto const & source : reader.sources) {
+    std::string sourceFilename;
+    if (!reader.String(source.filename, sourceFilename)) {
+      spdlog::error("animation database '{}' is malformed", filename);
+      return false;
+    }
+
+    if (pul::animation::HashFile(sourceFilename) != source.hash) {
+      spdlog::info(
+        "animation database '{}' is out of date, '{}' changed"
+      , filename, sourceFilename
+      );
+      return false;
+    }
+  }
+
+  // -- build every animator before any of them are handed out
+  std::vector<std::shared_ptr<pul::animation::Animator>> loaded;
+  loaded.reserve(reader.animators.size());
+  for (auto const & dbAnimator : reader.animators) {
+    auto animator = std::make_shared<pul::animation::Animator>();
+    if (!reader.Animator(dbAnimator, *animator)) {
+      spdlog::error("animation database '{}' is malformed", filename);
+      return false;
+    }
+    loaded.emplace_back(std::move(animator));
+  }
+
+  for (auto & animator : loaded)
+    { animators[animator->label] = std::move(animator); }
+
+  return true;
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 
 namespace pul::core {
@@ -9,6 +10,17 @@ namespace pul::core {
   , FlipDiagonal   = 0b100
   , None   = 0b000
   };
+
+  // what a solid texel blocks, as bits so that queries can filter on any
+  // combination of them. World is the geometry everything else collides with
+  enum class CollisionChannel : uint8_t {
+    World      = 0b0001
+  , Player     = 0b0010
+  , Projectile = 0b0100
+  , None = 0b0000
+  , All  = 0xFF
+  };
 }
 
 std::string ToStr(pul::core::TileOrientation);
+std::string ToStr(pul::core::CollisionChannel);
@@ -47,6 +47,12 @@ namespace pul::core {
 
     float timer = 50000.0f; // ms
 
+    // grenades resting on geometry stop querying physics, keeping their
+    // velocity, until an explosion or a change of map geometry wakes them
+    bool asleep = false;
+    uint8_t restingTicks = 0;
+    size_t sleepGeometryVersion = 0ul;
+
     pul::animation::Instance animationInstance = {};
     std::string bounceAnimation = "";
 
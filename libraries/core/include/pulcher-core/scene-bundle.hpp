@@ -26,6 +26,10 @@ namespace pul::core {
     float calculatedMsPerFrame = pul::util::MsPerFrame;
     size_t numCpuFrames = 0ul;
 
+    // incremented before every logic update, caches scoped to a single tick
+    // compare against it
+    size_t logicTick = 0ul;
+
     bool debugFrameBufferHovered = false;
 
     pul::core::Config config = {};
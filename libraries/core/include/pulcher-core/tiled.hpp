@@ -0,0 +1,60 @@
+#pragma once
+
+#include <pulcher-core/map.hpp>
+
+#include <glm/glm.hpp>
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+struct cJSON;
+
+// -- parsing of Tiled (json) maps, shared by the map plugin and tools that have
+//    to load maps the same way it does
+
+namespace pul::core {
+  struct TiledTileset {
+    std::filesystem::path imagePath;
+    size_t firstGid;
+
+    // duplicated from the tileset, has to be freed with cJSON_Delete; null if
+    // the tileset has no tile properties
+    cJSON * jsonTiles = nullptr;
+  };
+
+  struct TiledTile {
+    glm::i32vec2 origin; // in tiles, can be negative
+    size_t gid; // flip flags are stripped
+    pul::core::TileOrientation orientation;
+  };
+
+  // parsed json has to be freed with cJSON_Delete, null on failure
+  cJSON * LoadTiledJson(std::string const & filename);
+
+  // tilesets in the order the map lists them, external tilesets are loaded
+  // relative to the map. An external tileset that can't be loaded or a
+  // tileset with a missing image fails the entire map, as the gids of the
+  // tilesets after it would no longer line up; nothing is returned then
+  bool LoadTiledTilesets(
+    cJSON * map, std::string const & mapFilename
+  , std::vector<TiledTileset> & tilesets
+  );
+
+  // every placed tile of a (chunked) tile layer
+  std::vector<TiledTile> TiledLayerTiles(cJSON * layer);
+
+  // draw depth of a tile layer from its label, only depth 0 has collision
+  int32_t TiledLayerDepth(std::string const & layerLabel);
+
+  // channels the tiles of a depth 0 layer block; "solid-player" &
+  // "solid-projectile" only block their channel, any other label everything
+  pul::core::CollisionChannel TiledLayerChannels(
+    std::string const & layerLabel
+  );
+
+  // tileset that the gid belongs to, -1 if none
+  size_t TiledTilesetIdx(
+    std::vector<TiledTileset> const & tilesets, size_t gid
+  );
+}
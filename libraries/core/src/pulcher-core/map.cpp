@@ -22,3 +22,27 @@ std::string ToStr(pul::core::TileOrientation orientation) {
 
   return "(" + str + ")";
 }
+
+std::string ToStr(pul::core::CollisionChannel channels) {
+  if (channels == pul::core::CollisionChannel::All) { return "(all)"; }
+  if (channels == pul::core::CollisionChannel::None) { return "(none)"; }
+
+  std::string str;
+  auto const collisionChannels = Idx(channels);
+
+  if (collisionChannels & Idx(pul::core::CollisionChannel::World)) {
+    str += "world";
+  }
+
+  if (collisionChannels & Idx(pul::core::CollisionChannel::Player)) {
+    if (str.size() != 0ul) { str += " | "; }
+    str += "player";
+  }
+
+  if (collisionChannels & Idx(pul::core::CollisionChannel::Projectile)) {
+    if (str.size() != 0ul) { str += " | "; }
+    str += "projectile";
+  }
+
+  return "(" + str + ")";
+}
@@ -0,0 +1,211 @@
+#include <pulcher-core/tiled.hpp>
+
+#include <pulcher-util/enum.hpp>
+#include <pulcher-util/log.hpp>
+
+#include <cjson/cJSON.h>
+
+#include <fstream>
+
+namespace {
+
+size_t constexpr
+  FlippedHorizontalGidFlag = 0x80000000
+, FlippedVerticalGidFlag   = 0x40000000
+, FlippedDiagonalGidFlag   = 0x20000000
+;
+
+} // -- namespace
+
+cJSON * pul::core::LoadTiledJson(std::string const & filename) {
+  auto file = std::ifstream{filename};
+  if (file.eof() || !file.good()) {
+    spdlog::error("could not load '{}'", filename);
+    return nullptr;
+  }
+
+  auto str =
+    std::string {
+      std::istreambuf_iterator<char>(file)
+    , std::istreambuf_iterator<char>()
+    };
+
+  cJSON * json = cJSON_Parse(str.c_str());
+  if (!json) {
+    spdlog::critical(
+      "failed to parse json '{}'; '{}'", filename, cJSON_GetErrorPtr()
+    );
+  }
+
+  return json;
+}
+
+bool pul::core::LoadTiledTilesets(
+  cJSON * map, std::string const & mapFilename
+, std::vector<pul::core::TiledTileset> & tilesets
+) {
+  tilesets.clear();
+
+  auto const mapPath = std::filesystem::path(mapFilename).remove_filename();
+
+  cJSON * tileset;
+  cJSON_ArrayForEach(
+    tileset, cJSON_GetObjectItemCaseSensitive(map, "tilesets")
+  ) {
+    cJSON * tilesetJson = tileset;
+    cJSON * externalJson = nullptr;
+
+    // either the file is embedded or it is externally loaded
+    if (auto source = cJSON_GetObjectItemCaseSensitive(tileset, "source")) {
+      spdlog::debug("loading tileset '{}'", source->valuestring);
+
+      externalJson =
+        pul::core::LoadTiledJson((mapPath / source->valuestring).string());
+      if (!externalJson) {
+        spdlog::error(
+          "could not load tileset '{}' of map '{}'"
+        , source->valuestring, mapFilename
+        );
+        for (auto & loadedTileset : tilesets)
+          { cJSON_Delete(loadedTileset.jsonTiles); }
+        tilesets.clear();
+        return false;
+      }
+      tilesetJson = externalJson;
+    }
+
+    auto const imagePath =
+        mapPath
+      / std::filesystem::path(
+          cJSON_GetObjectItemCaseSensitive(tilesetJson, "image")->valuestring
+        );
+
+    // skipping the tileset would shift the gids of the tilesets after it
+    if (!std::filesystem::exists(imagePath)) {
+      spdlog::error(
+        "invalid path for tileset '{}' of map '{}'"
+      , imagePath.string(), mapFilename
+      );
+      cJSON_Delete(externalJson);
+      for (auto & loadedTileset : tilesets)
+        { cJSON_Delete(loadedTileset.jsonTiles); }
+      tilesets.clear();
+      return false;
+    }
+
+    auto tilesJson = cJSON_GetObjectItemCaseSensitive(tilesetJson, "tiles");
+    if (tilesJson) { tilesJson = cJSON_Duplicate(tilesJson, true); }
+
+    tilesets.emplace_back(pul::core::TiledTileset {
+      imagePath
+    , static_cast<size_t>(
+        cJSON_GetObjectItemCaseSensitive(tileset, "firstgid")->valueint
+      )
+    , tilesJson
+    });
+
+    cJSON_Delete(externalJson);
+  }
+
+  return true;
+}
+
+std::vector<pul::core::TiledTile> pul::core::TiledLayerTiles(cJSON * layer) {
+  std::vector<pul::core::TiledTile> tiles;
+
+  cJSON * chunk;
+  cJSON_ArrayForEach(
+    chunk, cJSON_GetObjectItemCaseSensitive(layer, "chunks")
+  ) {
+    auto const width =
+      cJSON_GetObjectItemCaseSensitive(chunk, "width")->valueint;
+
+    auto const
+      x = cJSON_GetObjectItemCaseSensitive(chunk, "x")->valueint
+    , y = cJSON_GetObjectItemCaseSensitive(chunk, "y")->valueint
+    ;
+
+    int32_t localItr = 0;
+
+    cJSON * gidJson;
+    cJSON_ArrayForEach(
+      gidJson, cJSON_GetObjectItemCaseSensitive(chunk, "data")
+    ) {
+      // flip flags don't fit into an int, so the gid has to be read as double
+      size_t const gid = static_cast<uint32_t>(gidJson->valuedouble);
+      size_t const tileId =
+          gid
+        & ~(
+            ::FlippedHorizontalGidFlag
+          | ::FlippedVerticalGidFlag
+          | ::FlippedDiagonalGidFlag
+          )
+      ;
+
+      glm::i32vec2 const origin =
+        glm::i32vec2(x + localItr % width, y + localItr / width);
+      ++ localItr;
+
+      if (tileId == 0ul) { continue; }
+
+      tiles.emplace_back(pul::core::TiledTile {
+        origin
+      , tileId
+      , static_cast<pul::core::TileOrientation>(
+          (gid & ::FlippedDiagonalGidFlag
+            ? Idx(pul::core::TileOrientation::FlipDiagonal)   : 0ul)
+        | (gid & ::FlippedVerticalGidFlag
+            ? Idx(pul::core::TileOrientation::FlipVertical)   : 0ul)
+        | (gid & ::FlippedHorizontalGidFlag
+            ? Idx(pul::core::TileOrientation::FlipHorizontal) : 0ul)
+        )
+      });
+    }
+  }
+
+  return tiles;
+}
+
+int32_t pul::core::TiledLayerDepth(std::string const & layerLabel) {
+  // TODO this should not parse numbers but just assume depth based on layer
+
+  if (layerLabel.compare(0, 13, "nonsolid-back") == 0) {
+    size_t numberIdx = layerLabel.find_last_not_of("0123456789");
+    return +std::stoi(layerLabel.substr(numberIdx+1));
+  }
+
+  if (layerLabel.compare(0, 14, "nonsolid-front") == 0) {
+    size_t numberIdx = layerLabel.find_last_not_of("0123456789");
+    return -std::stoi(layerLabel.substr(numberIdx+1));
+  }
+
+  // solid-all, solid-player, etc
+  return 0;
+}
+
+pul::core::CollisionChannel pul::core::TiledLayerChannels(
+  std::string const & layerLabel
+) {
+  if (pul::core::TiledLayerDepth(layerLabel) != 0)
+    { return pul::core::CollisionChannel::None; }
+
+  if (layerLabel.compare(0, 12, "solid-player") == 0)
+    { return pul::core::CollisionChannel::Player; }
+
+  if (layerLabel.compare(0, 16, "solid-projectile") == 0)
+    { return pul::core::CollisionChannel::Projectile; }
+
+  // solid-all
+  return pul::core::CollisionChannel::All;
+}
+
+size_t pul::core::TiledTilesetIdx(
+  std::vector<pul::core::TiledTileset> const & tilesets, size_t const gid
+) {
+  size_t tilesetIdx = -1ul;
+  for (size_t idx = 0ul; idx < tilesets.size(); ++ idx) {
+    if (tilesets[idx].firstGid <= gid) { tilesetIdx = idx; }
+  }
+
+  return tilesetIdx;
+}
@@ -17,7 +17,6 @@ sg_pass  scenePass  = {};
 
 void InitializeSokol() {
   sg_desc description = {};
-  description.buffer_pool_size = 5192;
   sg_setup(&description);
 
   simgui_desc_t imguiDescr = {};
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <entt/entt.hpp>
+#include <glm/glm.hpp>
+
+#include <array>
+#include <unordered_map>
+#include <vector>
+
+namespace pul::physics { struct EntityIntersectionResults; }
+namespace pul::physics { struct EntityRaycastHits; }
+namespace pul::physics { struct IntersectorCircle; }
+namespace pul::physics { struct IntersectorRay; }
+
+namespace pul::physics {
+
+  // uniform grid over entity hitboxes; cells are hashed into a fixed amount of
+  // buckets so neither the map bounds nor entity positions have to be known up
+  // front. Entities are binned into every cell their AABB overlaps, so a query
+  // only has to visit the cells it touches to find every candidate
+  struct EntityBroadphase {
+    static int32_t constexpr cellSize = 128;
+    static size_t constexpr bucketCount = 1024ul;
+
+    struct Record {
+      entt::entity entity = entt::null;
+      glm::vec2 aabbOrigin, aabbDimensions;
+
+      // inclusive range of cells the AABB overlaps
+      glm::i32vec2 cellMin, cellMax;
+
+      // last query that visited this record, prevents entities spanning
+      // several cells from being reported more than once
+      uint32_t queryStamp = 0u;
+    };
+
+    std::vector<Record> records;
+    std::unordered_map<entt::entity, size_t> entityToRecord;
+
+    // indices into records
+    std::array<std::vector<size_t>, bucketCount> buckets;
+
+    uint32_t queryStamp = 0u;
+
+    void Clear();
+
+    // inserts the entity if it isn't in the broadphase yet, otherwise only
+    // re-bins it if it moved to different cells
+    void Update(
+      entt::entity entity
+    , glm::vec2 const & aabbOrigin, glm::vec2 const & aabbDimensions
+    );
+
+    void Remove(entt::entity entity);
+
+    static size_t BucketIdx(glm::i32vec2 cell);
+    static glm::i32vec2 CellIdx(glm::vec2 origin);
+
+    // starts a new query, returns the stamp to tag visited records with
+    uint32_t BeginQuery();
+  };
+
+  // -- entity queries, only cells the intersector touches are visited and the
+  //    exact AABB test is run on the entities binned in them
+
+  void EntityIntersectionRaycast(
+    EntityBroadphase & broadphase
+  , IntersectorRay const & ray
+  , EntityIntersectionResults & results
+  );
+
+  // only returns the closest hits.maxHits entities, ignoredEntity can be null.
+  // Cells are walked front to back and the ray is clipped to the furthest
+  // kept hit once full, so the walk stops as soon as no closer hit is possible
+  void EntityIntersectionRaycastNearest(
+    EntityBroadphase & broadphase
+  , IntersectorRay const & ray
+  , entt::entity ignoredEntity
+  , EntityRaycastHits & hits
+  );
+
+  void EntityIntersectionCircle(
+    EntityBroadphase & broadphase
+  , IntersectorCircle const & circle
+  , EntityIntersectionResults & results
+  );
+}
@@ -1,15 +1,17 @@
 #pragma once
 
 #include <pulcher-core/map.hpp>
+#include <pulcher-physics/tileset.hpp>
+#include <pulcher-util/enum.hpp>
 
 #include <entt/entt.hpp>
 #include <glm/glm.hpp>
 
+#include <algorithm>
 #include <array>
+#include <span>
 #include <vector>
 
-namespace pul::physics { struct Tileset; }
-
 namespace pul::physics {
 
   enum class IntersectorType : size_t {
@@ -40,6 +42,9 @@ namespace pul::physics {
 
     glm::vec2 origin;
     glm::vec2 dimensions;
+
+    // displacement the AABB is swept along
+    glm::vec2 velocity = glm::vec2(0.0f);
   };
 
   struct IntersectorRay {
@@ -59,6 +64,31 @@ namespace pul::physics {
     glm::i32vec2 origin = glm::i32vec2(0);
 
     size_t imageTileIdx = -1ul, tilesetIdx = -1ul;
+
+    // surface normal at the collision, pointing into the surface; zero when
+    // it can't be determined (such as from inside of a solid)
+    glm::vec2 normal = glm::vec2(0.0f);
+  };
+
+  struct AabbIntersectionResults {
+    bool collision = false;
+
+    // fraction of the velocity travelled before contact, and the origin of the
+    // AABB at that point
+    float timeOfImpact = 1.0f;
+    glm::vec2 origin = glm::vec2(0.0f);
+
+    // axis aligned contact normal, pointing into the surface
+    glm::vec2 normal = glm::vec2(0.0f);
+
+    // normal of the texel touched, like IntersectionResults::normal
+    glm::vec2 surfaceNormal = glm::vec2(0.0f);
+
+    // remaining velocity after contact with the part into the contact normal
+    // removed, so that the AABB can slide along the surface
+    glm::vec2 slideVelocity = glm::vec2(0.0f);
+
+    size_t imageTileIdx = -1ul, tilesetIdx = -1ul;
   };
 
   struct EntityIntersectionResults {
@@ -67,47 +97,404 @@ namespace pul::physics {
     std::vector<std::pair<glm::i32vec2 /*origin*/, entt::entity>> entities;
   };
 
-  // queries for debug purposes
+  // entity hits along a ray sorted by distance, bounded so that the query
+  // never has to allocate
+  struct EntityRaycastHits {
+    static size_t constexpr capacity = 8ul;
+
+    struct Hit {
+      float distance = 0.0f;
+      glm::i32vec2 origin = glm::i32vec2(0);
+      entt::entity entity = entt::null;
+    };
+
+    // input; 1 only returns the closest hit, anything higher lets the ray
+    // pierce through that many entities (clamped to capacity)
+    size_t maxHits = 1ul;
+
+    std::array<Hit, capacity> hits;
+    size_t size = 0ul;
+
+    bool Collision() const { return size > 0ul; }
+    std::span<Hit const> Hits() const { return { hits.data(), size }; }
+  };
+
+  enum class DebugQueryType : size_t {
+    Point, Ray, Aabb, EntityRay, EntityCircle, LineOfSight
+  , Size
+  };
+
+  // queries for debug purposes. Nothing is recorded unless enabled, which costs
+  // a single branch per query; building without PULCHER_PHYSICS_DEBUG_QUERIES
+  // removes recording entirely. Only the most recent queries are kept
   struct DebugQueries {
+    static size_t constexpr ringCapacity = 1'024ul;
+
+    // fixed-size, the oldest entries are overwritten once it's full
+    template <typename T> struct Ring {
+      std::array<T, ringCapacity> entries;
+      size_t written = 0ul; // in total, the next entry is at written % capacity
+
+      void Push(T const & entry) {
+        entries[written % ringCapacity] = entry;
+        ++ written;
+      }
+
+      size_t Size() const { return std::min(written, ringCapacity); }
+
+      // the most recent count entries, from oldest to newest
+      template <typename Fn> void ForEachRecent(size_t count, Fn && fn) const {
+        count = std::min(count, this->Size());
+        for (size_t i = written - count; i < written; ++ i)
+          { fn(entries[i % ringCapacity]); }
+      }
+    };
+
+    bool enabled = false;
+
+    Ring<std::pair<IntersectorPoint, IntersectionResults>> intersectorPoints;
+    Ring<std::pair<IntersectorRay, IntersectionResults>> intersectorRays;
+
+    // amount of queries by type, during this frame and the previous one
+    std::array<size_t, Idx(DebugQueryType::Size)>
+      frameCounts = {}, previousFrameCounts = {};
+
+    bool Recording() const {
+      #ifdef PULCHER_PHYSICS_DEBUG_QUERIES
+        return enabled;
+      #else
+        return false;
+      #endif
+    }
+
+    void BeginFrame() {
+      previousFrameCounts = frameCounts;
+      frameCounts = {};
+    }
+
+    void Count(DebugQueryType type, size_t amount = 1ul) {
+      if (!this->Recording()) { return; }
+      frameCounts[Idx(type)] += amount;
+    }
+
     void Add(
       IntersectorPoint const & intersector
-    , pul::physics::IntersectionResults results
-    );
+    , IntersectionResults const & results
+    ) {
+      if (!this->Recording()) { return; }
+      frameCounts[Idx(DebugQueryType::Point)] += 1ul;
+      intersectorPoints.Push({intersector, results});
+    }
 
     void Add(
       IntersectorRay const & intersector
-    , pul::physics::IntersectionResults results
-    );
+    , IntersectionResults const & results
+    ) {
+      if (!this->Recording()) { return; }
+      frameCounts[Idx(DebugQueryType::Ray)] += 1ul;
+      intersectorRays.Push({intersector, results});
+    }
 
-    std::vector<
-      std::pair<
-        pul::physics::IntersectorPoint
-      , pul::physics::IntersectionResults
-      >
-     > intersectorPoints;
-
-    std::vector<
-      std::pair<
-        pul::physics::IntersectorRay
-      , pul::physics::IntersectionResults
-      >
-    > intersectorRays;
+    // batches, results are expected to be at least as long as intersectors
+    void Add(
+      std::span<IntersectorPoint const> intersectors
+    , std::span<IntersectionResults const> results
+    ) {
+      if (!this->Recording()) { return; }
+      frameCounts[Idx(DebugQueryType::Point)] += intersectors.size();
+      for (size_t i = 0ul; i < intersectors.size(); ++ i)
+        { intersectorPoints.Push({intersectors[i], results[i]}); }
+    }
+
+    void Add(
+      std::span<IntersectorRay const> intersectors
+    , std::span<IntersectionResults const> results
+    ) {
+      if (!this->Recording()) { return; }
+      frameCounts[Idx(DebugQueryType::Ray)] += intersectors.size();
+      for (size_t i = 0ul; i < intersectors.size(); ++ i)
+        { intersectorRays.Push({intersectors[i], results[i]}); }
+    }
   };
 
+  // tiles are stored sparsely in square chunks, so memory follows the amount of
+  // placed tiles rather than the extent of the map, and tiles may be placed at
+  // negative coordinates. The chunk table is dense over the chunk bounds, so a
+  // lookup is still two array indexings.
+  // Occupancy forms a pyramid of map, chunk, tile, block and texel; the map and
+  // chunk levels are stored here, the tile and block levels are the
+  // acceleration hints of the oriented tiles, and the texels their masks.
+  // Every collision layer of the map is stored together; tiles placed at the
+  // same origin are combined into one, with their texels keeping the channels
+  // of the layer they came from, so any channel filter is a single lookup
   struct TilemapLayer {
+    static int32_t constexpr chunkSize = 16; // in tiles
+    static int32_t constexpr chunkShift = 4;
+    static_assert((1 << chunkShift) == chunkSize);
+
     std::vector<pul::physics::Tileset const *> tilesets;
 
     struct TileInfo {
-      size_t imageTileIdx = -1ul;
-      size_t tilesetIdx = -1ul;
-      pul::core::TileOrientation orientation = pul::core::TileOrientation::None;
-      glm::vec2 origin;
+      // into orientedTiles
+      uint32_t orientedTileIdx = -1u;
+      uint16_t imageTileIdx = -1;
+      uint8_t tilesetIdx = -1;
+      uint8_t orientation = 0u;
+
+      bool Valid() const { return orientedTileIdx != -1u; }
 
-      bool Valid() const { return tilesetIdx != -1ul; }
+      pul::core::TileOrientation Orientation() const {
+        return static_cast<pul::core::TileOrientation>(orientation);
+      }
     };
+    static_assert(sizeof(TileInfo) == 8ul);
+
+    struct Chunk {
+      // row-major
+      std::array<TileInfo, chunkSize*chunkSize> tiles;
+
+      // channels blocked by any texel of the tiles
+      pul::core::CollisionChannel channels = pul::core::CollisionChannel::None;
+    };
+
+    std::vector<Chunk> chunks;
+
+    // index into chunks for every chunk within the bounds, -1 if no tile was
+    // placed in it
+    std::vector<uint32_t> chunkTable;
+    glm::i32vec2 chunkMin = glm::i32vec2(0), chunkDimensions = glm::i32vec2(0);
+
+    // inclusive bounds of the placed tiles; tiles inside of them that weren't
+    // placed are empty, tiles outside of them are outside of the map
+    glm::i32vec2 tileMin = glm::i32vec2(0), tileMax = glm::i32vec2(-1);
 
-    std::vector<TileInfo> tileInfo;
-    uint32_t width;
+    // every unique tile/orientation pair of the map, with the orientation
+    // baked in so queries never have to apply it
+    std::vector<pul::physics::Tile> orientedTiles;
+
+    // signed distance fields of orientedTiles, by the same index; kept apart
+    // so that point & texel queries only touch the masks & hints. Being local
+    // to the tile, they're shared by every placement of it
+    std::vector<pul::physics::Tile::DistanceField> orientedDistanceFields;
+
+    // channels of the texels of the oriented tiles with mixed channels, which
+    // index into it
+    std::vector<pul::physics::Tile::TexelChannels> mixedTexelChannels;
+
+    // channels blocked by any texel of the chunks
+    pul::core::CollisionChannel channels = pul::core::CollisionChannel::None;
+
+    bool Empty() const { return tileMin.x > tileMax.x; }
+
+    glm::i32vec2 TexelMin() const;
+    glm::i32vec2 TexelMax() const;
+
+    // chunk that the tile belongs to, null if no tile was placed in it
+    Chunk const * ChunkOf(glm::i32vec2 const tile) const {
+      // arithmetic shifts floor negative tiles too
+      glm::i32vec2 const chunk =
+          glm::i32vec2(tile.x >> chunkShift, tile.y >> chunkShift)
+        - this->chunkMin;
+
+      if (
+          static_cast<uint32_t>(chunk.x)
+            >= static_cast<uint32_t>(this->chunkDimensions.x)
+       || static_cast<uint32_t>(chunk.y)
+            >= static_cast<uint32_t>(this->chunkDimensions.y)
+      ) {
+        return nullptr;
+      }
+
+      uint32_t const chunkIdx =
+        this->chunkTable[chunk.y*this->chunkDimensions.x + chunk.x];
+
+      return chunkIdx == -1u ? nullptr : &this->chunks[chunkIdx];
+    }
+
+    // null if the tile is outside of the map, tiles within the map that were
+    // never placed are returned as an invalid tile
+    TileInfo const * Tile(glm::i32vec2 const tile) const {
+      static TileInfo constexpr emptyTile = {};
+
+      if (
+          tile.x < this->tileMin.x || tile.x > this->tileMax.x
+       || tile.y < this->tileMin.y || tile.y > this->tileMax.y
+      ) {
+        return nullptr;
+      }
+
+      auto const * chunk = this->ChunkOf(tile);
+      if (!chunk) { return &emptyTile; }
+
+      return
+        &chunk->tiles[
+          (tile.y & (chunkSize-1))*chunkSize + (tile.x & (chunkSize-1))
+        ];
+    }
+
+    // signed distance of a texel local to the tile; solid texels are negative
+    float SignedDistance(TileInfo const & tile, glm::u32vec2 texel) const;
+
+    // every span of tiles belongs to a tileset and blocks the channels of its
+    // layer, the same tileset may be listed once per layer. The first tile
+    // placed at an origin is the one reported by queries
+    static TilemapLayer Construct(
+      std::vector<pul::physics::Tileset const *> const & tilesets
+    , std::vector<std::span<size_t>>             const & mapTileIndices
+    , std::vector<std::span<glm::i32vec2>>       const & mapTileOrigins
+    , std::vector<std::span<pul::core::TileOrientation>> const &
+        mapTileOrientations
+    , std::vector<pul::core::CollisionChannel>   const & mapTileChannels
+    );
   };
 
+  // memoizes point queries for the duration of a logic tick, as the same
+  // texels get probed over and over again (ground and wall cling checks of
+  // every player). Slots are direct mapped on the texel, a colliding query
+  // simply evicts the previous one. Has to be invalidated whenever the
+  // geometry it was filled from changes
+  struct QueryCache {
+    static size_t constexpr slotCount = 512ul;
+    static_assert((slotCount & (slotCount-1ul)) == 0ul);
+
+    struct PointSlot {
+      glm::i32vec2 origin = glm::i32vec2(0);
+      uint32_t stamp = 0u;
+      pul::core::CollisionChannel channels = pul::core::CollisionChannel::None;
+      IntersectionResults results;
+    };
+
+    struct Counters {
+      size_t pointHits = 0ul, pointMisses = 0ul;
+    };
+
+    std::array<PointSlot, slotCount> points;
+
+    // slots of an older stamp are empty, so invalidating never touches them
+    uint32_t stamp = 1u;
+
+    // logic tick the slots were filled in
+    size_t tick = -1ul;
+
+    bool enabled = true;
+
+    Counters tickCounters, previousTickCounters;
+
+    void Invalidate();
+
+    // invalidates the slots if a tick started since the cache was last used
+    void BeginTick(size_t tick);
+
+    static size_t SlotIdx(glm::i32vec2 origin);
+  };
+
+  // -- tilemap queries, the physics plugin wraps these in order to record debug
+  //    queries. Texels are only solid to a query if they block any of the
+  //    channels it filters on
+
+  // origin of the first solid texel along the ray
+  bool IntersectionRaycast(
+    TilemapLayer const & layer
+  , IntersectorRay const & ray
+  , IntersectionResults & results
+  , pul::core::CollisionChannel channels = pul::core::CollisionChannel::All
+  );
+
+  // origin of the first empty texel along the ray, texels outside of the
+  // tilemap are ignored
+  bool InverseIntersectionRaycast(
+    TilemapLayer const & layer
+  , IntersectorRay const & ray
+  , IntersectionResults & results
+  , pul::core::CollisionChannel channels = pul::core::CollisionChannel::All
+  );
+
+  bool IntersectionPoint(
+    TilemapLayer const & layer
+  , IntersectorPoint const & point
+  , IntersectionResults & results
+  , pul::core::CollisionChannel channels = pul::core::CollisionChannel::All
+  );
+
+  // true if none of the texels IntersectionRaycast would test are solid. The
+  // occupancy pyramid is descended instead, so empty chunks, tiles and blocks
+  // are crossed at once and the walk stops at the first solid block
+  bool LineOfSight(
+    TilemapLayer const & layer
+  , glm::i32vec2 beginOrigin
+  , glm::i32vec2 endOrigin
+  , pul::core::CollisionChannel channels = pul::core::CollisionChannel::All
+  );
+
+  // earliest contact of the AABB swept along its velocity against the solid
+  // texels, AABBs that already overlap texels at the start are allowed to move
+  // out of them
+  bool IntersectionAabb(
+    TilemapLayer const & layer
+  , IntersectorAabb const & aabb
+  , AabbIntersectionResults & results
+  , pul::core::CollisionChannel channels = pul::core::CollisionChannel::All
+  );
+
+  // batched variants, every intersector writes to the result of the same
+  // index; returns the amount of collisions
+  size_t IntersectionPointBatch(
+    TilemapLayer const & layer
+  , std::span<IntersectorPoint const> points
+  , std::span<IntersectionResults> results
+  , pul::core::CollisionChannel channels = pul::core::CollisionChannel::All
+  );
+
+  size_t IntersectionRaycastBatch(
+    TilemapLayer const & layer
+  , std::span<IntersectorRay const> rays
+  , std::span<IntersectionResults> results
+  , pul::core::CollisionChannel channels = pul::core::CollisionChannel::All
+  );
+
+  // same as the point queries above, but answered from the cache when the
+  // texel was already queried this tick with the same channels
+  bool IntersectionPoint(
+    TilemapLayer const & layer
+  , QueryCache & cache
+  , IntersectorPoint const & point
+  , IntersectionResults & results
+  , pul::core::CollisionChannel channels = pul::core::CollisionChannel::All
+  );
+
+  size_t IntersectionPointBatch(
+    TilemapLayer const & layer
+  , QueryCache & cache
+  , std::span<IntersectorPoint const> points
+  , std::span<IntersectionResults> results
+  , pul::core::CollisionChannel channels = pul::core::CollisionChannel::All
+  );
+
+  // -- hitbox tests
+
+  glm::vec2 GetAabbMin(glm::vec2 const & aabbOrigin, glm::vec2 const & aabbDim);
+  glm::vec2 GetAabbMax(glm::vec2 const & aabbOrigin, glm::vec2 const & aabbDim);
+
+  // intersectionLength is the distance from rayBegin to the hitbox
+  bool IntersectionRayAabb(
+    glm::vec2 const & rayBegin, glm::vec2 const & rayEnd
+  , glm::vec2 const & aabbOrigin, glm::vec2 const & aabbDim
+  , float & intersectionLength
+  );
+
+  // same as IntersectionRayAabb with the ray already split into a normalized
+  // direction and a length, hits at or past rayLength are rejected
+  bool IntersectionRayAabbDistance(
+    glm::vec2 const & rayBegin, glm::vec2 const & rayNormal
+  , float const rayLength
+  , glm::vec2 const & aabbOrigin, glm::vec2 const & aabbDim
+  , float & intersectionLength
+  );
+
+  bool IntersectionCircleAabb(
+    glm::vec2 const & circleOrigin, float const circleRadius
+  , glm::vec2 const & aabbOrigin, glm::vec2 const & aabbDim
+  , glm::vec2 & closestOrigin
+  );
+
 }
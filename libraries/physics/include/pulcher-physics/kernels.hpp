@@ -0,0 +1,38 @@
+#pragma once
+
+#include <pulcher-physics/intersections.hpp>
+
+#include <span>
+
+// vectorized inner loops of the tilemap queries. The build targets plain
+// x86-64, so wider instruction sets are only used after checking for them at
+// runtime; every kernel has a scalar fallback that gives identical results
+
+namespace pul::physics {
+
+  enum class SimdLevel : size_t {
+    Scalar, Sse2, Avx2
+  , Size
+  };
+
+  // best level supported by the CPU, detected once
+  SimdLevel DetectedSimdLevel();
+
+  // level the kernels dispatch to, the detected one unless overridden
+  SimdLevel ActiveSimdLevel();
+
+  // for benchmarking & debugging, clamped to the detected level
+  void OverrideSimdLevel(SimdLevel level);
+
+  // writes 1 for every point on a texel of the layer that is solid to any of
+  // the channels, 0 otherwise; the same answer as IntersectionPoint's
+  // collision. solid has to be at least as long as points
+  void SolidTexels(
+    TilemapLayer const & layer
+  , std::span<IntersectorPoint const> points
+  , std::span<uint8_t> solid
+  , pul::core::CollisionChannel channels
+  );
+}
+
+char const * ToStr(pul::physics::SimdLevel level);
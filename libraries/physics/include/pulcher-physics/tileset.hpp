@@ -1,25 +1,166 @@
 #pragma once
 
+#include <pulcher-core/map.hpp>
+#include <pulcher-util/enum.hpp>
+
+#include <glm/glm.hpp>
+
 #include <array>
+#include <bit>
+#include <span>
 #include <vector>
 
 // SDF tilesets
 
 namespace pul::physics {
 
+  // hints apply to either a tile or a block of texels within a tile
   enum struct TileIntersectAccelerationHint : uint8_t {
-    Default = 0b0 // no info, must use SDF
+    Default = 0b0 // no info/mixed, must use SDF
   , Empty = 0b0001 // empty tile, intersection can be skipped as no collision
   , Full = 0b0010 // tile has no alpha, intersection gaurunteed to collide
   };
 
   struct Tile {
     static size_t constexpr gridSize = 32ul;
-    std::array<std::array<float, gridSize>, gridSize> signedDistanceField;
-    std::array<std::array<uint8_t, gridSize>, gridSize> accelerationHints;
+    static size_t constexpr blockSize = 8ul;
+    static size_t constexpr blockGridSize = gridSize / blockSize;
+
+    using SolidMask = std::array<std::array<bool, gridSize>, gridSize>;
+
+    // euclidean distance in whole texels (rounded down), empty texels store
+    // the distance to the nearest solid texel of the tile, while solid texels
+    // store the negated distance to the nearest empty texel. Distances are
+    // clamped to the int8 range, which only uniform tiles reach. Indexed
+    // [x][y], and stored apart from the tiles as only sphere tracing reads it
+    using DistanceField = std::array<std::array<int8_t, gridSize>, gridSize>;
+
+    // channels of every texel, none for empty texels; indexed [x][y]. Only
+    // tiles with mixed channels have theirs stored, in a table apart from the
+    // tiles, the texels of every other tile block the channels of the tile
+    using TexelChannels = std::array<std::array<uint8_t, gridSize>, gridSize>;
+
+    static uint16_t constexpr uniformChannels = 0xFFFF;
+
+    // bit x of row y is set when the texel is solid
+    std::array<uint32_t, gridSize> mask;
+
+    TileIntersectAccelerationHint accelerationHint;
+
+    // hints of every blockSize x blockSize texel block, indexed [x][y]
+    std::array<
+      std::array<TileIntersectAccelerationHint, blockGridSize>, blockGridSize
+    > blockAccelerationHints;
+
+    // channels blocked by any of the solid texels
+    pul::core::CollisionChannel channels = pul::core::CollisionChannel::All;
+
+    // index of the texel channels when the solid texels don't all block the
+    // same channels, as happens when tiles of different layers overlap. The
+    // mask, distances, normals & hints are then those of the union of every
+    // channel, so filtered queries have to look up the channels of texels they
+    // find solid. Follows the channels so that both are read as one word
+    uint16_t mixedChannelsIdx = uniformChannels;
+
+    bool Mixed() const { return this->mixedChannelsIdx != uniformChannels; }
+
+    bool Solid(glm::u32vec2 const texel) const {
+      return (this->mask[texel.y] >> texel.x) & 1u;
+    }
+
+    // solid for any of the given channels, mixed tiles look theirs up in the
+    // table their index is into
+    bool Solid(
+      glm::u32vec2 const texel, pul::core::CollisionChannel const filter
+    , std::span<TexelChannels const> const mixedTexelChannels
+    ) const {
+      if (!this->Solid(texel)) { return false; }
+      return
+        (
+          this->Mixed()
+        ? mixedTexelChannels[this->mixedChannelsIdx][texel.x][texel.y]
+        : Idx(this->channels)
+        ) & Idx(filter);
+    }
+
+    // if none of the channels are blocked the tile is empty to the query
+    bool Blocks(pul::core::CollisionChannel const filter) const {
+      return Idx(this->channels) & Idx(filter);
+    }
+
+    // whether the mask, distances & hints are exactly the solid texels of a
+    // query filtering on the channels; otherwise only their empty texels are
+    bool Exact(pul::core::CollisionChannel const filter) const {
+      return !this->Mixed() || (Idx(this->channels) & ~Idx(filter)) == 0;
+    }
+
+    // sum of the offsets towards the solid texels of the 3x3 neighbourhood,
+    // so it points into the surface; texels outside of the tile count as empty.
+    // Only contacts need it, so it's read off the mask rather than stored
+    glm::i32vec2 Normal(glm::u32vec2 const texel) const {
+      glm::i32vec2 normal = glm::i32vec2(0);
+      for (int32_t offsetY = -1; offsetY <= +1; ++ offsetY) {
+        // negative rows wrap around to fail the bounds test
+        uint32_t const y = texel.y + static_cast<uint32_t>(offsetY);
+        if (y >= gridSize) { continue; }
+
+        // texels x-1, x & x+1 of the row as bits 0, 1 & 2
+        uint32_t const row =
+          static_cast<uint32_t>(
+            (static_cast<uint64_t>(this->mask[y]) << 1) >> texel.x
+          ) & 0b111u;
+
+        normal.x +=
+          static_cast<int32_t>(row >> 2) - static_cast<int32_t>(row & 1u);
+        normal.y += offsetY * std::popcount(row);
+      }
+      return normal;
+    }
+
+    // channels of every texel, from the table if the tile is mixed
+    TexelChannels ComputeTexelChannels(
+      std::span<TexelChannels const> mixedTexelChannels
+    ) const;
+
+    // copy of the tile with the orientation baked in, so that it can be
+    // sampled directly in tilemap space; the tile can't be mixed
+    Tile Oriented(pul::core::TileOrientation orientation) const;
+
+    // copy of the tile with every solid texel blocking the channels
+    Tile WithChannels(pul::core::CollisionChannel channels) const;
+
+    // union of the solid texels of both tiles, texels keep the channels of
+    // whichever tiles they are solid in. If those differ the tile is mixed,
+    // and the channels of its texels are appended to the table
+    Tile Combined(
+      Tile const & other, std::vector<TexelChannels> & mixedTexelChannels
+    ) const;
+
+    // signed distance field of the solid texels of the mask
+    DistanceField ComputeDistanceField() const;
+
+    // solids are indexed [x][y] the same as the signed distance field
+    static Tile Construct(SolidMask const & solids);
   };
 
+  // nothing is stored per texel besides the mask
+  static_assert(sizeof(Tile) == 148ul);
+
+  // applies tile orientation to a tile-local coordinate of a grid with the
+  // given size, blocks use the same orientation as texels
+  glm::u32vec2 OrientTexel(
+    pul::core::TileOrientation orientation
+  , glm::u32vec2 texel
+  , uint32_t gridSize
+  );
+
   struct Tileset {
     std::vector<pul::physics::Tile> tiles;
+
+    // texels are stored bottom-up, as images are loaded, and any texel with
+    // alpha is solid
+    static Tileset Construct(
+      std::span<glm::u8vec4 const> texels, size_t width, size_t height
+    );
   };
 }
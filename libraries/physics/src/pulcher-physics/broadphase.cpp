@@ -0,0 +1,383 @@
+#include <pulcher-physics/broadphase.hpp>
+
+#include <pulcher-physics/intersections.hpp>
+
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+void Bin(pul::physics::EntityBroadphase & broadphase, size_t const recordIdx) {
+  auto const & record = broadphase.records[recordIdx];
+  for (int32_t y = record.cellMin.y; y <= record.cellMax.y; ++ y)
+  for (int32_t x = record.cellMin.x; x <= record.cellMax.x; ++ x) {
+    auto & bucket =
+      broadphase.buckets[
+        pul::physics::EntityBroadphase::BucketIdx(glm::i32vec2(x, y))
+      ];
+
+    // several cells of the same record can hash to the same bucket
+    if (std::find(bucket.begin(), bucket.end(), recordIdx) == bucket.end())
+      { bucket.emplace_back(recordIdx); }
+  }
+}
+
+void Unbin(
+  pul::physics::EntityBroadphase & broadphase, size_t const recordIdx
+) {
+  auto const & record = broadphase.records[recordIdx];
+  for (int32_t y = record.cellMin.y; y <= record.cellMax.y; ++ y)
+  for (int32_t x = record.cellMin.x; x <= record.cellMax.x; ++ x) {
+    auto & bucket =
+      broadphase.buckets[
+        pul::physics::EntityBroadphase::BucketIdx(glm::i32vec2(x, y))
+      ];
+
+    auto it = std::find(bucket.begin(), bucket.end(), recordIdx);
+    if (it == bucket.end()) { continue; }
+
+    *it = bucket.back();
+    bucket.pop_back();
+  }
+}
+
+// walks the cells the ray crosses in order (Amanatides & Woo), fn receives the
+// cell and the ray parameter at which it's entered, and returns false to stop
+template <typename Fn> void WalkRayCells(
+  glm::vec2 const & rayBegin, glm::vec2 const & rayDelta, Fn && fn
+) {
+  glm::i32vec2 cell = pul::physics::EntityBroadphase::CellIdx(rayBegin);
+  glm::i32vec2 const
+    endCell = pul::physics::EntityBroadphase::CellIdx(rayBegin + rayDelta)
+  , step =
+      glm::i32vec2(rayDelta.x < 0.0f ? -1 : +1, rayDelta.y < 0.0f ? -1 : +1)
+  ;
+
+  // tMax is the ray parameter at which the next cell boundary of that axis is
+  // crossed, tDelta the parameter it takes to cross an entire cell
+  float const cellSize =
+    static_cast<float>(pul::physics::EntityBroadphase::cellSize);
+  glm::vec2 tMax, tDelta;
+  for (int axis = 0; axis < 2; ++ axis) {
+    if (rayDelta[axis] == 0.0f) {
+      tMax[axis] = tDelta[axis] = std::numeric_limits<float>::infinity();
+      continue;
+    }
+
+    float const boundary =
+      static_cast<float>(cell[axis] + (step[axis] > 0 ? 1 : 0)) * cellSize;
+    tMax[axis] = (boundary - rayBegin[axis]) / rayDelta[axis];
+    tDelta[axis] = cellSize / glm::abs(rayDelta[axis]);
+  }
+
+  if (!fn(cell, 0.0f)) { return; }
+
+  // an axis that already reached the end cell is never stepped again, so
+  // floating point drift can't make the walk overshoot the end cell
+  while (cell != endCell) {
+    bool const stepX =
+        cell.y == endCell.y || (cell.x != endCell.x && tMax.x < tMax.y);
+
+    float cellEnter;
+    if (stepX) {
+      cell.x += step.x;
+      cellEnter = tMax.x;
+      tMax.x += tDelta.x;
+    } else {
+      cell.y += step.y;
+      cellEnter = tMax.y;
+      tMax.y += tDelta.y;
+    }
+
+    if (!fn(cell, cellEnter)) { return; }
+  }
+}
+
+void AddResult(
+  pul::physics::EntityIntersectionResults & results
+, glm::vec2 const & origin, entt::entity const entity
+) {
+  results.collision = true;
+  results.entities.emplace_back(glm::i32vec2(glm::round(origin)), entity);
+}
+
+} // -- namespace
+
+void pul::physics::EntityBroadphase::Clear() {
+  this->records.clear();
+  this->entityToRecord.clear();
+
+  // keeps the capacity of the buckets around for the next rebuild
+  for (auto & bucket : this->buckets)
+    { bucket.clear(); }
+}
+
+void pul::physics::EntityBroadphase::Update(
+  entt::entity const entity
+, glm::vec2 const & aabbOrigin, glm::vec2 const & aabbDimensions
+) {
+  glm::i32vec2 const
+    cellMin =
+      EntityBroadphase::CellIdx(
+        pul::physics::GetAabbMin(aabbOrigin, aabbDimensions)
+      )
+  , cellMax =
+      EntityBroadphase::CellIdx(
+        pul::physics::GetAabbMax(aabbOrigin, aabbDimensions)
+      )
+  ;
+
+  auto recordIt = this->entityToRecord.find(entity);
+
+  if (recordIt == this->entityToRecord.end()) {
+    size_t const recordIdx = this->records.size();
+    this->records.emplace_back(
+      Record { entity, aabbOrigin, aabbDimensions, cellMin, cellMax, 0u }
+    );
+    this->entityToRecord.emplace(entity, recordIdx);
+    ::Bin(*this, recordIdx);
+    return;
+  }
+
+  size_t const recordIdx = recordIt->second;
+  auto & record = this->records[recordIdx];
+  record.aabbOrigin = aabbOrigin;
+  record.aabbDimensions = aabbDimensions;
+
+  if (record.cellMin == cellMin && record.cellMax == cellMax)
+    { return; }
+
+  ::Unbin(*this, recordIdx);
+  record.cellMin = cellMin;
+  record.cellMax = cellMax;
+  ::Bin(*this, recordIdx);
+}
+
+void pul::physics::EntityBroadphase::Remove(entt::entity const entity) {
+  auto recordIt = this->entityToRecord.find(entity);
+  if (recordIt == this->entityToRecord.end()) { return; }
+
+  size_t const recordIdx = recordIt->second;
+  size_t const lastIdx = this->records.size() - 1ul;
+  this->entityToRecord.erase(recordIt);
+
+  ::Unbin(*this, recordIdx);
+
+  // move the last record into the hole so records stay packed
+  if (recordIdx != lastIdx) {
+    ::Unbin(*this, lastIdx);
+    this->records[recordIdx] = this->records[lastIdx];
+    this->entityToRecord[this->records[recordIdx].entity] = recordIdx;
+    ::Bin(*this, recordIdx);
+  }
+
+  this->records.pop_back();
+}
+
+size_t pul::physics::EntityBroadphase::BucketIdx(glm::i32vec2 const cell) {
+  uint32_t const hash =
+      static_cast<uint32_t>(cell.x) * 73856093u
+    ^ static_cast<uint32_t>(cell.y) * 19349663u
+  ;
+  return static_cast<size_t>(hash) & (bucketCount - 1ul);
+}
+
+glm::i32vec2 pul::physics::EntityBroadphase::CellIdx(glm::vec2 const origin) {
+  return glm::i32vec2(glm::floor(origin / static_cast<float>(cellSize)));
+}
+
+uint32_t pul::physics::EntityBroadphase::BeginQuery() {
+  // on wrap-around stale stamps could collide with new ones
+  if (++ this->queryStamp == 0u) {
+    for (auto & record : this->records)
+      { record.queryStamp = 0u; }
+    this->queryStamp = 1u;
+  }
+  return this->queryStamp;
+}
+
+void pul::physics::EntityIntersectionRaycast(
+  pul::physics::EntityBroadphase & broadphase
+, pul::physics::IntersectorRay const & ray
+, pul::physics::EntityIntersectionResults & results
+) {
+  results.collision = false;
+  results.entities.clear();
+
+  if (ray.beginOrigin == ray.endOrigin) { return; }
+
+  glm::vec2 const
+    rayBegin = glm::vec2(ray.beginOrigin)
+  , rayDelta = glm::vec2(ray.endOrigin) - rayBegin
+  ;
+
+  uint32_t const stamp = broadphase.BeginQuery();
+
+  float const rayLength = glm::length(rayDelta);
+  glm::vec2 const rayNormal = rayDelta / rayLength;
+
+  ::WalkRayCells(
+    rayBegin, rayDelta
+  , [&](glm::i32vec2 const cell, float const) {
+      for (
+        size_t const recordIdx
+      : broadphase.buckets[pul::physics::EntityBroadphase::BucketIdx(cell)]
+      ) {
+        auto & record = broadphase.records[recordIdx];
+        if (record.queryStamp == stamp) { continue; }
+        record.queryStamp = stamp;
+
+        float intersectionLength;
+        if (
+          pul::physics::IntersectionRayAabbDistance(
+            rayBegin, rayNormal, rayLength
+          , record.aabbOrigin, record.aabbDimensions
+          , intersectionLength
+          )
+        ) {
+          ::AddResult(
+            results, rayBegin + intersectionLength*rayNormal, record.entity
+          );
+        }
+      }
+      return true;
+    }
+  );
+}
+
+void pul::physics::EntityIntersectionRaycastNearest(
+  pul::physics::EntityBroadphase & broadphase
+, pul::physics::IntersectorRay const & ray
+, entt::entity const ignoredEntity
+, pul::physics::EntityRaycastHits & hits
+) {
+  hits.size = 0ul;
+
+  size_t const maxHits =
+    std::clamp(hits.maxHits, 1ul, pul::physics::EntityRaycastHits::capacity);
+
+  if (ray.beginOrigin == ray.endOrigin) { return; }
+
+  glm::vec2 const
+    rayBegin = glm::vec2(ray.beginOrigin)
+  , rayDelta = glm::vec2(ray.endOrigin) - rayBegin
+  ;
+
+  float const rayLength = glm::length(rayDelta);
+  glm::vec2 const rayNormal = rayDelta / rayLength;
+
+  // shrinks to the furthest kept hit once all hit slots are filled
+  float clipLength = rayLength;
+
+  uint32_t const stamp = broadphase.BeginQuery();
+
+  ::WalkRayCells(
+    rayBegin, rayDelta
+  , [&](glm::i32vec2 const cell, float const cellEnter) {
+      // any hit in this cell or past it is further than the clipped ray
+      if (cellEnter*rayLength >= clipLength) { return false; }
+
+      for (
+        size_t const recordIdx
+      : broadphase.buckets[pul::physics::EntityBroadphase::BucketIdx(cell)]
+      ) {
+        auto & record = broadphase.records[recordIdx];
+        if (record.queryStamp == stamp) { continue; }
+        record.queryStamp = stamp;
+
+        if (record.entity == ignoredEntity) { continue; }
+
+        float distance;
+        if (
+          !pul::physics::IntersectionRayAabbDistance(
+            rayBegin, rayNormal, clipLength
+          , record.aabbOrigin, record.aabbDimensions
+          , distance
+          )
+        ) {
+          continue;
+        }
+
+        // insertion sort, when full the furthest hit is dropped; it's always
+        // further than this one since the ray was clipped to it
+        size_t hitIdx = hits.size < maxHits ? hits.size ++ : maxHits - 1ul;
+        while (hitIdx > 0ul && hits.hits[hitIdx-1ul].distance > distance) {
+          hits.hits[hitIdx] = hits.hits[hitIdx-1ul];
+          -- hitIdx;
+        }
+
+        hits.hits[hitIdx] =
+          pul::physics::EntityRaycastHits::Hit {
+            distance
+          , glm::i32vec2(glm::round(rayBegin + distance*rayNormal))
+          , record.entity
+          };
+
+        if (hits.size == maxHits)
+          { clipLength = hits.hits[maxHits-1ul].distance; }
+      }
+
+      return true;
+    }
+  );
+}
+
+void pul::physics::EntityIntersectionCircle(
+  pul::physics::EntityBroadphase & broadphase
+, pul::physics::IntersectorCircle const & circle
+, pul::physics::EntityIntersectionResults & results
+) {
+  results.collision = false;
+  results.entities.clear();
+
+  uint32_t const stamp = broadphase.BeginQuery();
+  glm::vec2 const circleOrigin = glm::vec2(circle.origin);
+
+  auto const visitBucket = [&](std::vector<size_t> const & bucket) {
+    for (size_t const recordIdx : bucket) {
+      auto & record = broadphase.records[recordIdx];
+      if (record.queryStamp == stamp) { continue; }
+      record.queryStamp = stamp;
+
+      glm::vec2 closestOrigin;
+      if (
+        pul::physics::IntersectionCircleAabb(
+          circleOrigin, circle.radius
+        , record.aabbOrigin, record.aabbDimensions
+        , closestOrigin
+        )
+      ) {
+        ::AddResult(results, closestOrigin, record.entity);
+      }
+    }
+  };
+
+  glm::i32vec2 const
+    cellMin =
+      pul::physics::EntityBroadphase::CellIdx(circleOrigin - circle.radius)
+  , cellMax =
+      pul::physics::EntityBroadphase::CellIdx(circleOrigin + circle.radius)
+  ;
+
+  // a circle covering more cells than there are buckets would visit every
+  // bucket anyways
+  size_t const cellCount =
+      static_cast<size_t>(cellMax.x - cellMin.x + 1)
+    * static_cast<size_t>(cellMax.y - cellMin.y + 1)
+  ;
+
+  if (cellCount >= pul::physics::EntityBroadphase::bucketCount) {
+    for (auto const & bucket : broadphase.buckets)
+      { visitBucket(bucket); }
+    return;
+  }
+
+  for (int32_t y = cellMin.y; y <= cellMax.y; ++ y)
+  for (int32_t x = cellMin.x; x <= cellMax.x; ++ x) {
+    visitBucket(
+      broadphase.buckets[
+        pul::physics::EntityBroadphase::BucketIdx(glm::i32vec2(x, y))
+      ]
+    );
+  }
+}
@@ -1,7 +1,411 @@
 #include <pulcher-physics/intersections.hpp>
 
+#include <pulcher-physics/kernels.hpp>
+#include <pulcher-physics/tileset.hpp>
 #include <pulcher-util/enum.hpp>
 #include <pulcher-util/log.hpp>
+#include <pulcher-util/math.hpp>
+
+#include <bit>
+#include <limits>
+#include <map>
+#include <tuple>
+
+namespace {
+
+int32_t constexpr tileSize = static_cast<int32_t>(pul::physics::Tile::gridSize);
+
+// points handed to the solidity kernel at once by the batched point queries
+size_t constexpr pointKernelBatch = 64ul;
+
+struct TexelSample {
+  // null when the texel is outside of the tilemap
+  pul::physics::TilemapLayer::TileInfo const * tile = nullptr;
+
+  // negative when solid, unbounded when the sample is uniform
+  float distance = std::numeric_limits<float>::max();
+
+  // uniform samples share their solidity with every texel in the box,
+  // otherwise the box is the tile that the distance is local to
+  bool uniform = true;
+  glm::i32vec2 boxMin, boxMax;
+};
+
+int32_t FloorTile(int32_t const coord) {
+  return coord < 0 ? (coord - tileSize + 1) / tileSize : coord / tileSize;
+}
+
+glm::i32vec2 FloorTile(glm::i32vec2 const origin) {
+  return glm::i32vec2(::FloorTile(origin.x), ::FloorTile(origin.y));
+}
+
+TexelSample SampleTexel(
+  pul::physics::TilemapLayer const & layer, glm::i32vec2 const origin
+, pul::core::CollisionChannel const channels
+) {
+  using Hint = pul::physics::TileIntersectAccelerationHint;
+  using TilemapLayer = pul::physics::TilemapLayer;
+
+  TexelSample sample;
+  glm::i32vec2 const tile = ::FloorTile(origin);
+  sample.boxMin = tile * tileSize;
+  sample.boxMax = sample.boxMin + glm::i32vec2(tileSize - 1);
+
+  sample.tile = layer.Tile(tile);
+  if (!sample.tile) { return sample; }
+
+  // nothing in the entire chunk blocks the query, so all of it can be skipped
+  auto const * chunk = layer.ChunkOf(tile);
+  if (!chunk || !(Idx(chunk->channels) & Idx(channels))) {
+    int32_t constexpr chunkTexels = TilemapLayer::chunkSize * tileSize;
+    sample.boxMin =
+      glm::i32vec2(
+        tile.x >> TilemapLayer::chunkShift, tile.y >> TilemapLayer::chunkShift
+      ) * chunkTexels;
+    sample.boxMax = sample.boxMin + glm::i32vec2(chunkTexels - 1);
+    return sample;
+  }
+
+  if (!sample.tile->Valid()) { return sample; }
+
+  pul::physics::Tile const & physicsTile =
+    layer.orientedTiles[sample.tile->orientedTileIdx];
+
+  if (!physicsTile.Blocks(channels)) { return sample; }
+
+  // hints of tiles combining several channels only hold for their empty parts
+  bool const exact = physicsTile.Exact(channels);
+
+  // -- tile level hints
+  if (physicsTile.accelerationHint == Hint::Empty) { return sample; }
+  if (physicsTile.accelerationHint == Hint::Full && exact) {
+    sample.distance = -std::numeric_limits<float>::max();
+    return sample;
+  }
+
+  // -- block level hints
+  auto constexpr blockSize =
+    static_cast<int32_t>(pul::physics::Tile::blockSize);
+  glm::u32vec2 const texel = glm::u32vec2(origin - sample.boxMin);
+  glm::u32vec2 const block = texel / static_cast<uint32_t>(blockSize);
+
+  Hint const blockHint = physicsTile.blockAccelerationHints[block.x][block.y];
+
+  if (blockHint == Hint::Empty || (blockHint == Hint::Full && exact)) {
+    if (blockHint == Hint::Full)
+      { sample.distance = -std::numeric_limits<float>::max(); }
+    sample.boxMin += glm::i32vec2(block) * blockSize;
+    sample.boxMax = sample.boxMin + glm::i32vec2(blockSize - 1);
+    return sample;
+  }
+
+  sample.uniform = false;
+  auto const & distanceField =
+    layer.orientedDistanceFields[sample.tile->orientedTileIdx];
+  sample.distance = distanceField[texel.x][texel.y];
+
+  // distances to solid texels of the union can only be shorter than to those
+  // of the channels, but solid texels may turn out to be empty to the query
+  if (!exact && physicsTile.Solid(texel)) {
+    sample.distance =
+        physicsTile.Solid(texel, channels, layer.mixedTexelChannels)
+      ? -1.0f : +1.0f;
+  }
+
+  return sample;
+}
+
+// tile of the texel if it's solid, otherwise null
+pul::physics::TilemapLayer::TileInfo const * SolidTexel(
+  pul::physics::TilemapLayer const & layer, glm::i32vec2 const origin
+, pul::core::CollisionChannel const channels
+) {
+  glm::i32vec2 const tile = ::FloorTile(origin);
+
+  auto const * tileInfo = layer.Tile(tile);
+  if (!tileInfo || !tileInfo->Valid()) { return nullptr; }
+
+  if (
+    !layer
+      .orientedTiles[tileInfo->orientedTileIdx]
+      .Solid(
+        glm::u32vec2(origin - tile*tileSize), channels
+      , layer.mixedTexelChannels
+      )
+  ) {
+    return nullptr;
+  }
+
+  return tileInfo;
+}
+
+// tiles that were never placed have no indices to report
+pul::physics::IntersectionResults TileResults(
+  pul::physics::TilemapLayer::TileInfo const & tileInfo
+, glm::i32vec2 const origin
+, glm::vec2 const normal
+) {
+  if (!tileInfo.Valid()) {
+    return
+      pul::physics::IntersectionResults { true, origin, -1ul, -1ul, normal };
+  }
+
+  return
+    pul::physics::IntersectionResults {
+      true, origin, tileInfo.imageTileIdx, tileInfo.tilesetIdx, normal
+    };
+}
+
+glm::vec2 SurfaceNormal(
+  pul::physics::TilemapLayer const & layer
+, pul::physics::TilemapLayer::TileInfo const & tileInfo
+, glm::i32vec2 const origin
+, pul::core::CollisionChannel const channels
+) {
+  glm::u32vec2 const texel =
+    glm::u32vec2(origin - ::FloorTile(origin)*tileSize);
+
+  uint32_t constexpr edge = static_cast<uint32_t>(tileSize) - 1u;
+  glm::i32vec2 normal = glm::i32vec2(0);
+
+  auto const & tile = layer.orientedTiles[tileInfo.orientedTileIdx];
+
+  if (
+      texel.x != 0u && texel.y != 0u && texel.x != edge && texel.y != edge
+   && tile.Exact(channels)
+  ) {
+    normal = tile.Normal(texel);
+  } else {
+    // the tile can't know its neighbours, so texels along its border have to
+    // look at the surrounding tiles, as do texels whose mask normal
+    // includes channels the query doesn't see
+    for (int32_t offsetY = -1; offsetY <= +1; ++ offsetY)
+    for (int32_t offsetX = -1; offsetX <= +1; ++ offsetX) {
+      glm::i32vec2 const offset = glm::i32vec2(offsetX, offsetY);
+      if (
+          offset != glm::i32vec2(0)
+       && ::SolidTexel(layer, origin + offset, channels)
+      ) {
+        normal += offset;
+      }
+    }
+  }
+
+  if (normal == glm::i32vec2(0)) { return glm::vec2(0.0f); }
+  return glm::normalize(glm::vec2(normal));
+}
+
+// -- swept AABB
+
+// overlaps shallower than this at the start of a sweep count as touching, so
+// that resting contacts survive floating point error
+float constexpr contactSlop = 0.01f;
+
+struct AabbSweep {
+  glm::vec2 boxMin, boxMax, velocity;
+
+  // earliest contact so far, against the solid box contactMin/contactMax
+  float timeOfImpact = std::numeric_limits<float>::max();
+  int32_t axis = -1;
+  glm::vec2 contactMin, contactMax;
+};
+
+// returns false if the AABB already overlaps the solid box at the start
+bool SweepAgainst(
+  AabbSweep & sweep, glm::vec2 const solidMin, glm::vec2 const solidMax
+) {
+  float enter = -std::numeric_limits<float>::max();
+  float exit = +std::numeric_limits<float>::max();
+  int32_t enterAxis = -1;
+
+  for (int32_t axis = 0; axis < 2; ++ axis) {
+    float const velocity = sweep.velocity[axis];
+
+    // not moving along this axis, so it has to overlap the entire sweep
+    if (velocity == 0.0f) {
+      if (
+          sweep.boxMax[axis] <= solidMin[axis]
+       || sweep.boxMin[axis] >= solidMax[axis]
+      ) {
+        return true;
+      }
+      continue;
+    }
+
+    float const
+      axisEnter =
+        (
+          velocity > 0.0f
+        ? solidMin[axis] - sweep.boxMax[axis]
+        : solidMax[axis] - sweep.boxMin[axis]
+        ) / velocity
+    , axisExit =
+        (
+          velocity > 0.0f
+        ? solidMax[axis] - sweep.boxMin[axis]
+        : solidMin[axis] - sweep.boxMax[axis]
+        ) / velocity
+    ;
+
+    if (axisEnter > enter) {
+      enter = axisEnter;
+      enterAxis = axis;
+    }
+    exit = glm::min(exit, axisExit);
+  }
+
+  if (enterAxis == -1 || enter >= exit || exit <= 0.0f || enter > 1.0f)
+    { return true; }
+
+  // overlapping at the start already, the AABB is allowed to move out of it
+  if (enter * glm::abs(sweep.velocity[enterAxis]) < -contactSlop)
+    { return false; }
+
+  enter = glm::max(enter, 0.0f);
+
+  // on exact corner hits prefer the vertical contact so floors stay floors
+  if (
+      enter < sweep.timeOfImpact
+   || (enter == sweep.timeOfImpact && enterAxis == 1 && sweep.axis == 0)
+  ) {
+    sweep.timeOfImpact = enter;
+    sweep.axis = enterAxis;
+    sweep.contactMin = solidMin;
+    sweep.contactMax = solidMax;
+  }
+
+  return true;
+}
+
+// uniformly solid box, if the AABB starts inside of it then only the texels it
+// overlaps may be moved out of, so those have to be tested individually
+void SweepAgainstSolidBox(
+  AabbSweep & sweep
+, glm::i32vec2 const boxMin, glm::i32vec2 const boxSize
+, glm::i32vec2 const texelMin, glm::i32vec2 const texelMax
+) {
+  if (::SweepAgainst(sweep, glm::vec2(boxMin), glm::vec2(boxMin + boxSize)))
+    { return; }
+
+  glm::i32vec2 const
+    rangeMin = glm::max(texelMin, boxMin)
+  , rangeMax = glm::min(texelMax, boxMin + boxSize - glm::i32vec2(1))
+  ;
+
+  for (int32_t y = rangeMin.y; y <= rangeMax.y; ++ y)
+  for (int32_t x = rangeMin.x; x <= rangeMax.x; ++ x) {
+    ::SweepAgainst(
+      sweep, glm::vec2(x, y), glm::vec2(x, y) + glm::vec2(1.0f)
+    );
+  }
+}
+
+// samples the texel at idx of the traversal, either writing the results of a
+// collision or advancing idx past every texel the sample proves can't collide
+bool RaycastStep(
+  pul::physics::TilemapLayer const & layer
+, pul::physics::BresenhamTraversal const & traversal
+, uint32_t & idx
+, pul::physics::IntersectionResults & results
+, bool const inverse
+, pul::core::CollisionChannel const channels
+) {
+  glm::i32vec2 const origin = traversal.Texel(idx);
+  auto const sample = ::SampleTexel(layer, origin, channels);
+
+  bool const collision =
+      inverse
+    ? sample.tile && sample.distance > 0.0f
+    : sample.distance < 0.0f
+  ;
+
+  if (collision) {
+    // an empty texel has no surface to speak of
+    glm::vec2 const normal =
+      inverse
+        ? glm::vec2(0.0f)
+        : ::SurfaceNormal(layer, *sample.tile, origin, channels)
+    ;
+
+    results = ::TileResults(*sample.tile, origin, normal);
+    return true;
+  }
+
+  uint32_t const boxEnd =
+    traversal.LastIndexWithin(idx, sample.boxMin, sample.boxMax);
+
+  if (sample.uniform) {
+    idx = boxEnd + 1u;
+  } else {
+    idx =
+      std::min(
+        idx + traversal.TexelsWithinRadius(glm::abs(sample.distance)), boxEnd
+      ) + 1u;
+  }
+
+  return false;
+}
+
+// walks the tiles of the ray as a DDA, tiles & blocks that are hinted empty or
+// full are resolved at once. Mixed tiles are sphere traced, the SDF guarantees
+// that no texel within its distance has a different solidity, so those texels
+// are skipped. Distances are only valid locally to their tile, so a skip never
+// exits one; crossing into the next tile costs a single sample, which either
+// resolves from its hints or starts skipping again. Seeding the distances with
+// the tiles around them would only shorten them near the borders, & make them
+// per placement rather than per oriented tile.
+// Rays have no length limit; texels outside of the tilemap can't collide with
+// either query, so the ray is clipped to it first, and the cost then scales
+// with the amount of tiles crossed rather than the length of the ray
+bool Raycast(
+  pul::physics::TilemapLayer const & layer
+, pul::physics::IntersectorRay const & ray
+, pul::physics::IntersectionResults & results
+, bool const inverse
+, pul::core::CollisionChannel const channels
+) {
+  results = {};
+
+  if (layer.Empty()) { return false; }
+
+  auto const traversal =
+    pul::physics::BresenhamTraversal::Construct(
+      ray.beginOrigin, ray.endOrigin
+    );
+
+  uint32_t first, last;
+  if (!traversal.ClipToBox(layer.TexelMin(), layer.TexelMax(), first, last))
+    { return false; }
+
+  for (uint32_t idx = first; idx <= last;) {
+    if (::RaycastStep(layer, traversal, idx, results, inverse, channels))
+      { return true; }
+  }
+
+  return false;
+}
+
+inline bool Point(
+  pul::physics::TilemapLayer const & layer
+, pul::physics::IntersectorPoint const & point
+, pul::physics::IntersectionResults & results
+, pul::core::CollisionChannel const channels
+) {
+  results = {};
+
+  auto const * tileInfo = ::SolidTexel(layer, point.origin, channels);
+  if (!tileInfo) { return false; }
+
+  results =
+    ::TileResults(
+      *tileInfo
+    , point.origin
+    , ::SurfaceNormal(layer, *tileInfo, point.origin, channels)
+    );
+  return true;
+}
+
+} // -- namespace
 
 pul::physics::IntersectorRay pul::physics::IntersectorRay::Construct(
   glm::vec2 const beginOrigin, glm::vec2 const endOrigin
@@ -13,16 +417,765 @@ pul::physics::IntersectorRay pul::physics::IntersectorRay::Construct(
   return ray;
 }
 
-void pul::physics::DebugQueries::Add(
-  pul::physics::IntersectorPoint const & intersector
-, pul::physics::IntersectionResults results
+glm::i32vec2 pul::physics::TilemapLayer::TexelMin() const {
+  return this->tileMin * tileSize;
+}
+
+glm::i32vec2 pul::physics::TilemapLayer::TexelMax() const {
+  return (this->tileMax + glm::i32vec2(1)) * tileSize - glm::i32vec2(1);
+}
+
+float pul::physics::TilemapLayer::SignedDistance(
+  pul::physics::TilemapLayer::TileInfo const & tile
+, glm::u32vec2 texel
+) const {
+  if (!tile.Valid()) { return std::numeric_limits<float>::max(); }
+
+  return this->orientedDistanceFields[tile.orientedTileIdx][texel.x][texel.y];
+}
+
+pul::physics::TilemapLayer pul::physics::TilemapLayer::Construct(
+  std::vector<pul::physics::Tileset const *> const & tilesets
+, std::vector<std::span<size_t>>             const & mapTileIndices
+, std::vector<std::span<glm::i32vec2>>       const & mapTileOrigins
+, std::vector<std::span<pul::core::TileOrientation>> const & mapTileOrientations
+, std::vector<pul::core::CollisionChannel>   const & mapTileChannels
 ) {
-  intersectorPoints.emplace_back(intersector, results);
+  pul::physics::TilemapLayer self;
+
+  // -- assert tilesets.size == mapTileIndices.size == mapTileOrigins.size
+  if (tilesets.size() != mapTileOrigins.size()) {
+    spdlog::critical("mismatching size on tilesets & map tile origins");
+    return self;
+  }
+
+  if (mapTileIndices.size() != mapTileOrigins.size()) {
+    spdlog::critical("mismatching size on map tile indices/origins");
+    return self;
+  }
+
+  if (mapTileChannels.size() != mapTileOrigins.size()) {
+    spdlog::critical("mismatching size on map tile channels/origins");
+    return self;
+  }
+
+  // tile records only have room for this many
+  PUL_ASSERT_CMP(tilesets.size(), <, 0xFFul, return self;);
+
+  // -- compute bounds of tilemap
+  self.tileMin = glm::i32vec2(std::numeric_limits<int32_t>::max());
+  self.tileMax = glm::i32vec2(std::numeric_limits<int32_t>::min());
+  for (auto & tileOrigins : mapTileOrigins)
+  for (auto & origin : tileOrigins) {
+    self.tileMin = glm::min(self.tileMin, origin);
+    self.tileMax = glm::max(self.tileMax, origin);
+  }
+
+  if (self.Empty()) {
+    self.tileMin = glm::i32vec2(0);
+    self.tileMax = glm::i32vec2(-1);
+    return self;
+  }
+
+  self.chunkMin =
+    glm::i32vec2(self.tileMin.x >> chunkShift, self.tileMin.y >> chunkShift);
+  self.chunkDimensions =
+      glm::i32vec2(self.tileMax.x >> chunkShift, self.tileMax.y >> chunkShift)
+    - self.chunkMin + glm::i32vec2(1);
+
+  // copy tilesets over
+  self.tilesets = decltype(self.tilesets){tilesets.begin(), tilesets.end()};
+
+  // chunks are only allocated once a tile is placed in them
+  self.chunkTable.resize(
+    static_cast<size_t>(self.chunkDimensions.x) * self.chunkDimensions.y, -1u
+  );
+
+  std::map<std::tuple<size_t, size_t, size_t, size_t>, size_t>
+    orientedTileIndices;
+
+  // combinations of two oriented tiles, for tiles placed on top of others
+  std::map<std::pair<size_t, size_t>, size_t> combinedTileIndices;
+
+  // cache tileset info for quick tile fetching
+  for (size_t tilesetIdx = 0ul; tilesetIdx < tilesets.size(); ++ tilesetIdx) {
+    auto const & tileIndices = mapTileIndices[tilesetIdx];
+    auto const & tileOrigins = mapTileOrigins[tilesetIdx];
+    auto const & tileOrientations = mapTileOrientations[tilesetIdx];
+    auto const tileChannels = mapTileChannels[tilesetIdx];
+
+    PUL_ASSERT(tilesets[tilesetIdx], continue;);
+
+    for (size_t i = 0ul; i < tileIndices.size(); ++ i) {
+      auto const & imageTileIdx    = tileIndices[i];
+      auto const & tileOrigin      = tileOrigins[i];
+      auto const & tileOrientation = tileOrientations[i];
+
+      PUL_ASSERT_CMP(
+        imageTileIdx, <, tilesets[tilesetIdx]->tiles.size(), continue;
+      );
+      PUL_ASSERT_CMP(imageTileIdx, <, 0xFFFFul, continue;);
+
+      glm::i32vec2 const chunk =
+          glm::i32vec2(tileOrigin.x >> chunkShift, tileOrigin.y >> chunkShift)
+        - self.chunkMin;
+
+      uint32_t & chunkIdx =
+        self.chunkTable[chunk.y*self.chunkDimensions.x + chunk.x];
+
+      if (chunkIdx == -1u) {
+        chunkIdx = static_cast<uint32_t>(self.chunks.size());
+        self.chunks.emplace_back();
+      }
+
+      auto & tile =
+        self.chunks[chunkIdx].tiles[
+          (tileOrigin.y & (chunkSize-1))*chunkSize
+        + (tileOrigin.x & (chunkSize-1))
+        ];
+
+      // -- bake orientation & channels, sharing the tile with identical
+      //    placements
+      auto const key =
+        std::make_tuple(
+          tilesetIdx, imageTileIdx, Idx(tileOrientation), Idx(tileChannels)
+        );
+
+      auto orientedTileIt = orientedTileIndices.find(key);
+      if (orientedTileIt == orientedTileIndices.end()) {
+        orientedTileIt =
+          orientedTileIndices.emplace(key, self.orientedTiles.size()).first;
+        self.orientedTiles.emplace_back(
+          tilesets[tilesetIdx]->tiles[imageTileIdx]
+            .Oriented(tileOrientation)
+            .WithChannels(tileChannels)
+        );
+      }
+
+      size_t orientedTileIdx = orientedTileIt->second;
+
+      if (!tile.Valid()) {
+        tile.tilesetIdx   = static_cast<uint8_t>(tilesetIdx);
+        tile.imageTileIdx = static_cast<uint16_t>(imageTileIdx);
+        tile.orientation  = static_cast<uint8_t>(Idx(tileOrientation));
+      } else {
+        // -- another layer already placed a tile here, combine both
+        auto const combinedKey =
+          std::make_pair(size_t{tile.orientedTileIdx}, orientedTileIdx);
+
+        auto combinedTileIt = combinedTileIndices.find(combinedKey);
+        if (combinedTileIt == combinedTileIndices.end()) {
+          combinedTileIt =
+            combinedTileIndices
+              .emplace(combinedKey, self.orientedTiles.size())
+              .first;
+
+          // combined before emplacing, as that may reallocate
+          auto combinedTile =
+            self.orientedTiles[tile.orientedTileIdx]
+              .Combined(
+                self.orientedTiles[orientedTileIdx], self.mixedTexelChannels
+              );
+          self.orientedTiles.emplace_back(combinedTile);
+        }
+
+        orientedTileIdx = combinedTileIt->second;
+      }
+
+      tile.orientedTileIdx = static_cast<uint32_t>(orientedTileIdx);
+
+      // -- propagate occupancy up the pyramid
+      auto const & orientedTile = self.orientedTiles[orientedTileIdx];
+      if (
+          orientedTile.accelerationHint
+       != pul::physics::TileIntersectAccelerationHint::Empty
+      ) {
+        auto & chunkChannels = Idx(self.chunks[chunkIdx].channels);
+        chunkChannels |= Idx(orientedTile.channels);
+        Idx(self.channels) |= Idx(orientedTile.channels);
+      }
+    }
+  }
+
+  // -- distances only follow from the final masks
+  self.orientedDistanceFields.reserve(self.orientedTiles.size());
+  for (auto const & orientedTile : self.orientedTiles) {
+    self.orientedDistanceFields.emplace_back(
+      orientedTile.ComputeDistanceField()
+    );
+  }
+
+  return self;
 }
 
-void pul::physics::DebugQueries::Add(
-  pul::physics::IntersectorRay const & intersector
-, pul::physics::IntersectionResults results
+bool pul::physics::IntersectionRaycast(
+  pul::physics::TilemapLayer const & layer
+, pul::physics::IntersectorRay const & ray
+, pul::physics::IntersectionResults & results
+, pul::core::CollisionChannel const channels
 ) {
-  intersectorRays.emplace_back(intersector, results);
+  return ::Raycast(layer, ray, results, false, channels);
+}
+
+bool pul::physics::InverseIntersectionRaycast(
+  pul::physics::TilemapLayer const & layer
+, pul::physics::IntersectorRay const & ray
+, pul::physics::IntersectionResults & results
+, pul::core::CollisionChannel const channels
+) {
+  return ::Raycast(layer, ray, results, true, channels);
+}
+
+bool pul::physics::IntersectionPoint(
+  pul::physics::TilemapLayer const & layer
+, pul::physics::IntersectorPoint const & point
+, pul::physics::IntersectionResults & results
+, pul::core::CollisionChannel const channels
+) {
+  return ::Point(layer, point, results, channels);
+}
+
+bool pul::physics::LineOfSight(
+  pul::physics::TilemapLayer const & layer
+, glm::i32vec2 const beginOrigin
+, glm::i32vec2 const endOrigin
+, pul::core::CollisionChannel const channels
+) {
+  using Hint = pul::physics::TileIntersectAccelerationHint;
+  using TilemapLayer = pul::physics::TilemapLayer;
+
+  int32_t constexpr chunkTexels = TilemapLayer::chunkSize * tileSize;
+  auto constexpr blockSize =
+    static_cast<int32_t>(pul::physics::Tile::blockSize);
+
+  // -- map level
+  if (!(Idx(layer.channels) & Idx(channels))) { return true; }
+
+  auto const traversal =
+    pul::physics::BresenhamTraversal::Construct(beginOrigin, endOrigin);
+
+  uint32_t first, last;
+  if (!traversal.ClipToBox(layer.TexelMin(), layer.TexelMax(), first, last))
+    { return true; }
+
+  for (uint32_t idx = first; idx <= last;) {
+    glm::i32vec2 const origin = traversal.Texel(idx);
+    glm::i32vec2 const tile = ::FloorTile(origin);
+
+    // empty box of the coarsest level the texel is resolved at
+    glm::i32vec2 boxMin;
+    int32_t boxSize;
+
+    auto const * chunk = layer.ChunkOf(tile);
+
+    // -- chunk level
+    if (!chunk || !(Idx(chunk->channels) & Idx(channels))) {
+      boxMin =
+        glm::i32vec2(
+          tile.x >> TilemapLayer::chunkShift, tile.y >> TilemapLayer::chunkShift
+        ) * chunkTexels;
+      boxSize = chunkTexels;
+    } else {
+      auto const & tileInfo =
+        chunk->tiles[
+          (tile.y & (TilemapLayer::chunkSize-1))*TilemapLayer::chunkSize
+        + (tile.x & (TilemapLayer::chunkSize-1))
+        ];
+
+      boxMin = tile * tileSize;
+      boxSize = tileSize;
+
+      // -- tile level
+      if (
+          tileInfo.Valid()
+       && layer.orientedTiles[tileInfo.orientedTileIdx].Blocks(channels)
+      ) {
+        auto const & physicsTile =
+          layer.orientedTiles[tileInfo.orientedTileIdx];
+
+        // full hints of tiles combining several channels may not be full to
+        // the query, so those are resolved per texel
+        bool const exact = physicsTile.Exact(channels);
+
+        if (physicsTile.accelerationHint == Hint::Full && exact)
+          { return false; }
+
+        if (physicsTile.accelerationHint != Hint::Empty) {
+          // -- block level
+          glm::u32vec2 const texel = glm::u32vec2(origin - boxMin);
+          glm::u32vec2 const block = texel / static_cast<uint32_t>(blockSize);
+
+          Hint const blockHint =
+            physicsTile.blockAccelerationHints[block.x][block.y];
+
+          if (blockHint == Hint::Full && exact) { return false; }
+
+          // -- texel level
+          if (blockHint != Hint::Empty) {
+            if (physicsTile.Solid(texel, channels, layer.mixedTexelChannels))
+              { return false; }
+            ++ idx;
+            continue;
+          }
+
+          boxMin += glm::i32vec2(block) * blockSize;
+          boxSize = blockSize;
+        }
+      }
+    }
+
+    idx =
+      traversal.LastIndexWithin(
+        idx, boxMin, boxMin + glm::i32vec2(boxSize - 1)
+      ) + 1u;
+  }
+
+  return true;
+}
+
+bool pul::physics::IntersectionAabb(
+  pul::physics::TilemapLayer const & layer
+, pul::physics::IntersectorAabb const & aabb
+, pul::physics::AabbIntersectionResults & results
+, pul::core::CollisionChannel const channels
+) {
+  using Hint = pul::physics::TileIntersectAccelerationHint;
+
+  results = {};
+  results.origin = aabb.origin + aabb.velocity;
+  results.slideVelocity = aabb.velocity;
+
+  if (aabb.velocity == glm::vec2(0.0f)) { return false; }
+
+  ::AabbSweep sweep;
+  sweep.boxMin = pul::physics::GetAabbMin(aabb.origin, aabb.dimensions);
+  sweep.boxMax = pul::physics::GetAabbMax(aabb.origin, aabb.dimensions);
+  sweep.velocity = aabb.velocity;
+
+  if (layer.Empty()) { return false; }
+
+  // -- texels covered or touched by the sweep, clamped to the tilemap
+  glm::i32vec2 const
+    texelMin =
+      glm::max(
+        glm::i32vec2(
+          glm::ceil(glm::min(sweep.boxMin, sweep.boxMin + sweep.velocity))
+        ) - glm::i32vec2(1)
+      , layer.TexelMin()
+      )
+  , texelMax =
+      glm::min(
+        glm::i32vec2(
+          glm::floor(glm::max(sweep.boxMax, sweep.boxMax + sweep.velocity))
+        )
+      , layer.TexelMax()
+      )
+  ;
+
+  if (texelMin.x > texelMax.x || texelMin.y > texelMax.y) { return false; }
+
+  int32_t constexpr blockSize =
+    static_cast<int32_t>(pul::physics::Tile::blockSize);
+
+  // -- test every tile, uniform tiles & blocks are tested as a single box
+  glm::i32vec2 const
+    tileMin = ::FloorTile(texelMin)
+  , tileMax = ::FloorTile(texelMax)
+  ;
+
+  for (int32_t tileY = tileMin.y; tileY <= tileMax.y; ++ tileY)
+  for (int32_t tileX = tileMin.x; tileX <= tileMax.x; ++ tileX) {
+    auto const & tileInfo = *layer.Tile(glm::i32vec2(tileX, tileY));
+    if (!tileInfo.Valid()) { continue; }
+
+    auto const & tile = layer.orientedTiles[tileInfo.orientedTileIdx];
+    glm::i32vec2 const tileOrigin = glm::i32vec2(tileX, tileY) * tileSize;
+
+    if (!tile.Blocks(channels)) { continue; }
+
+    // full hints of tiles combining several channels may not be full to the
+    // query, so those are tested per texel
+    bool const exact = tile.Exact(channels);
+
+    if (tile.accelerationHint == Hint::Empty) { continue; }
+    if (tile.accelerationHint == Hint::Full && exact) {
+      ::SweepAgainstSolidBox(
+        sweep, tileOrigin, glm::i32vec2(tileSize), texelMin, texelMax
+      );
+      continue;
+    }
+
+    // tile-local texel range
+    glm::i32vec2 const
+      localMin = glm::max(texelMin - tileOrigin, glm::i32vec2(0))
+    , localMax = glm::min(texelMax - tileOrigin, glm::i32vec2(tileSize - 1))
+    , blockMin = localMin / blockSize
+    , blockMax = localMax / blockSize
+    ;
+
+    for (int32_t blockY = blockMin.y; blockY <= blockMax.y; ++ blockY)
+    for (int32_t blockX = blockMin.x; blockX <= blockMax.x; ++ blockX) {
+      glm::i32vec2 const blockOrigin =
+        glm::i32vec2(blockX, blockY) * blockSize;
+
+      auto const hint = tile.blockAccelerationHints[blockX][blockY];
+      if (hint == Hint::Empty) { continue; }
+      if (hint == Hint::Full && exact) {
+        ::SweepAgainstSolidBox(
+          sweep
+        , tileOrigin + blockOrigin, glm::i32vec2(blockSize)
+        , texelMin, texelMax
+        );
+        continue;
+      }
+
+      // only the solid texels of the covered part of the block
+      glm::i32vec2 const
+        rangeMin = glm::max(localMin, blockOrigin)
+      , rangeMax = glm::min(localMax, blockOrigin + (blockSize - 1))
+      ;
+
+      uint32_t const rowMask =
+        (0xFFFFFFFFu >> (31 - rangeMax.x + rangeMin.x)) << rangeMin.x;
+
+      for (int32_t y = rangeMin.y; y <= rangeMax.y; ++ y)
+      for (uint32_t bits = tile.mask[y] & rowMask; bits; bits &= bits - 1u) {
+        int32_t const x = std::countr_zero(bits);
+        if (
+            !exact
+         && !(
+              layer.mixedTexelChannels[tile.mixedChannelsIdx][x][y]
+            & Idx(channels)
+            )
+        ) {
+          continue;
+        }
+
+        glm::i32vec2 const texel = tileOrigin + glm::i32vec2(x, y);
+        ::SweepAgainst(
+          sweep, glm::vec2(texel), glm::vec2(texel + glm::i32vec2(1))
+        );
+      }
+    }
+  }
+
+  if (sweep.axis == -1) { return false; }
+
+  // -- contact texel; the face of the solid box along the contact axis, at the
+  //    middle of where the AABB overlaps it on the other axis
+  int32_t const axis = sweep.axis, otherAxis = 1 - axis;
+  float const timeOfImpact = sweep.timeOfImpact;
+
+  glm::i32vec2 contactTexel;
+  contactTexel[axis] =
+    static_cast<int32_t>(
+      sweep.velocity[axis] > 0.0f
+    ? sweep.contactMin[axis]
+    : sweep.contactMax[axis] - 1.0f
+    );
+
+  {
+    float const offset = sweep.velocity[otherAxis] * timeOfImpact;
+    float const
+      overlapMin =
+        glm::max(sweep.boxMin[otherAxis] + offset, sweep.contactMin[otherAxis])
+    , overlapMax =
+        glm::min(sweep.boxMax[otherAxis] + offset, sweep.contactMax[otherAxis])
+    ;
+
+    contactTexel[otherAxis] =
+      static_cast<int32_t>(
+        glm::clamp(
+          glm::floor((overlapMin + overlapMax) * 0.5f)
+        , sweep.contactMin[otherAxis]
+        , sweep.contactMax[otherAxis] - 1.0f
+        )
+      );
+  }
+
+  glm::vec2 normal = glm::vec2(0.0f);
+  normal[axis] = sweep.velocity[axis] > 0.0f ? +1.0f : -1.0f;
+
+  results.collision = true;
+  results.timeOfImpact = timeOfImpact;
+  results.origin = aabb.origin + aabb.velocity * timeOfImpact;
+  results.normal = normal;
+  results.slideVelocity =
+      (1.0f - timeOfImpact)
+    * (aabb.velocity - normal * glm::dot(aabb.velocity, normal))
+  ;
+
+  if (auto const * tileInfo = ::SolidTexel(layer, contactTexel, channels)) {
+    results.surfaceNormal =
+      ::SurfaceNormal(layer, *tileInfo, contactTexel, channels);
+    results.imageTileIdx = tileInfo->imageTileIdx;
+    results.tilesetIdx = tileInfo->tilesetIdx;
+  }
+
+  return true;
+}
+
+size_t pul::physics::IntersectionPointBatch(
+  pul::physics::TilemapLayer const & layer
+, std::span<pul::physics::IntersectorPoint const> const points
+, std::span<pul::physics::IntersectionResults> const results
+, pul::core::CollisionChannel const channels
+) {
+  PUL_ASSERT_CMP(results.size(), >=, points.size(), return 0ul;);
+
+  // solidity is resolved by the vectorized kernel, only hits need the rest of
+  // their results
+  std::array<uint8_t, ::pointKernelBatch> solid;
+
+  size_t collisions = 0ul;
+  for (size_t begin = 0ul; begin < points.size(); begin += ::pointKernelBatch) {
+    size_t const count = std::min(::pointKernelBatch, points.size() - begin);
+
+    pul::physics::SolidTexels(
+      layer, points.subspan(begin, count), solid, channels
+    );
+
+    for (size_t i = 0ul; i < count; ++ i) {
+      if (!solid[i]) { results[begin + i] = {}; continue; }
+      collisions +=
+        ::Point(layer, points[begin + i], results[begin + i], channels);
+    }
+  }
+
+  return collisions;
+}
+
+size_t pul::physics::IntersectionRaycastBatch(
+  pul::physics::TilemapLayer const & layer
+, std::span<pul::physics::IntersectorRay const> const rays
+, std::span<pul::physics::IntersectionResults> const results
+, pul::core::CollisionChannel const channels
+) {
+  PUL_ASSERT_CMP(results.size(), >=, rays.size(), return 0ul;);
+
+  for (size_t i = 0ul; i < rays.size(); ++ i) { results[i] = {}; }
+
+  if (layer.Empty()) { return 0ul; }
+
+  // the layer bounds are shared by the batch, each ray only has to be clipped
+  // to them before its samples are stepped through directly
+  glm::i32vec2 const texelMin = layer.TexelMin(), texelMax = layer.TexelMax();
+
+  size_t collisions = 0ul;
+  for (size_t i = 0ul; i < rays.size(); ++ i) {
+    auto const traversal =
+      pul::physics::BresenhamTraversal::Construct(
+        rays[i].beginOrigin, rays[i].endOrigin
+      );
+
+    uint32_t first, last;
+    if (!traversal.ClipToBox(texelMin, texelMax, first, last)) { continue; }
+
+    for (uint32_t idx = first; idx <= last;) {
+      if (::RaycastStep(layer, traversal, idx, results[i], false, channels)) {
+        ++ collisions;
+        break;
+      }
+    }
+  }
+
+  return collisions;
+}
+
+void pul::physics::QueryCache::Invalidate() {
+  // on wrap-around stale slots could match the stamp again
+  if (++ this->stamp == 0u) {
+    for (auto & slot : this->points) { slot.stamp = 0u; }
+    this->stamp = 1u;
+  }
+}
+
+void pul::physics::QueryCache::BeginTick(size_t const tick_) {
+  if (this->tick == tick_) { return; }
+
+  this->tick = tick_;
+  this->previousTickCounters = this->tickCounters;
+  this->tickCounters = {};
+  this->Invalidate();
+}
+
+size_t pul::physics::QueryCache::SlotIdx(glm::i32vec2 const origin) {
+  uint32_t const hash =
+      static_cast<uint32_t>(origin.x) * 73856093u
+    ^ static_cast<uint32_t>(origin.y) * 19349663u
+  ;
+
+  return static_cast<size_t>(hash) & (slotCount-1ul);
+}
+
+bool pul::physics::IntersectionPoint(
+  pul::physics::TilemapLayer const & layer
+, pul::physics::QueryCache & cache
+, pul::physics::IntersectorPoint const & point
+, pul::physics::IntersectionResults & results
+, pul::core::CollisionChannel const channels
+) {
+  if (!cache.enabled) { return ::Point(layer, point, results, channels); }
+
+  auto & slot = cache.points[pul::physics::QueryCache::SlotIdx(point.origin)];
+
+  if (
+      slot.stamp == cache.stamp && slot.origin == point.origin
+   && slot.channels == channels
+  ) {
+    ++ cache.tickCounters.pointHits;
+    results = slot.results;
+    return results.collision;
+  }
+
+  ++ cache.tickCounters.pointMisses;
+  ::Point(layer, point, results, channels);
+
+  slot.origin = point.origin;
+  slot.stamp = cache.stamp;
+  slot.channels = channels;
+  slot.results = results;
+
+  return results.collision;
+}
+
+size_t pul::physics::IntersectionPointBatch(
+  pul::physics::TilemapLayer const & layer
+, pul::physics::QueryCache & cache
+, std::span<pul::physics::IntersectorPoint const> const points
+, std::span<pul::physics::IntersectionResults> const results
+, pul::core::CollisionChannel const channels
+) {
+  PUL_ASSERT_CMP(results.size(), >=, points.size(), return 0ul;);
+
+  if (!cache.enabled) {
+    return
+      pul::physics::IntersectionPointBatch(layer, points, results, channels);
+  }
+
+  // the kernel runs over the whole batch, it is cheaper than gathering up
+  // the cache misses; only hits are then cached or fully resolved
+  std::array<uint8_t, ::pointKernelBatch> solid;
+
+  size_t collisions = 0ul;
+  for (size_t begin = 0ul; begin < points.size(); begin += ::pointKernelBatch) {
+    size_t const count = std::min(::pointKernelBatch, points.size() - begin);
+
+    pul::physics::SolidTexels(
+      layer, points.subspan(begin, count), solid, channels
+    );
+
+    for (size_t i = begin; i < begin + count; ++ i) {
+      // points repeating within the batch simply overwrite the same slot
+      auto & slot =
+        cache.points[pul::physics::QueryCache::SlotIdx(points[i].origin)];
+
+      if (
+          slot.stamp == cache.stamp && slot.origin == points[i].origin
+       && slot.channels == channels
+      ) {
+        ++ cache.tickCounters.pointHits;
+        results[i] = slot.results;
+        collisions += results[i].collision;
+        continue;
+      }
+
+      ++ cache.tickCounters.pointMisses;
+
+      results[i] = {};
+      if (solid[i - begin])
+        { collisions += ::Point(layer, points[i], results[i], channels); }
+
+      slot.origin = points[i].origin;
+      slot.stamp = cache.stamp;
+      slot.channels = channels;
+      slot.results = results[i];
+    }
+  }
+
+  return collisions;
+}
+
+glm::vec2 pul::physics::GetAabbMin(
+  glm::vec2 const & aabbOrigin, glm::vec2 const & aabbDim
+) {
+  glm::vec2 const p0 = aabbOrigin - aabbDim/2.0f;
+  glm::vec2 const p1 = aabbOrigin + aabbDim/2.0f;
+  return glm::min(p0, p1);
+}
+
+glm::vec2 pul::physics::GetAabbMax(
+  glm::vec2 const & aabbOrigin, glm::vec2 const & aabbDim
+) {
+  glm::vec2 const p0 = aabbOrigin - aabbDim/2.0f;
+  glm::vec2 const p1 = aabbOrigin + aabbDim/2.0f;
+  return glm::max(p0, p1);
+}
+
+bool pul::physics::IntersectionRayAabb(
+  glm::vec2 const & rayBegin, glm::vec2 const & rayEnd
+, glm::vec2 const & aabbOrigin, glm::vec2 const & aabbDim
+, float & intersectionLength
+) {
+  return
+    pul::physics::IntersectionRayAabbDistance(
+      rayBegin, glm::normalize(rayEnd - rayBegin)
+    , glm::length(rayEnd - rayBegin)
+    , aabbOrigin, aabbDim
+    , intersectionLength
+    );
+}
+
+bool pul::physics::IntersectionRayAabbDistance(
+  glm::vec2 const & rayBegin, glm::vec2 const & rayNormal
+, float const rayLength
+, glm::vec2 const & aabbOrigin, glm::vec2 const & aabbDim
+, float & intersectionLength
+) {
+  glm::vec2 const
+    aabbMin = pul::physics::GetAabbMin(aabbOrigin, aabbDim)
+  , aabbMax = pul::physics::GetAabbMax(aabbOrigin, aabbDim)
+  ;
+
+  float tmin = -std::numeric_limits<float>::infinity();
+  float tmax = +std::numeric_limits<float>::infinity();
+
+  for (int axis = 0; axis < 2; ++ axis) {
+    // parallel to this slab, can only intersect if it starts inside of it
+    if (rayNormal[axis] == 0.0f) {
+      if (rayBegin[axis] < aabbMin[axis] || rayBegin[axis] > aabbMax[axis])
+        { return false; }
+      continue;
+    }
+
+    float const
+      t0 = (aabbMin[axis] - rayBegin[axis]) / rayNormal[axis]
+    , t1 = (aabbMax[axis] - rayBegin[axis]) / rayNormal[axis]
+    ;
+
+    tmin = glm::max(tmin, glm::min(t0, t1));
+    tmax = glm::min(tmax, glm::max(t0, t1));
+  }
+
+  if (tmax < 0.0f || tmin > tmax)
+    { return false; }
+
+  float t = tmin < 0.0f ? tmax : tmin;
+  intersectionLength = t;
+  return t > 0.0f && t < rayLength;
+}
+
+bool pul::physics::IntersectionCircleAabb(
+  glm::vec2 const & circleOrigin, float const circleRadius
+, glm::vec2 const & aabbOrigin, glm::vec2 const & aabbDim
+, glm::vec2 & closestOrigin
+) {
+  closestOrigin =
+    glm::clamp(
+      circleOrigin
+    , pul::physics::GetAabbMin(aabbOrigin, aabbDim)
+    , pul::physics::GetAabbMax(aabbOrigin, aabbDim)
+    );
+
+  return glm::length(circleOrigin - closestOrigin) <= circleRadius;
 }
@@ -0,0 +1,442 @@
+#include <pulcher-physics/kernels.hpp>
+
+#include <pulcher-physics/tileset.hpp>
+#include <pulcher-util/enum.hpp>
+#include <pulcher-util/log.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <limits>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+  #define PULCHER_PHYSICS_X86_KERNELS
+  #include <immintrin.h>
+#endif
+
+namespace {
+
+using TilemapLayer = pul::physics::TilemapLayer;
+
+int32_t constexpr tileShift = 5;
+int32_t constexpr texelBits = (1 << tileShift) - 1;
+static_assert((1ul << tileShift) == pul::physics::Tile::gridSize);
+
+// points are loaded as packed origins, and mask rows are gathered relative to
+// the start of the oriented tiles
+static_assert(
+  sizeof(pul::physics::IntersectorPoint) == sizeof(glm::i32vec2)
+);
+static_assert(offsetof(pul::physics::IntersectorPoint, origin) == 0ul);
+static_assert(offsetof(pul::physics::Tile, mask) == 0ul);
+static_assert(offsetof(TilemapLayer::TileInfo, orientedTileIdx) == 0ul);
+
+// channels & the mixed channels index are gathered as one word, channels in
+// the second byte & the index in the upper half
+size_t constexpr channelsWordOffset =
+  offsetof(pul::physics::Tile, mixedChannelsIdx) - sizeof(uint16_t);
+static_assert(
+    offsetof(pul::physics::Tile, channels) == channelsWordOffset + 1ul
+);
+static_assert(
+    channelsWordOffset + sizeof(int32_t) <= sizeof(pul::physics::Tile)
+);
+
+pul::physics::SimdLevel overrideLevel = pul::physics::SimdLevel::Size;
+
+pul::physics::SimdLevel DetectSimdLevel() {
+  #ifdef PULCHER_PHYSICS_X86_KERNELS
+    using SimdLevel = pul::physics::SimdLevel;
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) { return SimdLevel::Avx2; }
+    if (__builtin_cpu_supports("sse2")) { return SimdLevel::Sse2; }
+  #endif
+  return pul::physics::SimdLevel::Scalar;
+}
+
+// -- scalar
+
+bool SolidTexel(
+  TilemapLayer const & layer, glm::i32vec2 const origin
+, pul::core::CollisionChannel const channels
+) {
+  glm::i32vec2 const tile =
+    glm::i32vec2(origin.x >> tileShift, origin.y >> tileShift);
+
+  auto const * tileInfo = layer.Tile(tile);
+  if (!tileInfo || !tileInfo->Valid()) { return false; }
+
+  return
+    layer
+      .orientedTiles[tileInfo->orientedTileIdx]
+      .Solid(
+        glm::u32vec2(origin.x & texelBits, origin.y & texelBits), channels
+      , layer.mixedTexelChannels
+      );
+}
+
+void SolidTexelsScalar(
+  TilemapLayer const & layer
+, pul::physics::IntersectorPoint const * points
+, uint8_t * solid, size_t const count
+, pul::core::CollisionChannel const channels
+) {
+  for (size_t i = 0ul; i < count; ++ i)
+    { solid[i] = ::SolidTexel(layer, points[i].origin, channels); }
+}
+
+#ifdef PULCHER_PHYSICS_X86_KERNELS
+
+// -- SSE2, 4 lanes. Without gathers or variable shifts only the addressing is
+//    vectorized, the loads are done per lane
+
+[[gnu::target("sse2")]] void SolidTexelsSse2(
+  TilemapLayer const & layer
+, pul::physics::IntersectorPoint const * points
+, uint8_t * solid, size_t const count
+, pul::core::CollisionChannel const channels
+) {
+  int32_t constexpr chunkMask = TilemapLayer::chunkSize - 1;
+
+  __m128i const
+    tileMinBound = _mm_set_epi32(0, 0, layer.tileMin.y-1, layer.tileMin.x-1)
+  , tileMaxBound = _mm_set_epi32(0, 0, layer.tileMax.y+1, layer.tileMax.x+1)
+  , texelMask = _mm_set1_epi32(texelBits)
+  , chunkTileMask = _mm_set1_epi32(chunkMask)
+  , chunkMin = _mm_set_epi32(0, 0, layer.chunkMin.y, layer.chunkMin.x)
+  ;
+
+  size_t i = 0ul;
+  for (; i + 2ul <= count; i += 2ul) {
+    // two points per register, as (x, y, x, y)
+    __m128i const origin =
+      _mm_loadu_si128(reinterpret_cast<__m128i const *>(points + i));
+
+    __m128i const tile = _mm_srai_epi32(origin, tileShift);
+    __m128i const texel = _mm_and_si128(origin, texelMask);
+    __m128i const chunk =
+      _mm_sub_epi32(
+        _mm_srai_epi32(tile, TilemapLayer::chunkShift)
+      , _mm_shuffle_epi32(chunkMin, _MM_SHUFFLE(1, 0, 1, 0))
+      );
+    __m128i const tileInChunk = _mm_and_si128(tile, chunkTileMask);
+
+    __m128i const inBounds =
+      _mm_and_si128(
+        _mm_cmpgt_epi32(
+          tile, _mm_shuffle_epi32(tileMinBound, _MM_SHUFFLE(1, 0, 1, 0))
+        )
+      , _mm_cmplt_epi32(
+          tile, _mm_shuffle_epi32(tileMaxBound, _MM_SHUFFLE(1, 0, 1, 0))
+        )
+      );
+
+    alignas(16) int32_t texels[4], chunks[4], tilesInChunk[4], bounds[4];
+    _mm_store_si128(reinterpret_cast<__m128i *>(texels), texel);
+    _mm_store_si128(reinterpret_cast<__m128i *>(chunks), chunk);
+    _mm_store_si128(reinterpret_cast<__m128i *>(tilesInChunk), tileInChunk);
+    _mm_store_si128(reinterpret_cast<__m128i *>(bounds), inBounds);
+
+    for (size_t lane = 0ul; lane < 2ul; ++ lane) {
+      size_t const x = lane*2ul, y = lane*2ul + 1ul;
+
+      solid[i + lane] = 0u;
+      if (!bounds[x] || !bounds[y]) { continue; }
+
+      uint32_t const chunkIdx =
+        layer.chunkTable[chunks[y]*layer.chunkDimensions.x + chunks[x]];
+      if (chunkIdx == -1u) { continue; }
+
+      uint32_t const orientedTileIdx =
+        layer.chunks[chunkIdx]
+          .tiles[tilesInChunk[y]*TilemapLayer::chunkSize + tilesInChunk[x]]
+          .orientedTileIdx;
+      if (orientedTileIdx == -1u) { continue; }
+
+      solid[i + lane] =
+        layer.orientedTiles[orientedTileIdx].Solid(
+          glm::u32vec2(texels[x], texels[y]), channels
+        , layer.mixedTexelChannels
+        );
+    }
+  }
+
+  ::SolidTexelsScalar(layer, points + i, solid + i, count - i, channels);
+}
+
+// -- AVX2, 8 lanes. Each level of the lookup is a masked gather, lanes that
+//    fall out of the map at any level stop gathering
+
+[[gnu::target("avx2")]] void SolidTexelsAvx2(
+  TilemapLayer const & layer
+, pul::physics::IntersectorPoint const * points
+, uint8_t * solid, size_t const count
+, pul::core::CollisionChannel const channels
+) {
+  int32_t constexpr chunkMask = TilemapLayer::chunkSize - 1;
+
+  __m256i const
+    tileMinX = _mm256_set1_epi32(layer.tileMin.x - 1)
+  , tileMinY = _mm256_set1_epi32(layer.tileMin.y - 1)
+  , tileMaxX = _mm256_set1_epi32(layer.tileMax.x + 1)
+  , tileMaxY = _mm256_set1_epi32(layer.tileMax.y + 1)
+  , chunkMinX = _mm256_set1_epi32(layer.chunkMin.x)
+  , chunkMinY = _mm256_set1_epi32(layer.chunkMin.y)
+  , chunkDimensionX = _mm256_set1_epi32(layer.chunkDimensions.x)
+  , chunkStride =
+      _mm256_set1_epi32(static_cast<int32_t>(sizeof(TilemapLayer::Chunk)))
+  , tileStride =
+      _mm256_set1_epi32(static_cast<int32_t>(sizeof(pul::physics::Tile)))
+  , texelMask = _mm256_set1_epi32(texelBits)
+  , chunkTileMask = _mm256_set1_epi32(chunkMask)
+  , invalid = _mm256_set1_epi32(-1)
+  , one = _mm256_set1_epi32(1)
+  , deinterleave = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7)
+  , channelFilter = _mm256_set1_epi32(Idx(channels) << 8)
+  , uniformChannels =
+      _mm256_set1_epi32(
+        static_cast<int32_t>(
+          uint32_t{pul::physics::Tile::uniformChannels} << 16
+        )
+      )
+  , channelsOffset =
+      _mm256_set1_epi32(static_cast<int32_t>(::channelsWordOffset))
+  ;
+
+  auto const * chunkTable =
+    reinterpret_cast<int32_t const *>(layer.chunkTable.data());
+  auto const * chunks = reinterpret_cast<int32_t const *>(layer.chunks.data());
+  auto const * tiles =
+    reinterpret_cast<int32_t const *>(layer.orientedTiles.data());
+
+  size_t i = 0ul;
+  for (; i + 8ul <= count; i += 8ul) {
+    // (x0 y0 x1 y1 ..) into (x0 .. x3 y0 .. y3) for both halves
+    __m256i const low =
+      _mm256_permutevar8x32_epi32(
+        _mm256_loadu_si256(reinterpret_cast<__m256i const *>(points + i))
+      , deinterleave
+      );
+    __m256i const high =
+      _mm256_permutevar8x32_epi32(
+        _mm256_loadu_si256(reinterpret_cast<__m256i const *>(points + i + 4))
+      , deinterleave
+      );
+
+    __m256i const
+      originX = _mm256_permute2x128_si256(low, high, 0x20)
+    , originY = _mm256_permute2x128_si256(low, high, 0x31)
+    ;
+
+    __m256i const
+      tileX = _mm256_srai_epi32(originX, tileShift)
+    , tileY = _mm256_srai_epi32(originY, tileShift)
+    ;
+
+    // -- map level
+    __m256i valid =
+      _mm256_and_si256(
+        _mm256_and_si256(
+          _mm256_cmpgt_epi32(tileX, tileMinX)
+        , _mm256_cmpgt_epi32(tileMaxX, tileX)
+        )
+      , _mm256_and_si256(
+          _mm256_cmpgt_epi32(tileY, tileMinY)
+        , _mm256_cmpgt_epi32(tileMaxY, tileY)
+        )
+      );
+
+    // -- chunk level
+    __m256i const chunkTableIdx =
+      _mm256_add_epi32(
+        _mm256_mullo_epi32(
+          _mm256_sub_epi32(
+            _mm256_srai_epi32(tileY, TilemapLayer::chunkShift), chunkMinY
+          )
+        , chunkDimensionX
+        )
+      , _mm256_sub_epi32(
+          _mm256_srai_epi32(tileX, TilemapLayer::chunkShift), chunkMinX
+        )
+      );
+
+    __m256i const chunkIdx =
+      _mm256_mask_i32gather_epi32(
+        invalid, chunkTable, chunkTableIdx, valid, 4
+      );
+    valid = _mm256_andnot_si256(_mm256_cmpeq_epi32(chunkIdx, invalid), valid);
+
+    // -- tile level
+    __m256i const tileInChunk =
+      _mm256_add_epi32(
+        _mm256_slli_epi32(
+          _mm256_and_si256(tileY, chunkTileMask), TilemapLayer::chunkShift
+        )
+      , _mm256_and_si256(tileX, chunkTileMask)
+      );
+
+    __m256i const tileInfoOffset =
+      _mm256_add_epi32(
+        _mm256_mullo_epi32(chunkIdx, chunkStride)
+      , _mm256_slli_epi32(tileInChunk, 3) // sizeof(TileInfo)
+      );
+
+    __m256i const orientedTileIdx =
+      _mm256_mask_i32gather_epi32(invalid, chunks, tileInfoOffset, valid, 1);
+    valid =
+      _mm256_andnot_si256(_mm256_cmpeq_epi32(orientedTileIdx, invalid), valid);
+
+    // -- channels, tiles that block none of them are empty; lanes of tiles
+    //    with mixed channels are left to the scalar lookup
+    __m256i const tileOffset = _mm256_mullo_epi32(orientedTileIdx, tileStride);
+
+    __m256i const tileChannels =
+      _mm256_mask_i32gather_epi32(
+        _mm256_setzero_si256()
+      , tiles
+      , _mm256_add_epi32(tileOffset, channelsOffset)
+      , valid
+      , 1
+      );
+
+    __m256i const mixed =
+      _mm256_andnot_si256(
+        _mm256_cmpeq_epi32(
+          _mm256_and_si256(tileChannels, uniformChannels), uniformChannels
+        )
+      , valid
+      );
+
+    valid =
+      _mm256_andnot_si256(
+        _mm256_cmpeq_epi32(
+          _mm256_and_si256(tileChannels, channelFilter)
+        , _mm256_setzero_si256()
+        )
+      , valid
+      );
+
+    // -- texel level
+    __m256i const rowOffset =
+      _mm256_add_epi32(
+        tileOffset
+      , _mm256_slli_epi32(_mm256_and_si256(originY, texelMask), 2)
+      );
+
+    __m256i const row =
+      _mm256_mask_i32gather_epi32(
+        _mm256_setzero_si256(), tiles, rowOffset, valid, 1
+      );
+
+    __m256i const bit =
+      _mm256_and_si256(
+        _mm256_srlv_epi32(row, _mm256_and_si256(originX, texelMask)), one
+      );
+
+    uint32_t const lanes =
+      static_cast<uint32_t>(
+        _mm256_movemask_ps(
+          _mm256_castsi256_ps(
+            _mm256_and_si256(_mm256_cmpeq_epi32(bit, one), valid)
+          )
+        )
+      );
+
+    for (size_t lane = 0ul; lane < 8ul; ++ lane)
+      { solid[i + lane] = (lanes >> lane) & 1u; }
+
+    for (
+      uint32_t mixedLanes =
+        static_cast<uint32_t>(
+          _mm256_movemask_ps(_mm256_castsi256_ps(mixed))
+        );
+      mixedLanes;
+      mixedLanes &= mixedLanes - 1u
+    ) {
+      size_t const lane = static_cast<size_t>(std::countr_zero(mixedLanes));
+      solid[i + lane] = ::SolidTexel(layer, points[i + lane].origin, channels);
+    }
+  }
+
+  // the rest of the build is SSE, which stalls on dirty upper AVX state
+  _mm256_zeroupper();
+
+  ::SolidTexelsScalar(layer, points + i, solid + i, count - i, channels);
+}
+
+// gathers address with signed 32 bit byte offsets
+bool FitsGatherOffsets(TilemapLayer const & layer) {
+  size_t constexpr maxOffset =
+    static_cast<size_t>(std::numeric_limits<int32_t>::max());
+
+  return
+      layer.chunks.size() * sizeof(TilemapLayer::Chunk) <= maxOffset
+   && layer.orientedTiles.size() * sizeof(pul::physics::Tile) <= maxOffset
+  ;
+}
+
+#endif // PULCHER_PHYSICS_X86_KERNELS
+
+} // -- namespace
+
+pul::physics::SimdLevel pul::physics::DetectedSimdLevel() {
+  static pul::physics::SimdLevel const level = ::DetectSimdLevel();
+  return level;
+}
+
+pul::physics::SimdLevel pul::physics::ActiveSimdLevel() {
+  if (::overrideLevel != pul::physics::SimdLevel::Size)
+    { return ::overrideLevel; }
+  return pul::physics::DetectedSimdLevel();
+}
+
+void pul::physics::OverrideSimdLevel(pul::physics::SimdLevel const level) {
+  ::overrideLevel =
+    static_cast<pul::physics::SimdLevel>(
+      std::min(Idx(level), Idx(pul::physics::DetectedSimdLevel()))
+    );
+}
+
+void pul::physics::SolidTexels(
+  pul::physics::TilemapLayer const & layer
+, std::span<pul::physics::IntersectorPoint const> const points
+, std::span<uint8_t> const solid
+, pul::core::CollisionChannel const channels
+) {
+  PUL_ASSERT_CMP(solid.size(), >=, points.size(), return;);
+
+  if (!(Idx(layer.channels) & Idx(channels))) {
+    std::fill(solid.begin(), solid.begin() + points.size(), uint8_t{0u});
+    return;
+  }
+
+  #ifdef PULCHER_PHYSICS_X86_KERNELS
+    switch (pul::physics::ActiveSimdLevel()) {
+      default: break;
+      case pul::physics::SimdLevel::Avx2:
+        if (!::FitsGatherOffsets(layer)) { break; }
+        ::SolidTexelsAvx2(
+          layer, points.data(), solid.data(), points.size(), channels
+        );
+        return;
+      case pul::physics::SimdLevel::Sse2:
+        ::SolidTexelsSse2(
+          layer, points.data(), solid.data(), points.size(), channels
+        );
+        return;
+    }
+  #endif
+
+  ::SolidTexelsScalar(
+    layer, points.data(), solid.data(), points.size(), channels
+  );
+}
+
+char const * ToStr(pul::physics::SimdLevel const level) {
+  switch (level) {
+    default: return "N/A";
+    case pul::physics::SimdLevel::Scalar: return "scalar";
+    case pul::physics::SimdLevel::Sse2:   return "sse2";
+    case pul::physics::SimdLevel::Avx2:   return "avx2";
+  }
+}
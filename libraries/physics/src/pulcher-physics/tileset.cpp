@@ -1 +1,301 @@
 #include <pulcher-physics/tileset.hpp>
+
+#include <pulcher-core/map.hpp>
+#include <pulcher-util/enum.hpp>
+#include <pulcher-util/log.hpp>
+
+#include <cmath>
+#include <limits>
+
+namespace {
+
+auto constexpr gridSize = pul::physics::Tile::gridSize;
+float constexpr unbounded = 1e20f;
+
+// one dimensional squared euclidean distance transform of a sampled function,
+// from "Distance Transforms of Sampled Functions" (Felzenszwalb &
+// Huttenlocher); features are 0 and everything else is unbounded
+void DistanceTransform(
+  std::array<float, gridSize> const & samples
+, std::array<float, gridSize> & distances
+) {
+  std::array<int32_t, gridSize> parabolaOrigins;
+  std::array<float, gridSize+1> boundaries;
+
+  auto const intersection = [&](int32_t q, int32_t v) {
+    float const fq = static_cast<float>(q), fv = static_cast<float>(v);
+    return
+        ((samples[q] + fq*fq) - (samples[v] + fv*fv)) / (2.0f*fq - 2.0f*fv);
+  };
+
+  int32_t k = 0;
+  parabolaOrigins[0] = 0;
+  boundaries[0] = -unbounded;
+  boundaries[1] = +unbounded;
+
+  for (int32_t q = 1; q < static_cast<int32_t>(gridSize); ++ q) {
+    float s = intersection(q, parabolaOrigins[k]);
+    while (s <= boundaries[k]) {
+      -- k;
+      s = intersection(q, parabolaOrigins[k]);
+    }
+
+    ++ k;
+    parabolaOrigins[k] = q;
+    boundaries[k] = s;
+    boundaries[k+1] = +unbounded;
+  }
+
+  k = 0;
+  for (int32_t q = 0; q < static_cast<int32_t>(gridSize); ++ q) {
+    while (boundaries[k+1] < static_cast<float>(q)) { ++ k; }
+    float const offset = static_cast<float>(q - parabolaOrigins[k]);
+    distances[q] = offset*offset + samples[parabolaOrigins[k]];
+  }
+}
+
+// distance of every texel to the nearest texel matching the feature
+std::array<std::array<float, gridSize>, gridSize> DistanceField(
+  pul::physics::Tile::SolidMask const & solids, bool const feature
+) {
+  std::array<std::array<float, gridSize>, gridSize> field;
+  std::array<float, gridSize> samples, distances;
+
+  // -- columns
+  for (size_t x = 0ul; x < gridSize; ++ x) {
+    for (size_t y = 0ul; y < gridSize; ++ y)
+      { samples[y] = solids[x][y] == feature ? 0.0f : unbounded; }
+
+    ::DistanceTransform(samples, distances);
+    field[x] = distances;
+  }
+
+  // -- rows
+  for (size_t y = 0ul; y < gridSize; ++ y) {
+    for (size_t x = 0ul; x < gridSize; ++ x) { samples[x] = field[x][y]; }
+
+    ::DistanceTransform(samples, distances);
+
+    for (size_t x = 0ul; x < gridSize; ++ x) {
+      field[x][y] =
+          distances[x] >= unbounded*0.5f
+        ? std::numeric_limits<float>::max()
+        : std::sqrt(distances[x])
+      ;
+    }
+  }
+
+  return field;
+}
+
+pul::physics::TileIntersectAccelerationHint ComputeHint(
+  pul::physics::Tile::SolidMask const & solids
+, size_t const beginX, size_t const beginY, size_t const size
+) {
+  size_t solidCount = 0ul;
+  for (size_t x = beginX; x < beginX + size; ++ x)
+  for (size_t y = beginY; y < beginY + size; ++ y)
+    { solidCount += solids[x][y]; }
+
+  if (solidCount == 0ul)
+    { return pul::physics::TileIntersectAccelerationHint::Empty; }
+  if (solidCount == size*size)
+    { return pul::physics::TileIntersectAccelerationHint::Full; }
+  return pul::physics::TileIntersectAccelerationHint::Default;
+}
+
+} // -- namespace
+
+pul::physics::Tile pul::physics::Tile::Construct(
+  pul::physics::Tile::SolidMask const & solids
+) {
+  pul::physics::Tile tile = {};
+
+  for (size_t x = 0ul; x < gridSize; ++ x)
+  for (size_t y = 0ul; y < gridSize; ++ y) {
+    tile.mask[y] |= static_cast<uint32_t>(solids[x][y]) << x;
+  }
+
+  // -- acceleration hints
+  tile.accelerationHint = ::ComputeHint(solids, 0ul, 0ul, gridSize);
+
+  auto constexpr blockSize = pul::physics::Tile::blockSize;
+  for (size_t x = 0ul; x < pul::physics::Tile::blockGridSize; ++ x)
+  for (size_t y = 0ul; y < pul::physics::Tile::blockGridSize; ++ y) {
+    tile.blockAccelerationHints[x][y] =
+      ::ComputeHint(solids, x*blockSize, y*blockSize, blockSize);
+  }
+
+  return tile;
+}
+
+pul::physics::Tile::DistanceField
+pul::physics::Tile::ComputeDistanceField() const {
+  pul::physics::Tile::SolidMask solids;
+  for (uint32_t x = 0u; x < gridSize; ++ x)
+  for (uint32_t y = 0u; y < gridSize; ++ y)
+    { solids[x][y] = this->Solid(glm::u32vec2(x, y)); }
+
+  auto const distanceToSolid = ::DistanceField(solids, true);
+  auto const distanceToEmpty = ::DistanceField(solids, false);
+
+  pul::physics::Tile::DistanceField field;
+  for (size_t x = 0ul; x < gridSize; ++ x)
+  for (size_t y = 0ul; y < gridSize; ++ y) {
+    float const distance =
+      std::min(
+        std::floor(solids[x][y] ? distanceToEmpty[x][y] : distanceToSolid[x][y])
+      , 127.0f
+      );
+
+    field[x][y] = static_cast<int8_t>(solids[x][y] ? -distance : distance);
+  }
+
+  return field;
+}
+
+pul::physics::Tile pul::physics::Tile::Oriented(
+  pul::core::TileOrientation const orientation
+) const {
+  pul::physics::Tile tile = {};
+
+  for (uint32_t x = 0u; x < gridSize; ++ x)
+  for (uint32_t y = 0u; y < gridSize; ++ y) {
+    glm::u32vec2 const source =
+      pul::physics::OrientTexel(orientation, glm::u32vec2(x, y), gridSize);
+
+    tile.mask[y] |= static_cast<uint32_t>(this->Solid(source)) << x;
+  }
+
+  tile.accelerationHint = this->accelerationHint;
+  tile.channels = this->channels;
+
+  for (uint32_t x = 0u; x < blockGridSize; ++ x)
+  for (uint32_t y = 0u; y < blockGridSize; ++ y) {
+    glm::u32vec2 const source =
+      pul::physics::OrientTexel(
+        orientation, glm::u32vec2(x, y), blockGridSize
+      );
+
+    tile.blockAccelerationHints[x][y] =
+      this->blockAccelerationHints[source.x][source.y];
+  }
+
+  return tile;
+}
+
+pul::physics::Tile pul::physics::Tile::WithChannels(
+  pul::core::CollisionChannel const channels_
+) const {
+  pul::physics::Tile tile = *this;
+  tile.channels = channels_;
+  tile.mixedChannelsIdx = uniformChannels;
+  return tile;
+}
+
+pul::physics::Tile::TexelChannels
+pul::physics::Tile::ComputeTexelChannels(
+  std::span<pul::physics::Tile::TexelChannels const> const mixedTexelChannels
+) const {
+  if (this->Mixed()) { return mixedTexelChannels[this->mixedChannelsIdx]; }
+
+  pul::physics::Tile::TexelChannels texelChannels;
+  for (uint32_t x = 0u; x < gridSize; ++ x)
+  for (uint32_t y = 0u; y < gridSize; ++ y) {
+    texelChannels[x][y] =
+      this->Solid(glm::u32vec2(x, y)) ? Idx(this->channels) : 0u;
+  }
+
+  return texelChannels;
+}
+
+pul::physics::Tile pul::physics::Tile::Combined(
+  pul::physics::Tile const & other
+, std::vector<pul::physics::Tile::TexelChannels> & mixedTexelChannels
+) const {
+  pul::physics::Tile::SolidMask solids;
+  for (uint32_t x = 0u; x < gridSize; ++ x)
+  for (uint32_t y = 0u; y < gridSize; ++ y) {
+    glm::u32vec2 const texel = glm::u32vec2(x, y);
+    solids[x][y] = this->Solid(texel) || other.Solid(texel);
+  }
+
+  // hints all follow from the union
+  pul::physics::Tile tile = pul::physics::Tile::Construct(solids);
+
+  tile.channels =
+    static_cast<pul::core::CollisionChannel>(
+      Idx(this->channels) | Idx(other.channels)
+    );
+
+  auto texelChannels = this->ComputeTexelChannels(mixedTexelChannels);
+  auto const otherTexelChannels =
+    other.ComputeTexelChannels(mixedTexelChannels);
+
+  bool mixed = false;
+  for (uint32_t x = 0u; x < gridSize; ++ x)
+  for (uint32_t y = 0u; y < gridSize; ++ y) {
+    texelChannels[x][y] |= otherTexelChannels[x][y];
+    mixed |= solids[x][y] && texelChannels[x][y] != Idx(tile.channels);
+  }
+
+  if (!mixed) { return tile; }
+
+  // the index can't reach the sentinel
+  PUL_ASSERT_CMP(
+    mixedTexelChannels.size(), <, size_t{uniformChannels}, return tile;
+  );
+
+  tile.mixedChannelsIdx = static_cast<uint16_t>(mixedTexelChannels.size());
+  mixedTexelChannels.emplace_back(texelChannels);
+
+  return tile;
+}
+
+glm::u32vec2 pul::physics::OrientTexel(
+  pul::core::TileOrientation const orientation
+, glm::u32vec2 texel
+, uint32_t const gridSize
+) {
+  auto const tileOrientation = Idx(orientation);
+
+  if (tileOrientation & Idx(pul::core::TileOrientation::FlipHorizontal))
+    { texel.x = gridSize - 1u - texel.x; }
+
+  if (tileOrientation & Idx(pul::core::TileOrientation::FlipVertical))
+    { texel.y = gridSize - 1u - texel.y; }
+
+  if (tileOrientation & Idx(pul::core::TileOrientation::FlipDiagonal)) {
+    std::swap(texel.x, texel.y);
+  }
+
+  return texel;
+}
+
+pul::physics::Tileset pul::physics::Tileset::Construct(
+  std::span<glm::u8vec4 const> texels, size_t width, size_t height
+) {
+  pul::physics::Tileset tileset;
+  tileset.tiles.reserve((width / gridSize) * (height / gridSize));
+
+  // iterate thru every tile
+  for (size_t tileY = 0ul; tileY < height / gridSize; ++ tileY)
+  for (size_t tileX = 0ul; tileX < width  / gridSize; ++ tileX) {
+    pul::physics::Tile::SolidMask solids;
+
+    for (size_t texelY = 0ul; texelY < gridSize; ++ texelY)
+    for (size_t texelX = 0ul; texelX < gridSize; ++ texelX) {
+      size_t const
+        imageTexelX = tileX*gridSize + texelX
+      , imageTexelY = tileY*gridSize + texelY
+      ;
+
+      solids[texelX][texelY] =
+        texels[(height-imageTexelY-1)*width + imageTexelX].a > 0u;
+    }
+
+    tileset.tiles.emplace_back(pul::physics::Tile::Construct(solids));
+  }
+
+  return tileset;
+}
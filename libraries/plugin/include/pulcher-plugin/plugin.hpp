@@ -2,18 +2,23 @@
 
 #include <pulcher-plugin/enum.hpp>
 
+#include <entt/entity/fwd.hpp>
 #include <glm/fwd.hpp>
 
+#include <cstdint>
 #include <span>
 #include <string>
 #include <vector>
 
 namespace pul::animation { struct Instance; }
 namespace pul::animation { struct System; }
+namespace pul::core { enum class CollisionChannel : uint8_t; }
 namespace pul::core { enum class TileOrientation : size_t; }
 namespace pul::core { struct SceneBundle; }
 namespace pul::gfx { struct Image; }
+namespace pul::physics { struct AabbIntersectionResults; }
 namespace pul::physics { struct EntityIntersectionResults; }
+namespace pul::physics { struct EntityRaycastHits; }
 namespace pul::physics { struct IntersectionResults; }
 namespace pul::physics { struct IntersectorAabb; }
 namespace pul::physics { struct IntersectorCircle; }
@@ -101,11 +106,25 @@ namespace pul::plugin {
   };
 
   struct Physics {
+    // rebuilds the entity broadphase from every hitbox, once per logic tick
+    void (*EntityBroadphaseRebuild)(pul::core::SceneBundle & scene) = nullptr;
+    // re-bins a single hitbox entity after it moved during the logic tick
+    void (*EntityBroadphaseUpdate)(
+      pul::core::SceneBundle & scene
+    , entt::entity entity
+    ) = nullptr;
     void (*EntityIntersectionRaycast)(
       pul::core::SceneBundle & scene
     , pul::physics::IntersectorRay const & ray
     , pul::physics::EntityIntersectionResults & intersectionResults
     ) = nullptr;
+    // closest hits.maxHits entities along the ray, sorted by distance
+    void (*EntityIntersectionRaycastNearest)(
+      pul::core::SceneBundle & scene
+    , pul::physics::IntersectorRay const & ray
+    , entt::entity ignoredEntity
+    , pul::physics::EntityRaycastHits & hits
+    ) = nullptr;
     void (*EntityIntersectionCircle)(
       pul::core::SceneBundle & scene
     , pul::physics::IntersectorCircle const & circle
@@ -119,34 +138,69 @@ namespace pul::plugin {
     void (*LoadMapGeometry)(
       std::vector<pul::physics::Tileset const *> const & tilesets
     , std::vector<std::span<size_t>>                 const & mapTileIndices
-    , std::vector<std::span<glm::u32vec2>>           const & mapTileOrigins
+    , std::vector<std::span<glm::i32vec2>>           const & mapTileOrigins
     , std::vector<
         std::span<pul::core::TileOrientation>
       > const & mapTileOrientations
+    , std::vector<pul::core::CollisionChannel>       const & mapTileChannels
     ) = nullptr;
+    // changes every time the map geometry is cleared or loaded, so that
+    // bodies sleeping on it can tell it has to be queried again
+    size_t (*GeometryVersion)() = nullptr;
+
+    // tilemap queries only collide with texels blocking any of the channels
     bool (*IntersectionRaycast)(
       pul::core::SceneBundle & scene
     , pul::physics::IntersectorRay const & ray
     , pul::physics::IntersectionResults & intersectionResults
+    , pul::core::CollisionChannel channels
     ) = nullptr;
     bool (*InverseSceneIntersectionRaycast)(
       pul::core::SceneBundle & scene
     , pul::physics::IntersectorRay const & ray
     , pul::physics::IntersectionResults & intersectionResults
+    , pul::core::CollisionChannel channels
     ) = nullptr;
     pul::physics::TilemapLayer * (*TilemapLayer)() = nullptr;
 
+    // only whether anything solid lies between the origins, much cheaper than
+    // a raycast when the intersection itself isn't needed
+    bool (*LineOfSight)(
+      pul::core::SceneBundle & scene
+    , glm::i32vec2 const & beginOrigin
+    , glm::i32vec2 const & endOrigin
+    , pul::core::CollisionChannel channels
+    ) = nullptr;
+
     bool (*IntersectionAabb)(
       pul::core::SceneBundle & scene
-    , pul::physics::IntersectorAabb const & ray
-    , pul::physics::IntersectionResults & intersectionResults
+    , pul::physics::IntersectorAabb const & aabb
+    , pul::physics::AabbIntersectionResults & intersectionResults
+    , pul::core::CollisionChannel channels
     ) = nullptr;
 
     bool (*IntersectionPoint)(
       pul::core::SceneBundle & scene
     , pul::physics::IntersectorPoint const & ray
     , pul::physics::IntersectionResults & intersectionResults
+    , pul::core::CollisionChannel channels
+    ) = nullptr;
+
+    // batches of the above, results must be at least as long as the
+    // intersectors; returns the amount of collisions
+    size_t (*IntersectionPointBatch)(
+      pul::core::SceneBundle & scene
+    , std::span<pul::physics::IntersectorPoint const> points
+    , std::span<pul::physics::IntersectionResults> intersectionResults
+    , pul::core::CollisionChannel channels
+    ) = nullptr;
+    size_t (*IntersectionRaycastBatch)(
+      pul::core::SceneBundle & scene
+    , std::span<pul::physics::IntersectorRay const> rays
+    , std::span<pul::physics::IntersectionResults> intersectionResults
+    , pul::core::CollisionChannel channels
     ) = nullptr;
+
     void (*RenderDebug)(pul::core::SceneBundle &) = nullptr;
     void (*UiRender)(pul::core::SceneBundle &) = nullptr;
   };
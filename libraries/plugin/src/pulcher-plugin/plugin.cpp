@@ -150,10 +150,20 @@ void LoadPluginFunctions(pul::plugin::Info & plugin, Plugin & ctx) {
   }
   {
     auto & unit = plugin.physics;
+    ctx.LoadFunction(
+      unit.EntityBroadphaseRebuild, "Physics_EntityBroadphaseRebuild"
+    );
+    ctx.LoadFunction(
+      unit.EntityBroadphaseUpdate, "Physics_EntityBroadphaseUpdate"
+    );
     ctx.LoadFunction(
       unit.EntityIntersectionRaycast,
       "Physics_EntityIntersectionRaycast"
     );
+    ctx.LoadFunction(
+      unit.EntityIntersectionRaycastNearest
+    , "Physics_EntityIntersectionRaycastNearest"
+    );
     ctx.LoadFunction(
       unit.EntityIntersectionCircle,
       "Physics_EntityIntersectionCircle"
@@ -161,13 +171,22 @@ void LoadPluginFunctions(pul::plugin::Info & plugin, Plugin & ctx) {
     ctx.LoadFunction(unit.ProcessTileset,      "Physics_ProcessTileset");
     ctx.LoadFunction(unit.ClearMapGeometry,    "Physics_ClearMapGeometry");
     ctx.LoadFunction(unit.LoadMapGeometry,     "Physics_LoadMapGeometry");
+    ctx.LoadFunction(unit.GeometryVersion,     "Physics_GeometryVersion");
     ctx.LoadFunction(unit.IntersectionRaycast, "Physics_IntersectionRaycast");
     ctx.LoadFunction(
       unit.InverseSceneIntersectionRaycast
     , "Physics_InverseSceneIntersectionRaycast"
     );
     ctx.LoadFunction(unit.TilemapLayer,        "Physics_TilemapLayer");
+    ctx.LoadFunction(unit.LineOfSight,         "Physics_LineOfSight");
+    ctx.LoadFunction(unit.IntersectionAabb,    "Physics_IntersectionAabb");
     ctx.LoadFunction(unit.IntersectionPoint,   "Physics_IntersectionPoint");
+    ctx.LoadFunction(
+      unit.IntersectionPointBatch, "Physics_IntersectionPointBatch"
+    );
+    ctx.LoadFunction(
+      unit.IntersectionRaycastBatch, "Physics_IntersectionRaycastBatch"
+    );
     ctx.LoadFunction(unit.RenderDebug,         "Physics_RenderDebug");
     ctx.LoadFunction(unit.UiRender,            "Physics_UiRender");
   }
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+
+// -- a fixed set of worker threads that run a range of work split into chunks.
+//    The calling thread works along; whichever thread is idle takes the next
+//    chunk that wasn't taken yet, so uneven chunks balance out. Only which
+//    thread runs a chunk varies between runs, never how the range is split
+
+namespace pul::util {
+  struct JobPool {
+    JobPool(); // no workers, everything runs on the calling thread
+    ~JobPool();
+    JobPool(JobPool const &) = delete;
+    JobPool(JobPool &&);
+    JobPool & operator=(JobPool const &) = delete;
+    JobPool & operator=(JobPool &&);
+
+    // workers besides the calling thread, 0 to run everything serially
+    static JobPool Construct(size_t workerCount);
+
+    size_t WorkerCount() const;
+
+    // calls fn(begin, end, chunkIdx) for every chunkSize long chunk of
+    // [0, count), returns once all of them ran. Chunks must not touch each
+    // other's data
+    void ParallelFor(
+      size_t count, size_t chunkSize
+    , std::function<void(size_t begin, size_t end, size_t chunkIdx)> const & fn
+    );
+
+    struct Impl;
+    std::unique_ptr<Impl> impl;
+  };
+}
@@ -2,6 +2,9 @@
 
 #include <glm/glm.hpp>
 
+#include <algorithm>
+#include <cmath>
+
 namespace pul::util {
   inline bool CalculateTileIndices(
     size_t & tileIdx, glm::u32vec2 & texelOrigin
@@ -17,6 +20,8 @@ namespace pul::util {
 }
 
 namespace pul::physics {
+  // visits every texel of the line, cost is linear in its length; queries
+  // that have to cross long distances should use BresenhamTraversal instead
   template <typename Fn>
   void BresenhamLine(glm::ivec2 f0, glm::ivec2 f1, Fn && fn) {
     bool steep = false;
@@ -26,8 +31,6 @@ namespace pul::physics {
       steep = true;
     }
 
-
-    uint32_t maxSteps = 1'000u;
     if (f0.x > f1.x) {
       int32_t
         dx = f0.x-f1.x
@@ -38,7 +41,6 @@ namespace pul::physics {
       ;
 
       for (glm::ivec2 f = f0; f.x >= f1.x; -- f.x) {
-        if (--maxSteps == 0u) { break; }
         if (steep) { fn(f.y, f.x); } else { fn(f.x, f.y); }
         error += derror;
         if (error > dx) {
@@ -56,7 +58,6 @@ namespace pul::physics {
       ;
 
       for (glm::ivec2 f = f0; f.x <= f1.x; ++ f.x) {
-        if (--maxSteps == 0u) { break; }
         if (steep) { fn(f.y, f.x); } else { fn(f.x, f.y); }
         error += derror;
         if (error > dx) {
@@ -67,4 +68,154 @@ namespace pul::physics {
     }
 
   }
+
+  // walks the same texels as BresenhamLine, except any texel along the line can
+  // be computed directly from its index, so traversals are able to skip over
+  // texels that are known to be empty
+  struct BresenhamTraversal {
+    glm::i32vec2 beginOrigin; // (major, minor) axis order
+    int32_t stepMajor, stepMinor;
+    int64_t deltaMajor, deltaMinor;
+    float texelLength; // distance travelled per step along the major axis
+    uint32_t length; // amount of texels visited
+    bool steep;
+
+    glm::i32vec2 Texel(uint32_t const idx) const {
+      // closed form of BresenhamLine's error accumulation
+      int64_t const numerator = 2l*deltaMinor*idx - deltaMajor;
+      int64_t const minor =
+        numerator <= 0l ? 0l : (numerator + 2l*deltaMajor - 1l)/(2l*deltaMajor);
+
+      glm::i32vec2 const texel =
+        glm::i32vec2(
+          beginOrigin.x + stepMajor*static_cast<int32_t>(idx)
+        , beginOrigin.y + stepMinor*static_cast<int32_t>(minor)
+        );
+
+      return steep ? glm::i32vec2(texel.y, texel.x) : texel;
+    }
+
+    // amount of texels following any texel that are strictly within the
+    // radius of it
+    uint32_t TexelsWithinRadius(float const radius) const {
+      // the minor axis rounds by at most one texel, so the distance after k
+      // steps is bounded by k*texelLength + 1
+      float const steps = (radius - 1.0f) / texelLength;
+      if (!(steps > 1.0f)) { return 0u; }
+      if (steps >= static_cast<float>(length)) { return length; }
+      return static_cast<uint32_t>(std::ceil(steps)) - 1u;
+    }
+
+    // last index, starting from idx, whose texel stays within the inclusive
+    // box; the texel at idx must be inside of the box
+    uint32_t LastIndexWithin(
+      uint32_t const idx, glm::i32vec2 boxMin, glm::i32vec2 boxMax
+    ) const {
+      if (steep) {
+        boxMin = glm::i32vec2(boxMin.y, boxMin.x);
+        boxMax = glm::i32vec2(boxMax.y, boxMax.x);
+      }
+
+      // both axes are monotonic along the line, so only the exit side matters
+      int64_t const last =
+        std::min({
+          static_cast<int64_t>(length) - 1l
+        , static_cast<int64_t>(
+            stepMajor > 0
+          ? boxMax.x - beginOrigin.x : beginOrigin.x - boxMin.x
+          )
+        , this->LastIndexMinorAtMost(
+            stepMinor > 0
+          ? boxMax.y - beginOrigin.y : beginOrigin.y - boxMin.y
+          )
+        });
+
+      return static_cast<uint32_t>(std::max(last, static_cast<int64_t>(idx)));
+    }
+
+    // clips the traversal to the indices whose texels are within the inclusive
+    // box, returns false if the line never enters it. Lines are unbounded, so
+    // this is what keeps queries from walking texels they can't care about
+    bool ClipToBox(
+      glm::i32vec2 boxMin, glm::i32vec2 boxMax
+    , uint32_t & first, uint32_t & last
+    ) const {
+      if (steep) {
+        boxMin = glm::i32vec2(boxMin.y, boxMin.x);
+        boxMax = glm::i32vec2(boxMax.y, boxMax.x);
+      }
+
+      // box in texel offsets along the step directions
+      int64_t const
+        majorMin =
+          stepMajor > 0
+        ? boxMin.x - static_cast<int64_t>(beginOrigin.x)
+        : beginOrigin.x - static_cast<int64_t>(boxMax.x)
+      , majorMax =
+          stepMajor > 0
+        ? boxMax.x - static_cast<int64_t>(beginOrigin.x)
+        : beginOrigin.x - static_cast<int64_t>(boxMin.x)
+      , minorMin =
+          stepMinor > 0
+        ? boxMin.y - static_cast<int64_t>(beginOrigin.y)
+        : beginOrigin.y - static_cast<int64_t>(boxMax.y)
+      , minorMax =
+          stepMinor > 0
+        ? boxMax.y - static_cast<int64_t>(beginOrigin.y)
+        : beginOrigin.y - static_cast<int64_t>(boxMin.y)
+      ;
+
+      int64_t const
+        clipFirst =
+          std::max({
+            0l, majorMin, this->LastIndexMinorAtMost(minorMin - 1l) + 1l
+          })
+      , clipLast =
+          std::min({
+            static_cast<int64_t>(length) - 1l
+          , majorMax
+          , this->LastIndexMinorAtMost(minorMax)
+          })
+      ;
+
+      if (clipFirst > clipLast) { return false; }
+
+      first = static_cast<uint32_t>(clipFirst);
+      last = static_cast<uint32_t>(clipLast);
+      return true;
+    }
+
+    // last index whose minor axis offset from the beginning is at most minor
+    int64_t LastIndexMinorAtMost(int64_t const minor) const {
+      if (minor < 0l) { return -1l; }
+      if (deltaMinor == 0l) { return static_cast<int64_t>(length) - 1l; }
+      return (2l*deltaMajor*minor + deltaMajor) / (2l*deltaMinor);
+    }
+
+    static BresenhamTraversal Construct(glm::i32vec2 f0, glm::i32vec2 f1) {
+      BresenhamTraversal self;
+      self.steep = glm::abs(f0.x-f1.x) < glm::abs(f0.y-f1.y);
+      if (self.steep) {
+        std::swap(f0.x, f0.y);
+        std::swap(f1.x, f1.y);
+      }
+
+      self.beginOrigin = f0;
+      self.stepMajor = f0.x > f1.x ? -1 : +1;
+      self.stepMinor = f1.y > f0.y ? +1 : -1;
+      self.deltaMajor = glm::abs(static_cast<int64_t>(f1.x) - f0.x);
+      self.deltaMinor = glm::abs(static_cast<int64_t>(f1.y) - f0.y);
+      self.length = static_cast<uint32_t>(self.deltaMajor + 1l);
+
+      float const slope =
+        self.deltaMajor == 0l
+      ? 0.0f
+      : static_cast<float>(self.deltaMinor)/static_cast<float>(self.deltaMajor)
+      ;
+      // slightly overestimate so float error can't let a skip touch a solid
+      self.texelLength = std::sqrt(1.0f + slope*slope) * 1.0001f;
+
+      return self;
+    }
+  };
 }
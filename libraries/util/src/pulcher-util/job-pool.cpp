@@ -0,0 +1,140 @@
+#include <pulcher-util/job-pool.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct pul::util::JobPool::Impl {
+  std::vector<std::thread> workers;
+
+  std::mutex mutex;
+  std::condition_variable wake;
+  std::condition_variable done;
+  bool stopping = false;
+
+  // bumped for every job, so that workers run each job only once
+  size_t generation = 0ul;
+  size_t activeWorkers = 0ul;
+
+  // -- current job
+  std::function<void(size_t, size_t, size_t)> const * fn = nullptr;
+  size_t count = 0ul;
+  size_t chunkSize = 1ul;
+  size_t chunkCount = 0ul;
+  std::atomic<size_t> nextChunk = 0ul;
+
+  void RunChunks();
+  void WorkerLoop();
+};
+
+void pul::util::JobPool::Impl::RunChunks() {
+  for (;;) {
+    size_t const chunkIdx = nextChunk.fetch_add(1ul, std::memory_order_relaxed);
+    if (chunkIdx >= chunkCount) { return; }
+
+    size_t const begin = chunkIdx*chunkSize;
+    (*fn)(begin, std::min(begin + chunkSize, count), chunkIdx);
+  }
+}
+
+void pul::util::JobPool::Impl::WorkerLoop() {
+  size_t seenGeneration = 0ul;
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      wake.wait(
+        lock, [&]() { return stopping || generation != seenGeneration; }
+      );
+      if (stopping) { return; }
+      seenGeneration = generation;
+    }
+
+    this->RunChunks();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (-- activeWorkers == 0ul) { done.notify_one(); }
+  }
+}
+
+pul::util::JobPool::JobPool() = default;
+
+pul::util::JobPool::~JobPool() {
+  if (!impl) { return; }
+
+  {
+    std::lock_guard<std::mutex> lock(impl->mutex);
+    impl->stopping = true;
+  }
+  impl->wake.notify_all();
+
+  for (auto & worker : impl->workers) { worker.join(); }
+}
+
+pul::util::JobPool::JobPool(JobPool && other) {
+  this->impl = std::move(other.impl);
+}
+
+pul::util::JobPool & pul::util::JobPool::operator=(JobPool && other) {
+  // the workers of this pool have to be joined before taking over the others
+  JobPool previous;
+  previous.impl = std::move(this->impl);
+  this->impl = std::move(other.impl);
+  return *this;
+}
+
+pul::util::JobPool pul::util::JobPool::Construct(size_t const workerCount) {
+  JobPool self;
+  if (workerCount == 0ul) { return self; }
+
+  self.impl = std::make_unique<Impl>();
+  self.impl->workers.reserve(workerCount);
+  for (size_t it = 0ul; it < workerCount; ++ it) {
+    self.impl->workers.emplace_back(&Impl::WorkerLoop, self.impl.get());
+  }
+
+  return self;
+}
+
+size_t pul::util::JobPool::WorkerCount() const {
+  return impl ? impl->workers.size() : 0ul;
+}
+
+void pul::util::JobPool::ParallelFor(
+  size_t const count, size_t const chunkSize
+, std::function<void(size_t begin, size_t end, size_t chunkIdx)> const & fn
+) {
+  if (count == 0ul) { return; }
+
+  size_t const clampedChunkSize = std::max(chunkSize, 1ul);
+  size_t const chunkCount = (count + clampedChunkSize - 1ul) / clampedChunkSize;
+
+  // not worth waking workers for
+  if (!impl || chunkCount == 1ul) {
+    for (size_t chunkIdx = 0ul; chunkIdx < chunkCount; ++ chunkIdx) {
+      size_t const begin = chunkIdx*clampedChunkSize;
+      fn(begin, std::min(begin + clampedChunkSize, count), chunkIdx);
+    }
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(impl->mutex);
+    impl->fn = &fn;
+    impl->count = count;
+    impl->chunkSize = clampedChunkSize;
+    impl->chunkCount = chunkCount;
+    impl->nextChunk.store(0ul, std::memory_order_relaxed);
+    impl->activeWorkers = impl->workers.size();
+    ++ impl->generation;
+  }
+  impl->wake.notify_all();
+
+  impl->RunChunks();
+
+  std::unique_lock<std::mutex> lock(impl->mutex);
+  impl->done.wait(lock, [&]() { return impl->activeWorkers == 0ul; });
+  impl->fn = nullptr;
+}
@@ -1,4 +1,5 @@
 #include <pulcher-animation/animation.hpp>
+#include <pulcher-animation/database.hpp>
 #include <pulcher-core/scene-bundle.hpp>
 #include <pulcher-gfx/context.hpp>
 #include <pulcher-gfx/image.hpp>
@@ -16,6 +17,9 @@
 #include <imgui/imgui.hpp>
 #include <sokol/gfx.hpp>
 
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
 #include <fstream>
 
 // animation could always use cleaning / optimizing as a lot of it isn't based
@@ -34,66 +38,6 @@ static bool animPlaying = true;
 static bool animEmptyOnLoopEnd = false;
 static size_t animMaxTime = 100'000ul;
 
-void JsonParseRecursiveSkeleton(
-  cJSON * skeletalParentJson
-, std::vector<pul::animation::Animator::SkeletalPiece> & skeletals
-) {
-  if (!skeletalParentJson) { return; }
-  cJSON * skeletalChildJson;
-  cJSON_ArrayForEach(
-    skeletalChildJson
-  , cJSON_GetObjectItemCaseSensitive(skeletalParentJson, "skeleton")
-  ) {
-    pul::animation::Animator::SkeletalPiece skeletal;
-    skeletal.label =
-      cJSON_GetObjectItemCaseSensitive(skeletalChildJson, "label")->valuestring;
-    skeletal.origin.x =
-      cJSON_GetObjectItemCaseSensitive(skeletalChildJson, "origin-x")->valueint;
-    skeletal.origin.y =
-      cJSON_GetObjectItemCaseSensitive(skeletalChildJson, "origin-y")->valueint;
-    JsonParseRecursiveSkeleton(skeletalChildJson, skeletal.children);
-    skeletals.emplace_back(std::move(skeletal));
-  }
-}
-
-std::vector<pul::animation::Component> JsonLoadComponents(
-  cJSON * componentsJson
-) {
-  std::vector<pul::animation::Component> components;
-
-  cJSON * componentJson;
-  cJSON_ArrayForEach(componentJson, componentsJson) {
-    pul::animation::Component component;
-    component.tile.x =
-      cJSON_GetObjectItemCaseSensitive(componentJson, "x")->valueint;
-
-    component.tile.y =
-      cJSON_GetObjectItemCaseSensitive(componentJson, "y")->valueint;
-
-    component.msDeltaTimeOverride =
-      cJSON_GetObjectItemCaseSensitive(componentJson, "ms-delta-time-override")
-        ->valueint;
-
-    if (
-      auto offX =
-        cJSON_GetObjectItemCaseSensitive(componentJson, "origin-offset-x")
-    ) {
-      component.originOffset.x = offX->valueint;
-    }
-
-    if (
-      auto offY =
-        cJSON_GetObjectItemCaseSensitive(componentJson, "origin-offset-y")
-    ) {
-      component.originOffset.y = offY->valueint;
-    }
-
-    components.emplace_back(component);
-  }
-
-  return components;
-}
-
 cJSON * JsonWriteRecursiveSkeleton(
   std::vector<pul::animation::Animator::SkeletalPiece> & skeletals
 ) {
@@ -123,41 +67,80 @@ cJSON * JsonWriteRecursiveSkeleton(
   return skeletalsJson;
 }
 
-size_t ComputeVertexBufferSize(
-  std::vector<pul::animation::Animator::SkeletalPiece> const & skeletals
+// moves the containers of a pooled instance with the same animator & vertex
+// count into the instance, so that it doesn't have to allocate them
+void ReusePooledInstance(
+  pul::animation::System & system
+, pul::animation::Instance & instance
+, size_t const vertexBufferSize
 ) {
-  size_t vertices = 0ul;
-  for (const auto & skeletal : skeletals) {
-    vertices += 6 + ComputeVertexBufferSize(skeletal.children);
+  auto pool =
+    system.instancePool.find({instance.animator.get(), vertexBufferSize});
+  if (pool == system.instancePool.end() || pool->second.empty()) {
+    ++ system.instancesAllocated;
+    return;
   }
-  return vertices;
+
+  auto & pooled = pool->second.back();
+  instance.pieceToState = std::move(pooled.pieceToState);
+  instance.uvCoordBufferData = std::move(pooled.uvCoordBufferData);
+  instance.originBufferData = std::move(pooled.originBufferData);
+  instance.pieceRecords = std::move(pooled.pieceRecords);
+  instance.skeletalAccumulators = std::move(pooled.skeletalAccumulators);
+  pool->second.pop_back();
+
+  // nothing of the previous instance's states may carry over
+  instance.pieceToState.assign(instance.pieceToState.size(), {});
+
+  ++ system.instancesReused;
+}
+
+// hands the containers of a destroyed instance back to the pool
+void RecycleInstance(
+  pul::animation::System & system
+, entt::registry & registry
+, entt::entity const entity
+) {
+  auto & instance =
+    registry.get<pul::animation::ComponentInstance>(entity).instance;
+  if (!instance.animator) { return; }
+
+  auto & bucket =
+    system.instancePool[{instance.animator.get(), instance.drawCallCount}];
+  if (bucket.size() >= system.instancePoolBucketCapacity) { return; }
+
+  bucket.emplace_back(std::move(instance));
 }
 
 // used to compute generic animation info necessary for computing vertices and
 // caching animation state. Returns a pointer to list of components, nullptr if
-// none were found
+// none were found (in which case the state might be nullptr too)
 std::tuple<
   pul::animation::Animator::Piece &
 , pul::animation::Instance::StateInfo &
-, pul::animation::Animator::State &
+, pul::animation::Animator::State *
 , std::vector<pul::animation::Component> *
 > ComputeAnimationInfo(
   pul::animation::Instance & instance
-, pul::animation::Animator::SkeletalPiece const & skeletal
+, pul::animation::Animator::FlatSkeletal const & skeletal
 , bool & skeletalFlip
 , float & skeletalRotation
 ) {
-  // okay the below is crazy with the map lookups, I need to cache the
-  // state somehow
-  auto & piece     = instance.animator->pieces[skeletal.label];
-  auto & stateInfo = instance.pieceToState[skeletal.label];
-  auto & state     = piece.states[stateInfo.label];
+  // labels were interned when loading, so this is only indexing
+  auto & piece     = instance.animator->pieces[skeletal.pieceIdx];
+  auto & stateInfo = instance.pieceToState[skeletal.pieceIdx];
 
   // update skeletal information (origins, flip, rotation, etc)
   skeletalFlip ^= stateInfo.flip;
 
   skeletalRotation += stateInfo.angle;
 
+  if (stateInfo.stateIdx == -1ul) {
+    return { piece, stateInfo, nullptr, nullptr };
+  }
+
+  auto & state = piece.states[stateInfo.stateIdx];
+
   if (state.rotationMirrored && ((skeletalRotation > 0.0f) ^ skeletalFlip)) {
     skeletalFlip ^= 1;
   }
@@ -174,33 +157,73 @@ std::tuple<
 
   // grab component from flip/rotation
   auto * componentsPtr = state.ComponentLookup(variationRti);
-  return { piece, stateInfo, state, componentsPtr };
+  return { piece, stateInfo, &state, componentsPtr };
 }
 
+// writes the piece at the vertex offset, as its vertices or as its record
+void OutputPiece(
+  pul::animation::System const & system
+, pul::animation::Instance & instance
+, size_t const indexOffset
+, pul::animation::Instance::StateInfo::VertexInputs const & inputs
+) {
+  glm::vec2 const invResolution =
+    instance.animator->spritesheet.InvResolution();
+
+  if (system.instancedPieces) {
+    instance.pieceRecords[indexOffset/6ul] =
+      pul::animation::PackPieceRecord(inputs, invResolution);
+    return;
+  }
+
+  pul::animation::ComputePieceVertices(
+    inputs, invResolution
+  , std::span<glm::vec2, 6ul>(
+      instance.uvCoordBufferData.data() + indexOffset, 6ul
+    )
+  , std::span<glm::vec3, 6ul>(
+      instance.originBufferData.data() + indexOffset, 6ul
+    )
+  );
+}
+
+// pieces of the instances updated by one job pool chunk, summed up once every
+// chunk ran so the totals don't depend on which thread ran what
+struct UpdateCounts {
+  size_t piecesRecomputed = 0ul;
+  size_t piecesSkipped = 0ul;
+};
+
 void ComputeVertices(
-  pul::core::SceneBundle &
+  pul::animation::System const & system
+, ::UpdateCounts & counts
 , pul::animation::Instance & instance
-, pul::animation::Animator::SkeletalPiece const & skeletal
-, size_t & indexOffset
+, pul::animation::Animator::FlatSkeletal const & skeletal
 , bool & skeletalFlip
 , float & skeletalRotation
-, bool & forceUpdate
+, bool const forceUpdate
 ) {
-  auto const & [piece, stateInfo, state, componentsPtr] =
+  size_t const indexOffset = skeletal.vertexOffset;
+
+  auto const & [piece, stateInfo, statePtr, componentsPtr] =
     ComputeAnimationInfo(instance, skeletal, skeletalFlip, skeletalRotation);
 
   // if there are no components to render, output a degenerate tile
   if (!componentsPtr || componentsPtr->size() == 0ul) {
-    for (size_t it = 0ul; it < 6ul; ++ it) {
-      instance.uvCoordBufferData[indexOffset + it] = glm::vec2(-1);
-      instance.originBufferData[indexOffset + it] = glm::vec3(-1);
+    if (!forceUpdate && !stateInfo.vertexInputs.hasComponent) {
+      ++ counts.piecesSkipped;
+      return;
     }
 
-    indexOffset += 6ul;
+    stateInfo.vertexInputs = {};
+    ::OutputPiece(system, instance, indexOffset, stateInfo.vertexInputs);
+    instance.verticesDirty = true;
+    ++ counts.piecesRecomputed;
     return;
   }
 
   auto & components = *componentsPtr;
+  auto & state = *statePtr;
 
   PUL_ASSERT_CMP(components.size(), >, 0ul, return;);
 
@@ -211,9 +234,22 @@ void ComputeVertices(
 
   auto & component = components[stateInfo.componentIt];
 
-  // update delta time and if animation update is necessary, apply uv coord
-  // updates
-  bool hasUpdate = forceUpdate;
+  // snapshot what the vertices depend on before advancing the frame, as they
+  // are computed from the current component
+  pul::animation::Instance::StateInfo::VertexInputs vertexInputs;
+  vertexInputs.localSkeletalMatrix = stateInfo.cachedLocalSkeletalMatrix;
+  vertexInputs.uvCoordWrap = stateInfo.uvCoordWrap;
+  vertexInputs.vertWrap = stateInfo.vertWrap;
+  vertexInputs.tile = component.tile;
+  vertexInputs.dimensions = piece.dimensions;
+  vertexInputs.uvCoordOffset = instance.animator->uvCoordOffset;
+  vertexInputs.renderDepth = piece.renderDepth;
+  vertexInputs.uvFlip = skeletalFlip != state.flipXAxis;
+  vertexInputs.flipVertWrap = stateInfo.flipVertWrap;
+  vertexInputs.visible = stateInfo.visible;
+  vertexInputs.hasComponent = true;
+
+  // update delta time, the new component is picked up by the next update
   float const msDeltaTime = state.MsDeltaTime(component);
 
   if (msDeltaTime > 0.0f && !stateInfo.animationFinished) {
@@ -222,12 +258,10 @@ void ComputeVertices(
       if (state.loops) {
         stateInfo.deltaTime = stateInfo.deltaTime - msDeltaTime;
         stateInfo.componentIt = (stateInfo.componentIt + 1) % components.size();
-        hasUpdate = true;
       } else {
         if (stateInfo.componentIt < components.size()-1) {
           stateInfo.deltaTime = stateInfo.deltaTime - msDeltaTime;
           stateInfo.componentIt = stateInfo.componentIt + 1;
-          hasUpdate = true;
         } else {
           stateInfo.deltaTime = 0.0f;
           stateInfo.animationFinished = true;
@@ -236,110 +270,63 @@ void ComputeVertices(
     }
   }
 
-  if (!hasUpdate) {
-    indexOffset += 6ul;
+  // only dirty pieces recompute their vertices
+  if (!forceUpdate && vertexInputs == stateInfo.vertexInputs) {
+    ++ counts.piecesSkipped;
     return;
   }
 
-  auto pieceDimensions = glm::vec2(piece.dimensions);
-
-  // update origins & UV coords
-  for (size_t it = 0ul; it < 6; ++ it, ++ indexOffset) {
-    auto v = pul::util::TriangleVertexArray()[it];
-    auto uv = v;
-
-    auto uvCoordWrap = stateInfo.uvCoordWrap;
-    /* if (state.flipXAxis) { uvCoordWrap = 1.0f - uvCoordWrap; } */
-    /* if (skeletalFlip)    { uvCoordWrap = 1.0f - uvCoordWrap; } */
-
-    // apply uv clipping/wrapping if requested (non 1.0 value)
-    uv *= uvCoordWrap;
-    v  *= stateInfo.vertWrap;
-
-    if (stateInfo.flipVertWrap) {
-      v = glm::vec2(1.0f) - v;
-    }
-
-    // flip uv coords if requested
-    if (skeletalFlip) { uv.x = 1.0f - uv.x; }
-
-    if (state.flipXAxis) { uv.x = 1.0f - uv.x; }
-
-    instance.uvCoordBufferData[indexOffset] =
-      (
-          (uv*pieceDimensions + glm::vec2(component.tile)*pieceDimensions)
-        + glm::vec2(instance.animator->uvCoordOffset)
-      )
-      * instance.animator->spritesheet.InvResolution()
-    ;
-    auto origin = glm::vec3(v*pieceDimensions, 1.0f);
-
-    origin = stateInfo.cachedLocalSkeletalMatrix * origin;
+  stateInfo.vertexInputs = vertexInputs;
+  instance.verticesDirty = true;
+  ++ counts.piecesRecomputed;
 
-    // produce degenerate triangle if not visible
-    if (!stateInfo.visible)
-      { origin = glm::vec3(-99999.0f); }
-
-    instance.originBufferData[indexOffset] =
-        glm::vec3(origin.x, origin.y, static_cast<float>(piece.renderDepth));
-  }
+  ::OutputPiece(system, instance, indexOffset, vertexInputs);
 }
 
 void ComputeVertices(
-  pul::core::SceneBundle & scene
+  pul::animation::System const & system
+, ::UpdateCounts & counts
 , pul::animation::Instance & instance
-, std::vector<pul::animation::Animator::SkeletalPiece> const & skeletals
-, size_t & indexOffset
-, bool const skeletalFlip
-, float const skeletalRotation
-, bool const forceUpdate
+, bool const forceUpdate = false
 ) {
-  for (auto const & skeletal : skeletals) {
-    // compute origin / uv coords
-    bool newSkeletalFlip = skeletalFlip;
-    float newSkeletalRotation = skeletalRotation;
-    bool newForceUpdate = forceUpdate;
-    ComputeVertices(
-      scene, instance, skeletal, indexOffset
-    , newSkeletalFlip, newSkeletalRotation, newForceUpdate
-    );
+  auto const & skeleton = instance.animator->flatSkeleton;
+  auto & accumulators = instance.skeletalAccumulators;
+  accumulators.resize(skeleton.size());
+
+  // parents come first, so their flip & rotation are already accumulated
+  for (size_t it = 0ul; it < skeleton.size(); ++ it) {
+    auto const & skeletal = skeleton[it];
+    auto & accumulator = accumulators[it];
+
+    if (skeletal.parentIdx == -1ul) {
+      accumulator.flip = false;
+      accumulator.rotation = 0.0f;
+    } else {
+      accumulator.flip = accumulators[skeletal.parentIdx].flip;
+      accumulator.rotation = accumulators[skeletal.parentIdx].rotation;
+    }
 
-    // continue to children
-    ComputeVertices(
-      scene, instance, skeletal.children, indexOffset
-    , newSkeletalFlip, newSkeletalRotation, newForceUpdate
+    ::ComputeVertices(
+      system, counts, instance, skeletal
+    , accumulator.flip, accumulator.rotation, forceUpdate
     );
   }
 }
 
-void ComputeVertices(
-  pul::core::SceneBundle & scene
-, pul::animation::Instance & instance
-, bool forceUpdate = false
-) {
-  size_t indexOffset = 0ul;
-  ComputeVertices(
-    scene, instance, instance.animator->skeleton
-  , indexOffset, false, 0.0f, forceUpdate
-  );
-}
-
 void ComputeCache(
   pul::animation::Instance & instance
-, pul::animation::Animator::SkeletalPiece const & skeletal
+, pul::animation::Animator::FlatSkeletal const & skeletal
 , glm::mat3 & skeletalMatrix
 , bool & skeletalFlip
 , float & skeletalRotation
 ) {
-  if (instance.hasCalculatedCachedInfo) { return; }
-
-
-  auto const & [piece, stateInfo, state, componentsPtr] =
+  auto const & [piece, stateInfo, statePtr, componentsPtr] =
     ComputeAnimationInfo(instance, skeletal, skeletalFlip, skeletalRotation);
 
   if (!componentsPtr || componentsPtr->size() == 0ul) { return; }
 
   auto & components = *componentsPtr;
+  auto & state = *statePtr;
 
   PUL_ASSERT_CMP(
     stateInfo.componentIt, <, components.size()
@@ -424,23 +411,31 @@ void ComputeCache(
 
 void ComputeCache(
   pul::animation::Instance & instance
-, std::vector<pul::animation::Animator::SkeletalPiece> const & skeletals
-, glm::mat3 const skeletalMatrix
-, bool const skeletalFlip
-, float const skeletalRotation
+, glm::mat3 const & rootMatrix
 ) {
-  for (auto const & skeletal : skeletals) {
-    auto newSkeletalMatrix = skeletalMatrix;
-    auto newSkeletalFlip = skeletalFlip;
-    auto newSkeletalRotation = skeletalRotation;
-    ComputeCache(
-      instance, skeletal
-    , newSkeletalMatrix, newSkeletalFlip, newSkeletalRotation
-    );
+  if (instance.hasCalculatedCachedInfo) { return; }
 
-    ComputeCache(
-      instance, skeletal.children
-    , newSkeletalMatrix, newSkeletalFlip, newSkeletalRotation
+  auto const & skeleton = instance.animator->flatSkeleton;
+  auto & accumulators = instance.skeletalAccumulators;
+  accumulators.resize(skeleton.size());
+
+  // parents come first, so their matrix, flip & rotation are already
+  // accumulated
+  for (size_t it = 0ul; it < skeleton.size(); ++ it) {
+    auto const & skeletal = skeleton[it];
+    auto & accumulator = accumulators[it];
+
+    if (skeletal.parentIdx == -1ul) {
+      accumulator.matrix = rootMatrix;
+      accumulator.flip = false;
+      accumulator.rotation = 0.0f;
+    } else {
+      accumulator = accumulators[skeletal.parentIdx];
+    }
+
+    ::ComputeCache(
+      instance, skeletal
+    , accumulator.matrix, accumulator.flip, accumulator.rotation
     );
   }
 }
@@ -449,7 +444,7 @@ void ComputeCache(
 
 extern "C" {
 PUL_PLUGIN_DECL void Animation_ConstructInstance(
-  pul::core::SceneBundle & scene
+  pul::core::SceneBundle &
 , pul::animation::Instance & animationInstance
 , pul::animation::System & animationSystem
 , char const * label
@@ -464,59 +459,38 @@ PUL_PLUGIN_DECL void Animation_ConstructInstance(
     return;
   }
 
-  // set default values for pieces
-  for (auto & piecePair : animationInstance.animator->pieces) {
-    if (piecePair.second.states.begin() == piecePair.second.states.end()) {
+  // precompute size, six vertices per skeletal
+  size_t const vertexBufferSize =
+    animationInstance.animator->flatSkeleton.size()*6ul;
+
+  ::ReusePooledInstance(animationSystem, animationInstance, vertexBufferSize);
+
+  // set default values for pieces, the first state by label
+  auto const & animator = *animationInstance.animator;
+  animationInstance.pieceToState.resize(animator.pieces.size());
+  for (size_t pieceIdx = 0ul; pieceIdx < animator.pieces.size(); ++ pieceIdx) {
+    auto & pieceToState = animationInstance.pieceToState[pieceIdx];
+    pieceToState.animator = animationInstance.animator;
+    pieceToState.pieceIdx = pieceIdx;
+
+    if (animator.pieces[pieceIdx].states.empty()) {
       spdlog::error(
         "need at least one state for piece '{}' of '{}'"
-      , piecePair.first, animationInstance.animator->label
+      , animator.pieceLabels[pieceIdx], animator.label
       );
       continue;
     }
-    auto & pieceToState = animationInstance.pieceToState[piecePair.first];
-    pieceToState.label = piecePair.second.states.begin()->first;
-    pieceToState.animator = animationInstance.animator;
-    pieceToState.pieceLabel = piecePair.first;
+    pieceToState.stateIdx = 0ul;
   }
 
-  { // -- compute initial sokol buffers
-
-    // precompute size
-    size_t const vertexBufferSize =
-      ::ComputeVertexBufferSize(animationInstance.animator->skeleton);
-
+  { // -- compute initial vertices, the GPU buffers are shared by batches
     animationInstance.uvCoordBufferData.resize(vertexBufferSize);
     animationInstance.originBufferData.resize(vertexBufferSize);
+    animationInstance.pieceRecords.resize(vertexBufferSize/6ul);
 
-    ::ComputeVertices(scene, animationInstance, true);
-
-    { // -- origin
-      sg_buffer_desc desc = {};
-      desc.size = vertexBufferSize * sizeof(glm::vec3);
-      desc.usage = SG_USAGE_STREAM;
-      desc.content = nullptr;
-      desc.label = "origin buffer";
-      animationInstance.sgBufferOrigin = std::make_unique<pul::gfx::SgBuffer>();
-      animationInstance.sgBufferOrigin->buffer = sg_make_buffer(&desc);
-    }
-
-    { // -- uv coord
-      sg_buffer_desc desc = {};
-      desc.size = vertexBufferSize * sizeof(glm::vec2);
-      desc.usage = SG_USAGE_STREAM;
-      desc.content = nullptr;
-      desc.label = "uv coord buffer";
-      animationInstance.sgBufferUvCoord = std::make_unique<pul::gfx::SgBuffer>();
-      animationInstance.sgBufferUvCoord->buffer = sg_make_buffer(&desc);
-    }
-
-    // bindings
-    animationInstance.sgBindings.vertex_buffers[0] =
-      *animationInstance.sgBufferOrigin;
-    animationInstance.sgBindings.vertex_buffers[1] =
-      *animationInstance.sgBufferUvCoord;
-    animationInstance.sgBindings.fs_images[0] =
-      animationInstance.animator->spritesheet.Image();
+    ::UpdateCounts counts;
+    ::ComputeVertices(animationSystem, counts, animationInstance, true);
+    animationSystem.piecesRecomputed += counts.piecesRecomputed;
 
     // get draw call count
     animationInstance.drawCallCount = vertexBufferSize;
@@ -527,9 +501,147 @@ PUL_PLUGIN_DECL void Animation_ConstructInstance(
 
 namespace {
 
+// concatenates the vertices, or piece records, of every batch offset by their
+// instance origin into the batch vectors. Instances whose elements are already
+// in place from the previous frame are skipped. Returns the amount of
+// elements, and the range of elements that changed in dirtyBegin/dirtyEnd
+size_t BakeBatches(
+  pul::animation::System & system
+, size_t & dirtyBegin, size_t & dirtyEnd
+) {
+  bool const instanced = system.instancedPieces;
+  auto const elementCount =
+    [instanced](pul::animation::Instance const & instance) {
+      return
+        instanced ? instance.pieceRecords.size() : instance.drawCallCount;
+    };
+
+  size_t count = 0ul;
+  for (auto const & batch : system.batches)
+  for (auto const * instance : batch.instances)
+    { count += elementCount(*instance); }
+
+  if (instanced) {
+    system.batchPieceRecords.resize(count);
+  } else {
+    system.batchOrigins.resize(count);
+    system.batchUvCoords.resize(count);
+  }
+
+  size_t const previousFrame = system.bakeFrame;
+  ++ system.bakeFrame;
+
+  dirtyBegin = count;
+  dirtyEnd = 0ul;
+
+  size_t elementIt = 0ul;
+  for (auto & batch : system.batches) {
+    batch.elementBegin = elementIt;
+
+    for (auto * instance : batch.instances) {
+      size_t const instanceElementCount = elementCount(*instance);
+
+      // the stream still holds the elements if the instance was the last one
+      // to be baked into this range
+      if (
+          !instance->verticesDirty
+       && instance->bakedFrame == previousFrame
+       && instance->bakedElementBegin == elementIt
+       && instance->bakedOrigin == instance->origin
+      ) {
+        instance->bakedFrame = system.bakeFrame;
+        elementIt += instanceElementCount;
+        continue;
+      }
+
+      instance->verticesDirty = false;
+      instance->bakedFrame = system.bakeFrame;
+      instance->bakedElementBegin = elementIt;
+      instance->bakedOrigin = instance->origin;
+
+      dirtyBegin = std::min(dirtyBegin, elementIt);
+
+      if (instanced) {
+        for (auto record : instance->pieceRecords) {
+          record.origin += instance->origin;
+          system.batchPieceRecords[elementIt] = record;
+          ++ elementIt;
+        }
+      } else {
+        glm::vec3 const offset = glm::vec3(instance->origin, 0.0f);
+        for (size_t it = 0ul; it < instanceElementCount; ++ it, ++ elementIt) {
+          system.batchOrigins[elementIt] =
+            instance->originBufferData[it] + offset;
+          system.batchUvCoords[elementIt] = instance->uvCoordBufferData[it];
+        }
+      }
+
+      dirtyEnd = elementIt;
+    }
+
+    batch.elementCount = elementIt - batch.elementBegin;
+  }
+
+  return count;
+}
+
+// sokol buffers can't be resized, so they are recreated with room to grow.
+// Returns true if the buffers were recreated & have to be filled again
+bool ReserveBatchBuffers(pul::animation::System & system, size_t elements) {
+  if (system.instancedPieces) {
+    if (elements <= system.sgBufferPieceRecordCapacity) { return false; }
+
+    system.sgBufferPieceRecordCapacity =
+      std::max(elements, system.sgBufferPieceRecordCapacity*2ul);
+
+    system.sgBufferPieceRecord.Destroy();
+
+    sg_buffer_desc desc = {};
+    desc.size =
+      system.sgBufferPieceRecordCapacity * sizeof(pul::animation::PieceRecord);
+    desc.usage = SG_USAGE_STREAM;
+    desc.content = nullptr;
+    desc.label = "animation batch piece record buffer";
+    system.sgBufferPieceRecord.buffer = sg_make_buffer(&desc);
+
+    return true;
+  }
+
+  if (elements <= system.sgBufferCapacity) { return false; }
+
+  system.sgBufferCapacity = std::max(elements, system.sgBufferCapacity*2ul);
+
+  system.sgBufferOrigin.Destroy();
+  system.sgBufferUvCoord.Destroy();
+
+  { // -- origin
+    sg_buffer_desc desc = {};
+    desc.size = system.sgBufferCapacity * sizeof(glm::vec3);
+    desc.usage = SG_USAGE_STREAM;
+    desc.content = nullptr;
+    desc.label = "animation batch origin buffer";
+    system.sgBufferOrigin.buffer = sg_make_buffer(&desc);
+  }
+
+  { // -- uv coord
+    sg_buffer_desc desc = {};
+    desc.size = system.sgBufferCapacity * sizeof(glm::vec2);
+    desc.usage = SG_USAGE_STREAM;
+    desc.content = nullptr;
+    desc.label = "animation batch uv coord buffer";
+    system.sgBufferUvCoord.buffer = sg_make_buffer(&desc);
+  }
+
+  return true;
+}
+
 void ReconstructInstances(pul::core::SceneBundle & scene) {
   auto & registry = scene.EnttRegistry();
   auto & system = scene.AnimationSystem();
+
+  // pooled instances are sized for the animators from before they were edited
+  system.instancePool.clear();
+
   auto view = registry.view<pul::animation::ComponentInstance>();
   for (auto entity : view) {
     auto & self = view.get<pul::animation::ComponentInstance>(entity);
@@ -728,13 +840,14 @@ void DisplayImGuiSkeleton(
     { ImGui::OpenPopup("add skeletal"); }
 
   if (ImGui::BeginPopup("add skeletal")) {
-    for (auto & piecePair : animator.pieces) {
-      auto & label = std::get<0>(piecePair);
+    for (auto const & label : animator.pieceLabels) {
       if (ImGui::Selectable(label.c_str())) {
         skeletals.emplace_back(
           pul::animation::Animator::SkeletalPiece{label}
         );
+        animator.ResolveSkeleton();
         ReconstructInstances(scene);
+        break;
       }
     }
 
@@ -752,10 +865,13 @@ void DisplayImGuiSkeleton(
       continue;
     }
 
-    pul::imgui::DragInt2("origin", &skeletal.origin.x, 0.025f);
+    // the flattened skeleton holds a copy of the origin
+    if (pul::imgui::DragInt2("origin", &skeletal.origin.x, 0.025f))
+      { animator.ResolveSkeleton(); }
 
     if (ImGui::Button("remove")) {
       skeletals.erase(skeletals.begin() + skeletalIdx);
+      animator.ResolveSkeleton();
       ReconstructInstances(scene);
 
       ImGui::TreePop();
@@ -836,9 +952,9 @@ cJSON * SaveAnimation(pul::animation::Animator& animator) {
     spritesheetJson, "animation-piece", animationPieceJson
   );
 
-  for (auto const & piecePair : animator.pieces) {
-    auto const & pieceLabel = std::get<0>(piecePair);
-    auto const & piece = std::get<1>(piecePair);
+  for (size_t pieceIdx = 0ul; pieceIdx < animator.pieces.size(); ++ pieceIdx) {
+    auto const & pieceLabel = animator.pieceLabels[pieceIdx];
+    auto const & piece = animator.pieces[pieceIdx];
 
     cJSON * pieceJson = cJSON_CreateObject();
     cJSON_AddItemToArray(animationPieceJson, pieceJson);
@@ -865,9 +981,9 @@ cJSON * SaveAnimation(pul::animation::Animator& animator) {
     cJSON * statesJson = cJSON_CreateArray();
     cJSON_AddItemToObject(pieceJson, "states", statesJson);
 
-    for (auto const & statePair : piece.states) {
-      auto const & stateLabel = std::get<0>(statePair);
-      auto const & state = std::get<1>(statePair);
+    for (size_t stateIdx = 0ul; stateIdx < piece.states.size(); ++ stateIdx) {
+      auto const & stateLabel = piece.stateLabels[stateIdx];
+      auto const & state = piece.states[stateIdx];
 
       cJSON * stateJson = cJSON_CreateObject();
       cJSON_AddItemToArray(statesJson, stateJson);
@@ -988,208 +1104,6 @@ void SaveAnimations(pul::animation::System & system) {
   }
 }
 
-cJSON * LoadJsonFile(std::string const & filename) {
-  // load file
-  auto file = std::ifstream{filename};
-  if (file.eof() || !file.good()) {
-    spdlog::error("could not load spritesheet '{}'", filename);
-    return nullptr;
-  }
-
-  auto str =
-    std::string {
-      std::istreambuf_iterator<char>(file)
-    , std::istreambuf_iterator<char>()
-    };
-
-  auto fileDataJson = cJSON_Parse(str.c_str());
-
-  if (fileDataJson == nullptr) {
-    spdlog::critical(
-      " -- failed to parse json for '{}'; '{}'"
-    , filename
-    , cJSON_GetErrorPtr()
-    );
-  }
-
-  return fileDataJson;
-}
-
-void LoadAnimation(
-  std::string const & filename
-, std::map<
-    std::string
-  , std::shared_ptr<pul::animation::Animator>
-  > & animators
-) {
-
-  cJSON * fileDataJson = ::LoadJsonFile(filename);
-  if (!fileDataJson) { return; }
-
-  // iterate thru each spritesheet contained in file
-  cJSON * sheetJson;
-  cJSON_ArrayForEach(
-    sheetJson
-  , cJSON_GetObjectItemCaseSensitive(fileDataJson, "spritesheets")
-  ) {
-    auto animator = std::make_shared<pul::animation::Animator>();
-    animator->filename = filename;
-    animator->label =
-      std::string{
-        cJSON_GetObjectItemCaseSensitive(sheetJson, "label")->valuestring
-      };
-
-    animator->uvCoordOffset = {
-      cJSON_GetObjectItemCaseSensitive(sheetJson, "uv-offset-x")->valueint
-    , cJSON_GetObjectItemCaseSensitive(sheetJson, "uv-offset-y")->valueint
-    };
-
-    spdlog::debug("loading animation spritesheet '{}'", animator->label);
-    // store animator
-    animators[animator->label] = animator;
-
-    animator->spritesheet =
-      pul::gfx::Spritesheet::Construct(
-        pul::gfx::Image::Construct(
-          cJSON_GetObjectItemCaseSensitive(sheetJson, "filename")->valuestring
-        )
-      );
-
-    cJSON * pieceJson;
-    cJSON_ArrayForEach(
-      pieceJson, cJSON_GetObjectItemCaseSensitive(sheetJson, "animation-piece")
-    ) {
-      std::string pieceLabel =
-        cJSON_GetObjectItemCaseSensitive(pieceJson, "label")->valuestring;
-
-      pul::animation::Animator::Piece piece;
-
-      piece.dimensions.x =
-        cJSON_GetObjectItemCaseSensitive(pieceJson, "dimension-x")->valueint;
-      piece.dimensions.y =
-        cJSON_GetObjectItemCaseSensitive(pieceJson, "dimension-y")->valueint;
-
-      piece.origin.x =
-        cJSON_GetObjectItemCaseSensitive(pieceJson, "origin-x")->valueint;
-      piece.origin.y =
-        cJSON_GetObjectItemCaseSensitive(pieceJson, "origin-y")->valueint;
-
-      {
-        auto depth =
-          cJSON_GetObjectItemCaseSensitive(pieceJson, "render-order")->valueint;
-        if (depth < -127 || depth >= 127) {
-          spdlog::error(
-            "render-depth for '{}' of '{}' is OOB ({}); "
-            "range must be from -127 to 127"
-          , pieceLabel, animator->label, depth
-          );
-          depth = 0;
-        }
-        piece.renderDepth = depth;
-      }
-
-      cJSON * stateJson;
-      cJSON_ArrayForEach(
-        stateJson, cJSON_GetObjectItemCaseSensitive(pieceJson, "states")
-      ) {
-        std::string stateLabel =
-          cJSON_GetObjectItemCaseSensitive(stateJson, "label")->valuestring;
-
-        pul::animation::Animator::State state;
-
-        state.msDeltaTime =
-          cJSON_GetObjectItemCaseSensitive(
-            stateJson, "ms-delta-time"
-          )->valueint;
-
-        state.rotationMirrored =
-          cJSON_GetObjectItemCaseSensitive(stateJson, "rotation-mirrored")
-            ->valueint
-        ;
-
-        state.originInterpolates =
-          cJSON_GetObjectItemCaseSensitive(stateJson, "origin-interpolates")
-            ->valueint
-        ;
-
-        state.loops =
-          cJSON_GetObjectItemCaseSensitive(stateJson, "loops")
-            ->valueint
-        ;
-
-        state.rotatePixels =
-          cJSON_GetObjectItemCaseSensitive(stateJson, "rotate-pixels")
-            ->valueint
-        ;
-
-        state.flipXAxis =
-          cJSON_GetObjectItemCaseSensitive(stateJson, "flip-x-axis")
-            ->valueint
-        ;
-
-        cJSON * variationJson;
-        cJSON_ArrayForEach(
-          variationJson
-        , cJSON_GetObjectItemCaseSensitive(stateJson, "variations")
-        ) {
-          pul::animation::Variation variation;
-
-          state.variationType =
-            pul::animation::ToVariationType(
-              cJSON_GetObjectItemCaseSensitive(
-                stateJson, "variationType"
-              )->valuestring
-            );
-
-          switch (state.variationType) {
-            default: break;
-            case pul::animation::VariationType::Normal:
-              variation.normal.data =
-                ::JsonLoadComponents(
-                  cJSON_GetObjectItemCaseSensitive(variationJson, "default")
-                );
-            break;
-            case pul::animation::VariationType::Random:
-              variation.random.data =
-                ::JsonLoadComponents(
-                  cJSON_GetObjectItemCaseSensitive(variationJson, "default")
-                );
-            break;
-            case pul::animation::VariationType::Range:
-              variation.range.rangeMax =
-                cJSON_GetObjectItemCaseSensitive(
-                  variationJson, "angle-range-max"
-                )->valuedouble
-              ;
-
-              variation.range.data[0] =
-                ::JsonLoadComponents(
-                  cJSON_GetObjectItemCaseSensitive(variationJson, "default")
-                );
-
-              variation.range.data[1] =
-                ::JsonLoadComponents(
-                  cJSON_GetObjectItemCaseSensitive(variationJson, "flipped")
-                );
-            break;
-          }
-
-          state.variations.emplace_back(std::move(variation));
-        }
-
-        piece.states[stateLabel] = std::move(state);
-      }
-
-      animator->pieces[pieceLabel] = std::move(piece);
-    }
-
-    // load skeleton
-    ::JsonParseRecursiveSkeleton(sheetJson, animator->skeleton);
-  }
-
-  cJSON_Delete(fileDataJson);
-}
-
 } // -- namespace
 
 extern "C" {
@@ -1199,43 +1113,52 @@ PUL_PLUGIN_DECL void Animation_LoadAnimations(
 
   auto & animationSystem = scene.AnimationSystem();
 
-  { // load animations
-    cJSON * spritesheetDataJson =
-      ::LoadJsonFile("assets/base/spritesheets/data.json");
+  // pooled instances belong to the animators that are about to be replaced
+  animationSystem.instancePool.clear();
 
-    cJSON * filenameJson;
-    cJSON_ArrayForEach(
-      filenameJson
-    , cJSON_GetObjectItemCaseSensitive(spritesheetDataJson, "files")
+  { // load animations
+    // the compiled database is used unless any spritesheet json changed since
+    // it was written, in which case it's compiled again from the json
+    std::string const databaseFilename = "assets/base/spritesheets/data.animdb";
+    if (
+      !pul::animation::LoadAnimatorDatabase(
+        databaseFilename, animationSystem.animators
+      )
     ) {
-      spdlog::debug("loading json file '{}'", filenameJson->valuestring);
-      ::LoadAnimation(
-        std::string{filenameJson->valuestring}
-      , animationSystem.animators
+      auto const sourceFilenames =
+        pul::animation::LoadAnimatorsJson(
+          "assets/base/spritesheets/data.json", animationSystem.animators
+        );
+
+      pul::animation::WriteAnimatorDatabase(
+        databaseFilename, animationSystem.animators, sourceFilenames
       );
     }
 
-    cJSON_Delete(spritesheetDataJson);
+    for (auto & animatorPair : animationSystem.animators) {
+      auto & animator = *animatorPair.second;
+      std::string const spritesheetFilename = animator.spritesheet.filename;
+      animator.spritesheet =
+        pul::gfx::Spritesheet::Construct(
+          pul::gfx::Image::Construct(spritesheetFilename.c_str())
+        );
+    }
   }
 
   { // -- sokol animation program
     sg_shader_desc desc = {};
     desc.vs.uniform_blocks[0].size = sizeof(float) * 2;
-    desc.vs.uniform_blocks[0].uniforms[0].name = "originOffset";
+    desc.vs.uniform_blocks[0].uniforms[0].name = "framebufferResolution";
     desc.vs.uniform_blocks[0].uniforms[0].type = SG_UNIFORMTYPE_FLOAT2;
 
     desc.vs.uniform_blocks[1].size = sizeof(float) * 2;
-    desc.vs.uniform_blocks[1].uniforms[0].name = "framebufferResolution";
+    desc.vs.uniform_blocks[1].uniforms[0].name = "cameraOrigin";
     desc.vs.uniform_blocks[1].uniforms[0].type = SG_UNIFORMTYPE_FLOAT2;
 
     desc.vs.uniform_blocks[2].size = sizeof(float) * 2;
-    desc.vs.uniform_blocks[2].uniforms[0].name = "cameraOrigin";
+    desc.vs.uniform_blocks[2].uniforms[0].name = "textureResolution";
     desc.vs.uniform_blocks[2].uniforms[0].type = SG_UNIFORMTYPE_FLOAT2;
 
-    desc.vs.uniform_blocks[3].size = sizeof(float) * 2;
-    desc.vs.uniform_blocks[3].uniforms[0].name = "textureResolution";
-    desc.vs.uniform_blocks[3].uniforms[0].type = SG_UNIFORMTYPE_FLOAT2;
-
     desc.fs.images[0].name = "baseSampler";
     desc.fs.images[0].type = SG_IMAGETYPE_2D;
 
@@ -1246,7 +1169,6 @@ PUL_PLUGIN_DECL void Animation_LoadAnimations(
       out vec2 uvCoord;
       out vec2 vertexCoord;
 
-      uniform vec2 originOffset;
       uniform vec2 framebufferResolution;
       uniform vec2 cameraOrigin;
 
@@ -1262,10 +1184,9 @@ PUL_PLUGIN_DECL void Animation_LoadAnimations(
 
       void main() {
         vec2 framebufferScale = vec2(2.0f) / framebufferResolution;
+        // instance origins are baked into the vertices
         vec2 vertexOrigin = (inOrigin.xy)*vec2(1,-1) * framebufferScale;
-        vertexOrigin +=
-          (originOffset-cameraOrigin)*vec2(1, -1) * framebufferScale
-        ;
+        vertexOrigin += -cameraOrigin*vec2(1, -1) * framebufferScale;
         gl_Position = vec4(vertexOrigin, 0.5001f + inOrigin.z/100000.0f, 1.0f);
         uvCoord = vec2(inUvCoord.x, 1.0f-inUvCoord.y);
         vertexCoord = vertexArray[gl_VertexID%6];
@@ -1292,6 +1213,47 @@ PUL_PLUGIN_DECL void Animation_LoadAnimations(
     );
 
     animationSystem.sgProgram = sg_make_shader(&desc);
+
+    // expands a piece record per instance into its quad, the same as
+    // pul::animation::ExpandPieceRecordOrigin & ExpandPieceRecordUvCoord
+    desc.vs.source = PUL_SHADER(
+      layout(location = 0) in vec2 inOrigin;
+      layout(location = 1) in vec2 inAxisX;
+      layout(location = 2) in vec2 inAxisY;
+      layout(location = 3) in vec2 inUvCoordOrigin;
+      layout(location = 4) in vec2 inUvCoordAxis;
+      layout(location = 5) in float inDepth;
+
+      out vec2 uvCoord;
+      out vec2 vertexCoord;
+
+      uniform vec2 framebufferResolution;
+      uniform vec2 cameraOrigin;
+
+      const vec2 vertexArray[6] = vec2[](
+        vec2(0.0f,  0.0f)
+      , vec2(1.0f,  1.0f)
+      , vec2(1.0f,  0.0f)
+
+      , vec2(0.0f,  0.0f)
+      , vec2(0.0f,  1.0f)
+      , vec2(1.0f,  1.0f)
+      );
+
+      void main() {
+        vec2 vertex = vertexArray[gl_VertexID%6];
+        vec2 origin = inOrigin + inAxisX*vertex.x + inAxisY*vertex.y;
+        vec2 framebufferScale = vec2(2.0f) / framebufferResolution;
+        vec2 vertexOrigin = origin*vec2(1,-1) * framebufferScale;
+        vertexOrigin += -cameraOrigin*vec2(1, -1) * framebufferScale;
+        gl_Position = vec4(vertexOrigin, 0.5001f + inDepth/100000.0f, 1.0f);
+        vec2 inUvCoord = inUvCoordOrigin + inUvCoordAxis*vertex;
+        uvCoord = vec2(inUvCoord.x, 1.0f-inUvCoord.y);
+        vertexCoord = vertex;
+      }
+    );
+
+    animationSystem.sgProgramInstanced = sg_make_shader(&desc);
   }
 
   { // -- sokol pipeline
@@ -1330,7 +1292,51 @@ PUL_PLUGIN_DECL void Animation_LoadAnimations(
     desc.label = "animation pipeline";
 
     animationSystem.sgPipeline = sg_make_pipeline(&desc);
+
+    // piece records are stepped per instance, each expanding into six
+    // vertices
+    desc.layout = {};
+    desc.layout.buffers[0].stride = sizeof(pul::animation::PieceRecord);
+    desc.layout.buffers[0].step_func = SG_VERTEXSTEP_PER_INSTANCE;
+    desc.layout.buffers[0].step_rate = 1u;
+
+    desc.layout.attrs[0].buffer_index = 0;
+    desc.layout.attrs[0].offset = offsetof(pul::animation::PieceRecord, origin);
+    desc.layout.attrs[0].format = SG_VERTEXFORMAT_FLOAT2;
+
+    desc.layout.attrs[1].buffer_index = 0;
+    desc.layout.attrs[1].offset = offsetof(pul::animation::PieceRecord, axisX);
+    desc.layout.attrs[1].format = SG_VERTEXFORMAT_FLOAT2;
+
+    desc.layout.attrs[2].buffer_index = 0;
+    desc.layout.attrs[2].offset = offsetof(pul::animation::PieceRecord, axisY);
+    desc.layout.attrs[2].format = SG_VERTEXFORMAT_FLOAT2;
+
+    desc.layout.attrs[3].buffer_index = 0;
+    desc.layout.attrs[3].offset =
+      offsetof(pul::animation::PieceRecord, uvCoordOrigin);
+    desc.layout.attrs[3].format = SG_VERTEXFORMAT_FLOAT2;
+
+    desc.layout.attrs[4].buffer_index = 0;
+    desc.layout.attrs[4].offset =
+      offsetof(pul::animation::PieceRecord, uvCoordAxis);
+    desc.layout.attrs[4].format = SG_VERTEXFORMAT_FLOAT2;
+
+    desc.layout.attrs[5].buffer_index = 0;
+    desc.layout.attrs[5].offset = offsetof(pul::animation::PieceRecord, depth);
+    desc.layout.attrs[5].format = SG_VERTEXFORMAT_FLOAT;
+
+    desc.shader = animationSystem.sgProgramInstanced;
+    desc.label = "animation instanced pipeline";
+
+    animationSystem.sgPipelineInstanced = sg_make_pipeline(&desc);
   }
+
+  // destroyed instances return their containers to the pool, disconnected
+  // on shutdown as the plugin might be reloaded
+  scene.EnttRegistry()
+    .on_destroy<pul::animation::ComponentInstance>()
+    .connect<&::RecycleInstance>(animationSystem);
 }
 
 PUL_PLUGIN_DECL void Animation_Shutdown(pul::core::SceneBundle & scene) {
@@ -1338,6 +1344,10 @@ PUL_PLUGIN_DECL void Animation_Shutdown(pul::core::SceneBundle & scene) {
 
   ::SaveAnimations(scene.AnimationSystem());
 
+  registry
+    .on_destroy<pul::animation::ComponentInstance>()
+    .disconnect<&::RecycleInstance>(scene.AnimationSystem());
+
   { // -- delete sokol animation information
     auto view = registry.view<pul::animation::ComponentInstance>();
 
@@ -1350,6 +1360,11 @@ PUL_PLUGIN_DECL void Animation_Shutdown(pul::core::SceneBundle & scene) {
 
   sg_destroy_shader(scene.AnimationSystem().sgProgram);
   sg_destroy_pipeline(scene.AnimationSystem().sgPipeline);
+  sg_destroy_shader(scene.AnimationSystem().sgProgramInstanced);
+  sg_destroy_pipeline(scene.AnimationSystem().sgPipelineInstanced);
+  scene.AnimationSystem().sgBufferOrigin.Destroy();
+  scene.AnimationSystem().sgBufferUvCoord.Destroy();
+  scene.AnimationSystem().sgBufferPieceRecord.Destroy();
 
   scene.AnimationSystem() = {};
 }
@@ -1358,32 +1373,162 @@ PUL_PLUGIN_DECL void Animation_UpdateFrame(
   pul::plugin::Info const &, pul::core::SceneBundle & scene
 ) {
   auto & registry = scene.EnttRegistry();
-  // update each component
+  auto & system = scene.AnimationSystem();
+
+  auto const timeUpdateBegin = std::chrono::steady_clock::now();
+
+  system.piecesRecomputed = 0ul;
+  system.piecesSkipped = 0ul;
+
+  // switching between vertices & piece records recomputes every piece, and
+  // nothing baked into the previous stream can be reused
+  bool const forceUpdate =
+    system.instancedPieces != system.useInstancedPieces;
+  if (forceUpdate) {
+    system.instancedPieces = system.useInstancedPieces;
+    ++ system.bakeFrame;
+  }
+
+  // workers run plugin code, so the pool is only ever built by the plugin
+  if (system.updateJobPool.WorkerCount() != system.updateWorkerCount) {
+    system.updateJobPool =
+      pul::util::JobPool::Construct(system.updateWorkerCount);
+  }
+
+  // an instance only touches its own state & its (immutable) animator, so
+  // they're updated in parallel chunks in the order of the view
+  system.updateInstances.clear();
   auto view = registry.view<pul::animation::ComponentInstance>();
   for (auto entity : view) {
-    auto & self = view.get<pul::animation::ComponentInstance>(entity);
-
-    ::ComputeCache(
-      self.instance, self.instance.animator->skeleton
-    , glm::mat3(1.0f), false, 0.0f
+    system.updateInstances.emplace_back(
+      &view.get<pul::animation::ComponentInstance>(entity).instance
     );
+  }
+
+  size_t constexpr instancesPerChunk = 64ul;
+  std::vector<::UpdateCounts> chunkCounts(
+    (system.updateInstances.size() + instancesPerChunk - 1ul)
+  / instancesPerChunk
+  );
+
+  // update each instance, only dirty pieces recompute their vertices
+  system.updateJobPool.ParallelFor(
+    system.updateInstances.size(), instancesPerChunk
+  , [&system, &chunkCounts, forceUpdate](
+      size_t const begin, size_t const end, size_t const chunkIdx
+    ) {
+      for (size_t it = begin; it < end; ++ it) {
+        auto & instance = *system.updateInstances[it];
+
+        ::ComputeCache(instance, glm::mat3(1.0f));
+
+        ::ComputeVertices(system, chunkCounts[chunkIdx], instance, forceUpdate);
+      }
+    }
+  );
 
-    ::ComputeVertices(scene, self.instance, true);
+  for (auto const & counts : chunkCounts) {
+    system.piecesRecomputed += counts.piecesRecomputed;
+    system.piecesSkipped += counts.piecesSkipped;
   }
+
+  system.updateMs =
+    std::chrono::duration<double, std::milli>(
+      std::chrono::steady_clock::now() - timeUpdateBegin
+    ).count();
 }
 
 PUL_PLUGIN_DECL void Animation_RenderAnimations(
   pul::plugin::Info const &, pul::core::SceneBundle & scene
 ) {
   auto & registry = scene.EnttRegistry();
+  auto & system = scene.AnimationSystem();
+
+  system.drawCalls = 0ul;
+  system.drawnInstances = 0ul;
+  system.elementsUploaded = 0ul;
+
+  { // -- gather visible instances by spritesheet
+    for (auto & batch : system.batches) { batch.instances.clear(); }
+
+    auto view = registry.view<pul::animation::ComponentInstance>();
+    for (auto entity : view) {
+      auto & self = view.get<pul::animation::ComponentInstance>(entity);
+
+      if (self.instance.automaticCachedMatrixCalculation)
+        { self.instance.hasCalculatedCachedInfo = false; }
+
+      if (
+          !self.instance.visible
+       || self.instance.drawCallCount == 0ul
+      ) { continue; }
+
+      auto & spritesheet = self.instance.animator->spritesheet;
+      sg_image const image = spritesheet.Image();
+
+      auto batch =
+        std::find_if(
+          system.batches.begin(), system.batches.end()
+        , [&image](auto const & b) { return b.image.id == image.id; }
+        );
+
+      if (batch == system.batches.end()) {
+        batch = system.batches.emplace(system.batches.end());
+        batch->image = image;
+        batch->resolution =
+          glm::vec2(spritesheet.width, spritesheet.height);
+      }
+
+      batch->instances.emplace_back(&self.instance);
+      ++ system.drawnInstances;
+    }
+  }
+
+  size_t dirtyBegin, dirtyEnd;
+  size_t const elementCount = ::BakeBatches(system, dirtyBegin, dirtyEnd);
+  if (elementCount == 0ul) { return; }
+
+  bool const instanced = system.instancedPieces;
+
+  { // -- upload every batch at once, sokol allows only one update per frame
+    bool const recreated = ::ReserveBatchBuffers(system, elementCount);
+
+    // sokol can only replace a buffer's contents from its start, and cycles
+    // stream buffers through in-flight copies, so a partial upload would
+    // leave stale vertices behind; only a clean stream skips the upload
+    if (dirtyBegin < dirtyEnd || recreated) {
+      if (instanced) {
+        sg_update_buffer(
+          system.sgBufferPieceRecord,
+          system.batchPieceRecords.data(),
+          elementCount * sizeof(pul::animation::PieceRecord)
+        );
+      } else {
+        sg_update_buffer(
+          system.sgBufferUvCoord,
+          system.batchUvCoords.data(),
+          elementCount * sizeof(glm::vec2)
+        );
+        sg_update_buffer(
+          system.sgBufferOrigin,
+          system.batchOrigins.data(),
+          elementCount * sizeof(glm::vec3)
+        );
+      }
+      system.elementsUploaded = elementCount;
+    }
+  }
+
   { // -- render sokol animations
 
     // bind pipeline & global uniforms
-    sg_apply_pipeline(scene.AnimationSystem().sgPipeline);
+    sg_apply_pipeline(
+      instanced ? system.sgPipelineInstanced : system.sgPipeline
+    );
 
     sg_apply_uniforms(
       SG_SHADERSTAGE_VS
-    , 1
+    , 0
     , &scene.config.framebufferDimFloat.x
     , sizeof(float) * 2ul
     );
@@ -1392,59 +1537,46 @@ PUL_PLUGIN_DECL void Animation_RenderAnimations(
 
     sg_apply_uniforms(
       SG_SHADERSTAGE_VS
-    , 2
+    , 1
     , &cameraOrigin.x
     , sizeof(float) * 2ul
     );
 
-    // render each component
-    auto view = registry.view<pul::animation::ComponentInstance>();
-    for (auto entity : view) {
-      auto & self = view.get<pul::animation::ComponentInstance>(entity);
-
-      if (self.instance.automaticCachedMatrixCalculation)
-        { self.instance.hasCalculatedCachedInfo = false; }
+    // one draw per spritesheet
+    sg_bindings bindings = {};
+    if (instanced) {
+      bindings.vertex_buffers[0] = system.sgBufferPieceRecord;
+    } else {
+      bindings.vertex_buffers[0] = system.sgBufferOrigin;
+      bindings.vertex_buffers[1] = system.sgBufferUvCoord;
+    }
 
-      if (
-          !self.instance.visible
-       || self.instance.drawCallCount == 0ul
-      ) { continue; }
+    for (auto const & batch : system.batches) {
+      if (batch.elementCount == 0ul) { continue; }
 
-      sg_apply_bindings(self.instance.sgBindings);
+      bindings.fs_images[0] = batch.image;
 
-      sg_apply_uniforms(
-        SG_SHADERSTAGE_VS
-      , 0
-      , &self.instance.origin.x
-      , sizeof(float) * 2ul
-      );
+      // sokol has no base instance, so records are offset by their binding
+      if (instanced) {
+        bindings.vertex_buffer_offsets[0] =
+          batch.elementBegin * sizeof(pul::animation::PieceRecord);
+      }
 
-      glm::vec2 resolution =
-        glm::vec2(
-          self.instance.animator->spritesheet.width
-        , self.instance.animator->spritesheet.height
-        );
+      sg_apply_bindings(bindings);
 
       sg_apply_uniforms(
         SG_SHADERSTAGE_VS
-      , 3
-      , &resolution.x
+      , 2
+      , &batch.resolution.x
       , sizeof(float) * 2ul
       );
 
-      // must update entire animation buffer
-      sg_update_buffer(
-        *self.instance.sgBufferUvCoord,
-        self.instance.uvCoordBufferData.data(),
-        self.instance.uvCoordBufferData.size() * sizeof(glm::vec2)
-      );
-      sg_update_buffer(
-        *self.instance.sgBufferOrigin,
-        self.instance.originBufferData.data(),
-        self.instance.originBufferData.size() * sizeof(glm::vec3)
-      );
-
-      sg_draw(0, self.instance.drawCallCount, 1);
+      if (instanced) {
+        sg_draw(0, 6, batch.elementCount);
+      } else {
+        sg_draw(batch.elementBegin, batch.elementCount, 1);
+      }
+      ++ system.drawCalls;
     }
   }
 }
@@ -1452,9 +1584,7 @@ PUL_PLUGIN_DECL void Animation_RenderAnimations(
 PUL_PLUGIN_DECL void Animation_UpdateCache(
   pul::animation::Instance & instance
 ) {
-  ::ComputeCache(
-    instance, instance.animator->skeleton, glm::mat3(1.0f), false, 0.0f
-  );
+  ::ComputeCache(instance, glm::mat3(1.0f));
   instance.hasCalculatedCachedInfo = true;
 }
 
@@ -1462,9 +1592,7 @@ PUL_PLUGIN_DECL void Animation_UpdateCacheWithPrecalculatedMatrix(
   pul::animation::Instance & instance
 , glm::mat3 const & skeletalMatrix
 ) {
-  ::ComputeCache(
-    instance, instance.animator->skeleton, skeletalMatrix, false, 0.0f
-  );
+  ::ComputeCache(instance, skeletalMatrix);
   instance.hasCalculatedCachedInfo = true;
 }
 
@@ -1520,12 +1648,13 @@ PUL_PLUGIN_DECL void Animation_UiRender(
       PUL_ASSERT(self.instance.animator, continue;);
 
       if (ImGui::TreeNode(self.instance.animator->label.c_str())) {
-        for (auto const & stateInfoPair : self.instance.pieceToState) {
-          auto & stateInfo = stateInfoPair.second;
-
-          pul::imgui::Text("part - '{}'", stateInfoPair.first);
+        auto const & animator = *self.instance.animator;
+        for (auto const & stateInfo : self.instance.pieceToState) {
+          pul::imgui::Text(
+            "part - '{}'", animator.pieceLabels[stateInfo.pieceIdx]
+          );
           pul::imgui::Text("\torigin '{}'", self.instance.origin);
-          pul::imgui::Text("\tlabel '{}'", stateInfo.label);
+          pul::imgui::Text("\tlabel '{}'", stateInfo.Label());
           pul::imgui::Text("\tdelta-time {}", stateInfo.deltaTime);
           pul::imgui::Text(
             "\tanimation-finished {}", stateInfo.animationFinished
@@ -1545,10 +1674,12 @@ PUL_PLUGIN_DECL void Animation_UiRender(
           , mat[2][0], mat[2][1], mat[2][2]
           );
 
+          if (stateInfo.stateIdx == -1ul) { continue; }
+
           auto variationType =
-            self.instance.animator
-              ->pieces[stateInfoPair.first]
-              .states[stateInfoPair.second.label]
+            animator
+              .pieces[stateInfo.pieceIdx]
+              .states[stateInfo.stateIdx]
               .variationType
           ;
 
@@ -1649,7 +1780,9 @@ PUL_PLUGIN_DECL void Animation_UiRender(
           )
         ) {
           if (pieceLabel != "") {
-            animator.pieces[pieceLabel] = {};
+            animator.InternPiece(pieceLabel);
+            animator.ResolveSkeleton();
+            ReconstructInstances(scene);
           }
           pieceLabel = "";
           ImGui::CloseCurrentPopup();
@@ -1659,15 +1792,18 @@ PUL_PLUGIN_DECL void Animation_UiRender(
       }
     }
 
-    size_t pieceIt = 0ul;
-    for (auto & piecePair : animator.pieces) {
+    for (
+      size_t pieceIdx = 0ul;
+      pieceIdx < animator.pieces.size();
+      ++ pieceIdx
+    ) {
       ImGui::Separator();
 
-      auto & piece = piecePair.second;
+      auto & piece = animator.pieces[pieceIdx];
 
-      ImGui::PushID(++ pieceIt);
+      ImGui::PushID(pieceIdx + 1ul);
 
-      if (ImGui::TreeNode(piecePair.first.c_str())) {
+      if (ImGui::TreeNode(animator.pieceLabels[pieceIdx].c_str())) {
 
       { // delete piece
         if (ImGui::Button("x"))
@@ -1675,7 +1811,12 @@ PUL_PLUGIN_DECL void Animation_UiRender(
 
         if (ImGui::BeginPopup("piece delete confirm")) {
           if (ImGui::Button("confirm deletion")) {
-            animator.pieces.erase(animator.pieces.find(piecePair.first));
+            animator.pieces.erase(animator.pieces.begin() + pieceIdx);
+            animator.pieceLabels.erase(
+              animator.pieceLabels.begin() + pieceIdx
+            );
+            animator.ResolveSkeleton();
+            ReconstructInstances(scene);
             ImGui::EndPopup();
             ImGui::TreePop();
             break;
@@ -1707,7 +1848,8 @@ PUL_PLUGIN_DECL void Animation_UiRender(
               )
             ) {
               if (newStateLabel != "") {
-                piece.states[newStateLabel] = {};
+                piece.InternState(newStateLabel);
+                ReconstructInstances(scene);
               }
               newStateLabel = "";
               ImGui::CloseCurrentPopup();
@@ -1717,10 +1859,14 @@ PUL_PLUGIN_DECL void Animation_UiRender(
           }
         }
 
-        for (auto & statePair : piece.states) {
+        for (
+          size_t stateIdx = 0ul;
+          stateIdx < piece.states.size();
+          ++ stateIdx
+        ) {
           ImGui::Separator();
 
-          if (!ImGui::TreeNode(statePair.first.c_str())) {
+          if (!ImGui::TreeNode(piece.stateLabels[stateIdx].c_str())) {
             continue;
           }
 
@@ -1730,7 +1876,9 @@ PUL_PLUGIN_DECL void Animation_UiRender(
 
             if (ImGui::BeginPopup("state delete confirm")) {
               if (ImGui::Button("confirm deletion")) {
-                piece.states.erase(piece.states.find(statePair.first));
+                piece.states.erase(piece.states.begin() + stateIdx);
+                piece.stateLabels.erase(piece.stateLabels.begin() + stateIdx);
+                ReconstructInstances(scene);
                 ImGui::EndPopup();
                 ImGui::TreePop();
                 break;
@@ -1739,14 +1887,11 @@ PUL_PLUGIN_DECL void Animation_UiRender(
             }
           }
 
-          auto & state = statePair.second;
-          (void)state;
+          auto & state = piece.states[stateIdx];
 
-          pul::imgui::DragInt(
-            "delta time", &statePair.second.msDeltaTime, 1.0f
-          );
+          pul::imgui::DragInt("delta time", &state.msDeltaTime, 1.0f);
 
-          auto & variations = statePair.second.variations;
+          auto & variations = state.variations;
 
           bool variationChanged = false;
 
@@ -2024,7 +2169,7 @@ PUL_PLUGIN_DECL void Animation_UiRender(
         ImGui::TreePop(); // piece
       }
 
-      ImGui::PopID(); // pieceIt
+      ImGui::PopID(); // pieceIdx
     }
 
     ImGui::End();
@@ -29,11 +29,19 @@
 #include <imgui/imgui.hpp>
 
 #include <random>
+#include <vector>
 
 namespace {
 
+using Piece = pul::animation::GameplayPiece;
+
 bool botPlays = false;
 
+// grenades slower than this, in pixels per tick, that keep resting on
+// geometry for sleepRestingTicks in a row stop querying physics
+float constexpr sleepVelocity = 0.15f;
+uint8_t constexpr sleepRestingTicks = 30u;
+
 } // -- namespace
 
 extern "C" {
@@ -95,6 +103,8 @@ PUL_PLUGIN_DECL void Entity_EntityUpdate(
 ) {
   auto & registry = scene.EnttRegistry();
 
+  plugin.physics.EntityBroadphaseRebuild(scene);
+
   { // -- projectile exploder
     auto view =
       registry.view<
@@ -103,14 +113,41 @@ PUL_PLUGIN_DECL void Entity_EntityUpdate(
       , pul::core::ComponentParticle
       >();
 
+    // -- the tilemap rays of every projectile are cast as one batch
+    std::vector<entt::entity> exploders;
+    std::vector<pul::physics::IntersectorRay> exploderRays;
     for (auto entity : view) {
+      auto const & animation =
+        view.get<pul::animation::ComponentInstance>(entity);
+      auto const & particle = view.get<pul::core::ComponentParticle>(entity);
+
+      exploders.emplace_back(entity);
+      exploderRays.emplace_back(
+        pul::physics::IntersectorRay::Construct(
+          animation.instance.origin,
+          animation.instance.origin + particle.velocity
+        )
+      );
+    }
+
+    std::vector<pul::physics::IntersectionResults>
+      exploderResults(exploderRays.size());
+    plugin.physics.IntersectionRaycastBatch(
+      scene, exploderRays, exploderResults
+    , pul::core::CollisionChannel::Projectile
+    );
+
+    for (
+      size_t exploderIdx = 0ul; exploderIdx < exploders.size(); ++ exploderIdx
+    ) {
+      auto const entity = exploders[exploderIdx];
       auto & animation = view.get<pul::animation::ComponentInstance>(entity);
       auto & exploder = view.get<pul::core::ComponentParticleExploder>(entity);
       auto & particle = view.get<pul::core::ComponentParticle>(entity);
 
       bool explode =
           exploder.explodeOnDelete
-       && animation.instance.pieceToState["particle"].animationFinished
+       && animation.instance.PieceState(::Piece::Particle).animationFinished
       ;
 
       entt::entity playerDirectHit = entt::null;
@@ -118,20 +155,9 @@ PUL_PLUGIN_DECL void Entity_EntityUpdate(
       glm::vec2 explodeOrigin = particle.origin;
 
       // check if physics bound
-      if (!explode) {
-        auto ray =
-          pul::physics::IntersectorRay::Construct(
-            animation.instance.origin,
-            animation.instance.origin + particle.velocity
-          );
-
-        if (
-          pul::physics::IntersectionResults results;
-          plugin.physics.IntersectionRaycast(scene, ray, results)
-        ) {
-          explodeOrigin = results.origin;
-          explode |= exploder.explodeOnCollide;
-        }
+      if (!explode && exploderResults[exploderIdx].collision) {
+        explodeOrigin = exploderResults[exploderIdx].origin;
+        explode |= exploder.explodeOnCollide;
       }
 
       // check for player
@@ -200,7 +226,7 @@ PUL_PLUGIN_DECL void Entity_EntityUpdate(
       auto & particle = view.get<pul::core::ComponentParticleGrenade>(entity);
 
       bool destroyInstance =
-        animation.instance.pieceToState["particle"].animationFinished
+        animation.instance.PieceState(::Piece::Particle).animationFinished
       ;
 
       // negate before comparison so that physics are ran on frame of
@@ -210,8 +236,19 @@ PUL_PLUGIN_DECL void Entity_EntityUpdate(
         destroyInstance = true;
       }
 
+      // -- the geometry a sleeping grenade rests on might have changed
+      if (
+          particle.asleep
+       && particle.sleepGeometryVersion != plugin.physics.GeometryVersion()
+      ) {
+        particle.asleep = false;
+        particle.restingTicks = 0u;
+      }
+
+      bool touchedGeometry = false;
+
       // check physics bounce
-      if (particle.velocity != glm::vec2()) {
+      if (!particle.asleep && particle.velocity != glm::vec2()) {
 
         if (particle.gravityAffected)
           { particle.velocity.y += 0.05f; }
@@ -224,28 +261,12 @@ PUL_PLUGIN_DECL void Entity_EntityUpdate(
 
         if (
           pul::physics::IntersectionResults results;
-          plugin.physics.IntersectionRaycast(scene, ray, results)
+          plugin.physics.IntersectionRaycast(
+            scene, ray, results, pul::core::CollisionChannel::Projectile
+          )
         ) {
-          // calculate normal (TODO this should be precomputed)
-          glm::vec2 normal = glm::vec2(0.0f);
-
-          for (auto point : std::vector<glm::vec2>{
-            { -1.0f, -1.0f }, { +0.0f, -1.0f }, { +1.0f, -1.0f }
-          , { -1.0f, +0.0f },                   { +1.0f, +0.0f }
-          , { -1.0f, +1.0f }, { +0.0f, +1.0f }, { +1.0f, +1.0f }
-          }) {
-            auto pointInt =
-              pul::physics::IntersectorPoint{
-                glm::i32vec2(glm::vec2(results.origin) + point)
-              };
-            if (
-              pul::physics::IntersectionResults pointResult;
-              plugin.physics.IntersectionPoint(scene, pointInt, pointResult)
-            ) {
-              normal += point;
-            }
-          }
-          normal = glm::normalize(normal);
+          glm::vec2 const normal = results.normal;
+          touchedGeometry = true;
 
           // TODO have to detect normal of wall...
           animation.instance.origin = results.origin;
@@ -276,11 +297,11 @@ PUL_PLUGIN_DECL void Entity_EntityUpdate(
             );
 
             bounceAnimation
-              .pieceToState["particle"]
+              .PieceState(::Piece::Particle)
               .Apply(particle.bounceAnimation, true);
 
-            bounceAnimation.pieceToState["particle"].angle
-              = animation.instance.pieceToState["particle"].angle;
+            bounceAnimation.PieceState(::Piece::Particle).angle
+              = animation.instance.PieceState(::Piece::Particle).angle;
 
             bounceAnimation.origin = animation.instance.origin;
 
@@ -299,6 +320,30 @@ PUL_PLUGIN_DECL void Entity_EntityUpdate(
         }
       }
 
+      // -- sleep once slow & resting; grenades counting their bounces
+      //    detonate on them instead. Contacts of a resting grenade can skip
+      //    a tick while it hops, so its support is probed below it as well
+      if (!particle.asleep && !particle.useBounces) {
+        bool resting = glm::length(particle.velocity) < ::sleepVelocity;
+        if (resting && !touchedGeometry) {
+          pul::physics::IntersectorPoint point;
+          point.origin = animation.instance.origin + glm::vec2(0.0f, 2.0f);
+          pul::physics::IntersectionResults results;
+          resting =
+              particle.gravityAffected
+           && plugin.physics.IntersectionPoint(
+                scene, point, results, pul::core::CollisionChannel::Projectile
+              );
+        }
+
+        particle.restingTicks = resting ? particle.restingTicks + 1u : 0u;
+
+        if (particle.restingTicks >= ::sleepRestingTicks) {
+          particle.asleep = true;
+          particle.sleepGeometryVersion = plugin.physics.GeometryVersion();
+        }
+      }
+
       entt::entity playerDirectHit = entt::null;
 
       if (!destroyInstance && particle.damage.damagePlayer) {
@@ -318,11 +363,13 @@ PUL_PLUGIN_DECL void Entity_EntityUpdate(
 
 
       // TODO fix this
-      particle.origin += particle.velocity;
-      animation.instance.origin += particle.velocity;
+      if (!particle.asleep) {
+        particle.origin += particle.velocity;
+        animation.instance.origin += particle.velocity;
 
-      animation.instance.pieceToState["particle"].angle =
-        std::atan2(particle.velocity.x, particle.velocity.y);
+        animation.instance.PieceState(::Piece::Particle).angle =
+          std::atan2(particle.velocity.x, particle.velocity.y);
+      }
 
       if (destroyInstance) {
 
@@ -356,7 +403,6 @@ PUL_PLUGIN_DECL void Entity_EntityUpdate(
           );
         }
 
-        animation.instance = {};
         registry.destroy(entity);
       }
     }
@@ -387,12 +433,11 @@ PUL_PLUGIN_DECL void Entity_EntityUpdate(
         particle.origin += particle.velocity;
         animation.instance.origin += particle.velocity;
 
-        animation.instance.pieceToState["particle"].angle =
+        animation.instance.PieceState(::Piece::Particle).angle =
           std::atan2(particle.velocity.x, particle.velocity.y);
       }
 
-      if (animation.instance.pieceToState["particle"].animationFinished) {
-        animation.instance = {};
+      if (animation.instance.PieceState(::Piece::Particle).animationFinished) {
         registry.destroy(entity);
       }
     }
@@ -417,12 +462,14 @@ PUL_PLUGIN_DECL void Entity_EntityUpdate(
         }
       }
 
-      animation.instance.pieceToState["pickups"].visible = pickup.spawned;
+      animation.instance.PieceState(::Piece::Pickups).visible = pickup.spawned;
       if (
-          animation.instance.pieceToState.find("pickup-bg")
-       != animation.instance.pieceToState.end()
+        auto const bgIdx =
+          animation.instance.animator
+            ->gameplayPieceIndices[Idx(::Piece::PickupBg)];
+        bgIdx != -1ul
       ) {
-        animation.instance.pieceToState["pickup-bg"].visible = pickup.spawned;
+        animation.instance.pieceToState[bgIdx].visible = pickup.spawned;
       }
 
       animation.instance.origin = pickup.origin;
@@ -506,6 +553,9 @@ PUL_PLUGIN_DECL void Entity_EntityUpdate(
       , view.get<pul::animation::ComponentInstance>(entity)
       , damageable
       );
+
+      // keep later queries of this tick from seeing the old hitbox
+      plugin.physics.EntityBroadphaseUpdate(scene, entity);
     }
   }
 
@@ -536,6 +586,8 @@ PUL_PLUGIN_DECL void Entity_EntityUpdate(
       , damageable
       );
 
+      plugin.physics.EntityBroadphaseUpdate(scene, entity);
+
       // -- tracking camera
       // center camera on this
       glm::vec2 L = scene.PlayerController().current.lookOffset;
@@ -578,7 +630,7 @@ PUL_PLUGIN_DECL void Entity_EntityUpdate(
 
       auto const & playerAnim = *projectile.playerAnimation;
       auto const & weaponState =
-        playerAnim.pieceToState.at("weapon-placeholder");
+        playerAnim.PieceState(::Piece::WeaponPlaceholder);
       auto const & weaponMatrix = weaponState.cachedLocalSkeletalMatrix;
 
       plugin
@@ -641,11 +693,11 @@ PUL_PLUGIN_DECL void Entity_EntityUpdate(
         );
 
         animationInstance
-          .pieceToState["particle"]
+          .PieceState(::Piece::Particle)
           .Apply(emitter.animationInstance.animator->label.c_str(), true);
 
-        animationInstance.pieceToState["particle"].angle
-          = animation.instance.pieceToState["particle"].angle;
+        animationInstance.PieceState(::Piece::Particle).angle
+          = animation.instance.PieceState(::Piece::Particle).angle;
 
         animationInstance.origin = animation.instance.origin;
 
@@ -671,6 +723,16 @@ PUL_PLUGIN_DECL void Entity_UiRender(pul::core::SceneBundle & scene) {
 
   ImGui::Begin("Entity");
   ImGui::Checkbox("allow bot to move around", &::botPlays);
+
+  { // -- grenade sleep
+    auto view = registry.view<pul::core::ComponentParticleGrenade>();
+    size_t asleep = 0ul;
+    for (auto entity : view) {
+      asleep += view.get<pul::core::ComponentParticleGrenade>(entity).asleep;
+    }
+    pul::imgui::Text("grenades {} ({} asleep)", view.size(), asleep);
+  }
+
   if (ImGui::Button("give all weapons")) {
     auto view = registry.view<pul::core::ComponentPlayer>();
     for (auto & entity : view) {
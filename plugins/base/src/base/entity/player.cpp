@@ -19,6 +19,8 @@
 #include <imgui/imgui.hpp>
 
 namespace {
+  using Piece = pul::animation::GameplayPiece;
+
   int32_t maxAirDashes = 3u;
   float inputRunAccelTarget = 5.0f;
   float inputRunAccelTime = 1.5f;
@@ -275,7 +277,10 @@ void PlayerCheckPickups(
 
     auto const pickupOrigin =
       glm::vec2(
-        animation.instance.pieceToState["pickups"].cachedLocalSkeletalMatrix
+        animation
+          .instance
+          .PieceState(::Piece::Pickups)
+          .cachedLocalSkeletalMatrix
       * glm::vec3(pickup.origin, 1.0f)
       )
     ;
@@ -334,173 +339,113 @@ void UpdatePlayerPhysics(
   // if no velocity do nothing
   if (player.velocity == glm::vec2(0.0f)) { return; }
 
-  // have a "diamond" around player to validate its position;
-  // first forward pick points, clamping player origin based off
-  // the closest intersection
-
-  // then apply connect points to clamp the player off from the environment
-  // order:
-  //      0      *
-  //     / \    1  4
-  //    1   3  *    *
-  //     \ /    2  3
-  //      2      *
-
-  std::array<glm::vec2, 4> constexpr pickPoints = {
-    glm::vec2(0.0f, -48.0f)
-  , glm::vec2(-10.0f, -22.0f)
-  , glm::vec2(0.0f, -4.0f)
-  , glm::vec2(+10.0f, -22.0f)
-  };
+  // collision body of the player relative to its origin, the feet are
+  // slightly above the origin
+  glm::vec2 constexpr bodyOffset = glm::vec2(0.0f, -26.0f);
+  glm::vec2 constexpr bodyDimensions = glm::vec2(20.0f, 44.0f);
 
-  {
-    auto wallPoint =
+  { // wall cling, left & right
+    std::array<glm::vec2, 2> constexpr wallClingOffsets = {
+      glm::vec2(-13.0f, -22.0f)
+    , glm::vec2(+13.0f, -22.0f)
+    };
+
+    std::array<pul::physics::IntersectorPoint, 2> const wallPoints = {
       pul::physics::IntersectorPoint{
-        glm::round(pickPoints[1] + playerOrigin - glm::vec2(3.0f, 0.0f))
+        glm::round(wallClingOffsets[0] + playerOrigin)
       }
-    ;
+    , pul::physics::IntersectorPoint{
+        glm::round(wallClingOffsets[1] + playerOrigin)
+      }
+    };
 
-    pul::physics::IntersectionResults results;
-    player.wallClingLeft =
-      plugin.physics.IntersectionPoint(scene, wallPoint, results);
+    std::array<pul::physics::IntersectionResults, 2> wallResults;
+    plugin.physics.IntersectionPointBatch(
+      scene, wallPoints, wallResults, pul::core::CollisionChannel::Player
+    );
+
+    player.wallClingLeft = wallResults[0].collision;
+    player.wallClingRight = wallResults[1].collision;
 
     if (player.wallClingLeft)
       { player.velocity.x = glm::max(player.velocity.x, 0.0f); }
 
-    if (player.grounded)
-      { player.wallClingLeft = false; }
-  }
-
-  {
-    auto wallPoint =
-      pul::physics::IntersectorPoint{
-        glm::round(pickPoints[3] + playerOrigin + glm::vec2(3.0f, 0.0f))
-      }
-    ;
-
-    pul::physics::IntersectionResults results;
-    player.wallClingRight =
-      plugin.physics.IntersectionPoint(scene, wallPoint, results);
     if (player.wallClingRight)
       { player.velocity.x = glm::min(player.velocity.x, 0.0f); }
 
-    if (player.grounded)
-      { player.wallClingRight = false; }
+    if (player.grounded) {
+      player.wallClingLeft = false;
+      player.wallClingRight = false;
+    }
   }
 
-  pul::physics::IntersectionResults static pointResults;
-  size_t closestIntersection = -1ul;
+  pul::physics::IntersectorAabb body;
+  body.origin = playerOrigin + bodyOffset;
+  body.dimensions = bodyDimensions;
+  body.velocity = player.velocity;
 
-  for (size_t i = 0; i < pickPoints.size(); ++ i) {
-    auto pointRay =
-      pul::physics::IntersectorRay::Construct(
-        glm::round(pickPoints[i] + playerOrigin)
-      , glm::round(pickPoints[i] + playerOrigin + glm::vec2(player.velocity))
-      );
-    pul::physics::IntersectionResults static tempPointResults;
-    plugin.physics.IntersectionRaycast(scene, pointRay, tempPointResults);
-
-    // TODO pick shortest length
-    if (tempPointResults.collision) {
-      closestIntersection = i;
-      pointResults = std::move(tempPointResults);
-    }
+  pul::physics::AabbIntersectionResults results;
+  if (
+    !plugin.physics.IntersectionAabb(
+      scene, body, results, pul::core::CollisionChannel::Player
+    )
+  ) {
+    playerOrigin += player.velocity;
+    return;
   }
 
-  if (closestIntersection == -1ul) {
-    playerOrigin += player.velocity;
-  } else {
-    glm::vec2 intersectionNormal = glm::vec2(0.0f);
-
-    { // calculate normal (TODO this should be precomputed)
-      for (auto point : std::vector<glm::vec2>{
-        { -1.0f, -1.0f }, { +0.0f, -1.0f }, { +1.0f, -1.0f }
-      , { -1.0f, +0.0f },                   { +1.0f, +0.0f }
-      , { -1.0f, +1.0f }, { +0.0f, +1.0f }, { +1.0f, +1.0f }
-      }) {
-        auto pointInt =
-          pul::physics::IntersectorPoint{
-            glm::i32vec2(glm::vec2(pointResults.origin) + point)
-          };
-        if (
-          pul::physics::IntersectionResults pointResult;
-          plugin.physics.IntersectionPoint(scene, pointInt, pointResult)
-        ) {
-          intersectionNormal += point;
-        }
-      }
-      if (intersectionNormal  == glm::vec2(0.0)) {
-        player.velocity = glm::vec2(0.01f);
-        intersectionNormal = glm::vec2(1.0f);
-      }
+  // respond to the surface rather than the box face that was hit, so that
+  // slopes deflect the player; the contact normal is always valid though
+  glm::vec2 intersectionNormal = results.surfaceNormal;
+  if (intersectionNormal == glm::vec2(0.0f))
+    { intersectionNormal = results.normal; }
 
-      intersectionNormal = glm::normalize(intersectionNormal);
-    }
+  spdlog::debug("normal: {}", intersectionNormal);
 
-    spdlog::debug("normal: {}", intersectionNormal);
+  // -- the rest of the step slides along the contact; the slide velocity is
+  //    only what remains of the step after the time of impact, and is swept
+  //    again so that the slide stops at whatever it runs into next
+  body.origin = results.origin;
+  body.velocity = results.slideVelocity;
 
-    glm::vec2 const targetDirection = 
-      glm::reflect(glm::normalize(player.velocity), -intersectionNormal);
+  pul::physics::AabbIntersectionResults slideResults;
+  plugin.physics.IntersectionAabb(
+    scene, body, slideResults, pul::core::CollisionChannel::Player
+  );
 
-    if (player.jumping && player.hasReleasedJump) {
-      player.storedVelocity =
-          targetDirection
-        * glm::length(player.storedVelocity)
-      ;
-    }
+  // -- the velocity of the next steps still deflects off the surface
+  glm::vec2 const targetDirection =
+    glm::reflect(glm::normalize(player.velocity), -intersectionNormal);
 
-    player.velocity =
-      targetDirection
-    * glm::length(player.velocity)
+  if (player.jumping && player.hasReleasedJump) {
+    player.storedVelocity =
+        targetDirection
+      * glm::length(player.storedVelocity)
     ;
+  }
 
-    if (
-        intersectionNormal == glm::vec2(0.0f, -1.0f)
-     || intersectionNormal == glm::vec2(0.0f, 1.0f)
-    ) {
-      player.velocity.y = 0.0f;
-      player.storedVelocity.y = 0.0f;
-    } else if (
-        intersectionNormal == glm::vec2(1.0f, 0.0f)
-     || intersectionNormal == glm::vec2(-1.0f, 0.0f)
-    ) {
-      player.velocity.x = 0.0f;
-      player.storedVelocity.x = 0.0f;
-    } else {
-      player.velocity *= 0.5f;
-    }
+  player.velocity =
+    targetDirection
+  * glm::length(player.velocity)
+  ;
 
-    playerOrigin =
-      glm::vec2(pointResults.origin) - pickPoints[closestIntersection]
-    - intersectionNormal
-    ;
+  if (
+      intersectionNormal == glm::vec2(0.0f, -1.0f)
+   || intersectionNormal == glm::vec2(0.0f, 1.0f)
+  ) {
+    player.velocity.y = 0.0f;
+    player.storedVelocity.y = 0.0f;
+  } else if (
+      intersectionNormal == glm::vec2(1.0f, 0.0f)
+   || intersectionNormal == glm::vec2(-1.0f, 0.0f)
+  ) {
+    player.velocity.x = 0.0f;
+    player.storedVelocity.x = 0.0f;
+  } else {
+    player.velocity *= 0.5f;
   }
 
-  // now apply the border
-  //      0      *
-  //     / \    1  4
-  //    1   3  *    * <<<
-  //     \ /    2  3
-  //      2      *
-
-  /* for (int i = 0; i < 4; ++ i) { */
-  /*   glm::vec2 const point0 = pickPoints[i], point1 = pickPoints[(i+1)%4]; */
-  /*   auto borderRay = */
-  /*     pul::physics::IntersectorRay::Construct( */
-  /*       glm::round(point0 + playerOrigin) */
-  /*     , glm::round(point1 + playerOrigin) */
-  /*     ); */
-  /*   pul::physics::IntersectionResults borderResults; */
-  /*   plugin.physics.IntersectionRaycast(scene, borderRay, borderResults); */
-
-  /*   if (borderResults.collision) { */
-  /*     // get the origin of the intersection in releation to center of player */
-  /*     glm::vec2 origin = */
-  /*       glm::vec2(borderResults.origin) - playerOrigin - glm::vec2(0.0f, 32.0f); */
-
-  /*     playerOrigin -= origin; */
-  /*   } */
-  /* } */
+  playerOrigin = slideResults.origin - bodyOffset - intersectionNormal;
 }
 
 void UpdatePlayerWeapon(
@@ -531,11 +476,11 @@ void UpdatePlayerWeapon(
   auto const & weaponMatrix =
     playerAnim
       .instance
-      .pieceToState["weapon-placeholder"]
+      .PieceState(::Piece::WeaponPlaceholder)
       .cachedLocalSkeletalMatrix
   ;
 
-  bool const weaponFlip = playerAnim.instance.pieceToState["legs"].flip;
+  bool const weaponFlip = playerAnim.instance.PieceState(::Piece::Legs).flip;
 
   if (weapon.cooldown > 0.0f) {
     weapon.cooldown -= pul::util::MsPerFrame;
@@ -786,7 +731,10 @@ void plugin::entity::UpdatePlayer(
     pul::physics::IntersectorPoint point;
     point.origin = playerOrigin + glm::vec2(0.0f, -3.0f);
     pul::physics::IntersectionResults results;
-    player.grounded = plugin.physics.IntersectionPoint(scene, point, results);
+    player.grounded =
+      plugin.physics.IntersectionPoint(
+        scene, point, results, pul::core::CollisionChannel::Player
+      );
   }
 
   bool const frameStartGrounded = player.grounded;
@@ -826,8 +774,8 @@ void plugin::entity::UpdatePlayer(
 
     // -- process crouching
     player.crouching = controller.crouch;
-    playerAnim.instance.pieceToState["legs"].angle = 0.0f;
-    playerAnim.instance.pieceToState["body"].angle = 0.0f;
+    playerAnim.instance.PieceState(::Piece::Legs).angle = 0.0f;
+    playerAnim.instance.PieceState(::Piece::Body).angle = 0.0f;
 
     // if the player is crouch sliding, player remains crouched until the
     // animation is finished, the velocity is below crouch target, or the
@@ -836,7 +784,7 @@ void plugin::entity::UpdatePlayer(
         player.crouchSliding
      && !player.jumping
      && glm::abs(player.velocity.x) >= inputCrouchAccelTarget
-     && !playerAnim.instance.pieceToState["legs"].animationFinished
+     && !playerAnim.instance.PieceState(::Piece::Legs).animationFinished
     ) {
       player.crouching = true;
     }
@@ -1151,10 +1099,14 @@ void plugin::entity::UpdatePlayer(
 
   { // -- apply animations
 
-    // -- set leg animation
-    auto & legInfo = playerAnim.instance.pieceToState["legs"];
-    auto & bodyInfo = playerAnim.instance.pieceToState["body"];
+    // -- piece states, looked up once for the whole update
+    auto & legInfo      = playerAnim.instance.PieceState(::Piece::Legs);
+    auto & bodyInfo     = playerAnim.instance.PieceState(::Piece::Body);
+    auto & armBackInfo  = playerAnim.instance.PieceState(::Piece::ArmBack);
+    auto & armFrontInfo = playerAnim.instance.PieceState(::Piece::ArmFront);
+    auto & headInfo     = playerAnim.instance.PieceState(::Piece::Head);
 
+    // -- set leg animation
     if (player.grounded) { // grounded animations
       if (!player.crouchSliding) {
         bodyInfo.Apply("center");
@@ -1163,9 +1115,8 @@ void plugin::entity::UpdatePlayer(
 
       if (!player.crouching && (!prevGrounded || player.landing)) {
         player.landing = true;
-        auto & stateInfo = playerAnim.instance.pieceToState["legs"];
-        stateInfo.Apply("landing");
-        if (stateInfo.animationFinished) { player.landing = false; }
+        legInfo.Apply("landing");
+        if (legInfo.animationFinished) { player.landing = false; }
       } else {
         // check walk/run animation turns before applying stand/walk/run
         bool const applyTurning = false;
@@ -1178,9 +1129,9 @@ void plugin::entity::UpdatePlayer(
         bool const crouching = player.crouching && moving;
         bool const walking = controller.walk && !player.crouching && moving;
 
-        if (legInfo.label == "run-turn") {
+        if (legInfo.Label() == "run-turn") {
           if (legInfo.animationFinished) { legInfo.Apply("run"); }
-        } else if (legInfo.label == "walk-turn") {
+        } else if (legInfo.Label() == "walk-turn") {
           if (legInfo.animationFinished) { legInfo.Apply("walk"); }
         } else if (walking && velocityXAbs <= inputWalkAccelTarget) {
           legInfo.Apply(applyTurning ? "walk-turn" : "walk");
@@ -1210,37 +1161,31 @@ void plugin::entity::UpdatePlayer(
       }
     } else { // air animations
 
-      playerAnim.instance.pieceToState["body"].Apply("center");
+      bodyInfo.Apply("center");
 
       if (frameVerticalJump) {
-        playerAnim.instance.pieceToState["legs"].Apply("jump-high", true);
+        legInfo.Apply("jump-high", true);
       } else if (frameHorizontalJump) {
         static bool swap = false;
         swap ^= 1;
-        playerAnim
-          .instance.pieceToState["legs"]
-          .Apply(swap ? "jump-strafe-0" : "jump-strafe-1");
+        legInfo.Apply(swap ? "jump-strafe-0" : "jump-strafe-1");
       } else if (frameVerticalDash) {
-        playerAnim.instance.pieceToState["legs"].Apply("dash-vertical");
+        legInfo.Apply("dash-vertical");
       } else if (frameHorizontalDash) {
         static bool swap = false;
         swap ^= 1;
-        playerAnim
-          .instance.pieceToState["legs"]
-          .Apply(swap ? "dash-horizontal-0" : "dash-horizontal-1");
+        legInfo.Apply(swap ? "dash-horizontal-0" : "dash-horizontal-1");
       } else if (frameWalljump) {
         static bool swap = false;
         swap ^= 1;
-        playerAnim
-          .instance.pieceToState["legs"]
-          .Apply(swap ? "walljump-0" : "walljump-1");
+        legInfo.Apply(swap ? "walljump-0" : "walljump-1");
       } else if (prevGrounded) {
         // logically can only have falled down
-        playerAnim.instance.pieceToState["legs"].Apply("air-idle");
+        legInfo.Apply("air-idle");
       } else {
-        if (legInfo.label == "dash-vertical" && legInfo.animationFinished) {
+        if (legInfo.Label() == "dash-vertical" && legInfo.animationFinished) {
           // switch to air idle
-          playerAnim.instance.pieceToState["legs"].Apply("air-idle");
+          legInfo.Apply("air-idle");
         }
       }
     }
@@ -1249,39 +1194,41 @@ void plugin::entity::UpdatePlayer(
       pul::core::weaponInfo[Idx(player.inventory.currentWeapon)];
 
     // -- arm animation
-    bool playerDirFlip = playerAnim.instance.pieceToState["legs"].flip;
+    bool playerDirFlip = legInfo.flip;
     switch (currentWeaponInfo.requiredHands) {
       case 0:
         if (player.grounded) {
           if (controller.crouch) {
-            playerAnim.instance.pieceToState["arm-back"].Apply("alarmed");
-            playerAnim.instance.pieceToState["arm-front"].Apply("alarmed");
+            armBackInfo.Apply("alarmed");
+            armFrontInfo.Apply("alarmed");
           }
-          else if (legInfo.label == "walk" || legInfo.label == "walk-turn") {
-            playerAnim.instance.pieceToState["arm-back"].Apply("unequip-walk");
-            playerAnim.instance.pieceToState["arm-front"].Apply("unequip-walk");
+          else if (
+            legInfo.Label() == "walk" || legInfo.Label() == "walk-turn"
+          ) {
+            armBackInfo.Apply("unequip-walk");
+            armFrontInfo.Apply("unequip-walk");
           }
-          else if (legInfo.label == "run" || legInfo.label == "run-turn") {
-            playerAnim.instance.pieceToState["arm-back"].Apply("unequip-run");
-            playerAnim.instance.pieceToState["arm-front"].Apply("unequip-run");
+          else if (legInfo.Label() == "run" || legInfo.Label() == "run-turn") {
+            armBackInfo.Apply("unequip-run");
+            armFrontInfo.Apply("unequip-run");
           } else {
-            playerAnim.instance.pieceToState["arm-back"].Apply("alarmed");
-            playerAnim.instance.pieceToState["arm-front"].Apply("alarmed");
+            armBackInfo.Apply("alarmed");
+            armFrontInfo.Apply("alarmed");
           }
         } else {
-          playerAnim.instance.pieceToState["arm-back"].Apply("alarmed");
-          playerAnim.instance.pieceToState["arm-front"].Apply("alarmed");
+          armBackInfo.Apply("alarmed");
+          armFrontInfo.Apply("alarmed");
         }
       break;
       case 1:
         if (playerDirFlip)
-          playerAnim.instance.pieceToState["arm-back"].Apply("equip-1H");
+          armBackInfo.Apply("equip-1H");
         else
-          playerAnim.instance.pieceToState["arm-front"].Apply("equip-1H");
+          armFrontInfo.Apply("equip-1H");
       break;
       case 2:
-        playerAnim.instance.pieceToState["arm-back"].Apply("equip-2H");
-        playerAnim.instance.pieceToState["arm-front"].Apply("equip-2H");
+        armBackInfo.Apply("equip-2H");
+        armFrontInfo.Apply("equip-2H");
       break;
     }
 
@@ -1298,19 +1245,16 @@ void plugin::entity::UpdatePlayer(
       playerDirFlip = false;
     }
 
-    playerAnim.instance.pieceToState["legs"].flip = playerDirFlip;
+    legInfo.flip = playerDirFlip;
 
     float const angle =
       std::atan2(controller.lookDirection.x, controller.lookDirection.y);
     player.lookAtAngle = angle;
     player.flip = playerDirFlip;
 
-    playerAnim.instance.pieceToState["arm-back"].angle
-      = playerAnim.instance.pieceToState["arm-front"].angle
-      = angle
-    ;
+    armBackInfo.angle = armFrontInfo.angle = angle;
 
-    playerAnim.instance.pieceToState["head"].angle = angle;
+    headInfo.angle = angle;
 
     playerAnim.instance.origin = playerOrigin;
 
@@ -1318,7 +1262,8 @@ void plugin::entity::UpdatePlayer(
     // get the hand position
     {
       plugin.animation.UpdateCache(playerAnim.instance);
-      auto & handState = playerAnim.instance.pieceToState["weapon-placeholder"];
+      auto & handState =
+        playerAnim.instance.PieceState(::Piece::WeaponPlaceholder);
 
       char const * weaponStr = ToStr(player.inventory.currentWeapon);
 
@@ -1331,14 +1276,15 @@ void plugin::entity::UpdatePlayer(
       weaponAnimation.visible =
         player.inventory.currentWeapon != pul::core::WeaponType::Unarmed;
 
-      auto & weaponState = weaponAnimation.pieceToState["weapons"];
+      auto & weaponState = weaponAnimation.PieceState(::Piece::Weapons);
 
       weaponState.Apply(weaponStr);
 
       weaponAnimation.origin = playerAnim.instance.origin;
 
-      weaponState.angle = playerAnim.instance.pieceToState["arm-front"].angle;
-      weaponState.flip = playerAnim.instance.pieceToState["legs"].flip;
+      weaponState.angle =
+        playerAnim.instance.PieceState(::Piece::ArmFront).angle;
+      weaponState.flip = playerAnim.instance.PieceState(::Piece::Legs).flip;
 
       plugin.animation.UpdateCacheWithPrecalculatedMatrix(
         weaponAnimation, handState.cachedLocalSkeletalMatrix
@@ -1359,9 +1305,9 @@ void plugin::entity::UpdatePlayer(
   audioSystem.playerDashed |= frameHorizontalDash || frameVerticalDash;
   audioSystem.playerTaunted |= controller.taunt && !controllerPrev.taunt;
 
-  auto & legInfo = playerAnim.instance.pieceToState["legs"];
+  auto & legInfo = playerAnim.instance.PieceState(::Piece::Legs);
 
-  if (player.grounded && legInfo.label == "crouch-walk") {
+  if (player.grounded && legInfo.Label() == "crouch-walk") {
     static size_t prevComp = 0;
     audioSystem.playerStepped |=
         (prevComp % 5 != 0) && legInfo.componentIt % 5 == 0
@@ -1370,7 +1316,7 @@ void plugin::entity::UpdatePlayer(
     prevComp = legInfo.componentIt;
   }
 
-  if (player.grounded && legInfo.label == "walk") {
+  if (player.grounded && legInfo.Label() == "walk") {
     static size_t prevComp = 0;
     audioSystem.playerStepped |=
         (prevComp % 3 != 0) && legInfo.componentIt % 3 == 0
@@ -1379,7 +1325,7 @@ void plugin::entity::UpdatePlayer(
     prevComp = legInfo.componentIt;
   }
 
-  if (player.grounded && legInfo.label == "run") {
+  if (player.grounded && legInfo.Label() == "run") {
     static size_t prevComp = 0;
     audioSystem.playerStepped |=
         (prevComp % 3 != 0) && legInfo.componentIt % 3 == 0
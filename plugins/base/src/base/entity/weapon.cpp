@@ -25,6 +25,8 @@
 
 namespace {
 
+using Piece = pul::animation::GameplayPiece;
+
 struct ComponentZeusStingerSecondary {};
 struct ComponentBadFetusSecondary {};
 
@@ -43,7 +45,7 @@ void CreateBadFetusLinkedBeam(
 
   auto const & weaponState =
     playerAnim
-      .pieceToState["weapon-placeholder"];
+      .PieceState(::Piece::WeaponPlaceholder);
   auto const & weaponMatrix = weaponState.cachedLocalSkeletalMatrix;
 
   namespace config = plugin::config::badFetus::combo;
@@ -58,7 +60,7 @@ void CreateBadFetusLinkedBeam(
     plugin.animation.ConstructInstance(
       scene, instance, scene.AnimationSystem(), "bad-fetus-link-muzzle-flash"
     );
-    auto & state = instance.pieceToState["particle"];
+    auto & state = instance.PieceState(::Piece::Particle);
     state.Apply("bad-fetus-link-muzzle-flash", true);
     state.angle = player.lookAtAngle;
     state.flip = weaponState.flip;
@@ -84,7 +86,7 @@ void CreateBadFetusLinkedBeam(
       scene, instance, scene.AnimationSystem()
     , "bad-fetus-linked-ball-projectile"
     );
-    auto & state = instance.pieceToState["particle"];
+    auto & state = instance.PieceState(::Piece::Particle);
     state.Apply("bad-fetus-linked-ball-projectile", true);
     state.angle = 0.0f;
     state.flip = false;
@@ -105,7 +107,7 @@ void CreateBadFetusLinkedBeam(
       scene, instance, scene.AnimationSystem()
     , "bad-fetus-link-beam"
     );
-    auto & state = instance.pieceToState["particle"];
+    auto & state = instance.PieceState(::Piece::Particle);
     state.Apply("bad-fetus-link-beam", true);
     instance.origin = playerOrigin + glm::vec2(0.0f, 28.0f);
     state.flip = weaponState.flip;
@@ -154,7 +156,7 @@ void CreateBadFetusLinkedBeam(
                 scene, instance, scene.AnimationSystem()
               , "bad-fetus-linked-ball-projectile"
               );
-              auto & state = instance.pieceToState["particle"];
+              auto & state = instance.PieceState(::Piece::Particle);
               state.Apply("bad-fetus-linked-ball-projectile", true);
               state.angle = 0.0f;
               state.flip = false;
@@ -175,7 +177,7 @@ void CreateBadFetusLinkedBeam(
 
                 particle
                   .animationInstance
-                  .pieceToState["particle"]
+                  .PieceState(::Piece::Particle)
                   .Apply("bad-fetus-explosion", true);
 
                 particle.origin = animComponent.instance.origin;
@@ -210,13 +212,13 @@ void CreateBadFetusLinkedBeam(
         // -- update animation origin/direction
         auto const & weaponState =
           playerAnim
-            .pieceToState["weapon-placeholder"];
+            .PieceState(::Piece::WeaponPlaceholder);
 
-        bool const weaponFlip = playerAnim.pieceToState["legs"].flip;
+        bool const weaponFlip = playerAnim.PieceState(::Piece::Legs).flip;
 
         animInstance.origin = playerOrigin + glm::vec2(0.0f, 28.0f);
 
-        auto & animState = animInstance.pieceToState["particle"];
+        auto & animState = animInstance.PieceState(::Piece::Particle);
         animState.flip = weaponFlip;
 
         auto const & weaponMatrix = weaponState.cachedLocalSkeletalMatrix;
@@ -249,7 +251,9 @@ void CreateBadFetusLinkedBeam(
           );
         if (
           pul::physics::IntersectionResults resultsBeam;
-          plugin.physics.IntersectionRaycast(scene, beamRay, resultsBeam)
+          plugin.physics.IntersectionRaycast(
+            scene, beamRay, resultsBeam, pul::core::CollisionChannel::Projectile
+          )
         ) {
           intersection = true;
           endOrigin = resultsBeam.origin;
@@ -339,7 +343,7 @@ void GrannibalMuzzleTrail(
   plugin.animation.ConstructInstance(
     scene, instance, scene.AnimationSystem(), "grannibal-fire"
   );
-  auto & state = instance.pieceToState["particle"];
+  auto & state = instance.PieceState(::Piece::Particle);
   state.Apply("grannibal-fire", true);
   state.angle = 0.0f;
   state.flip = flip;
@@ -497,7 +501,7 @@ void plugin::entity::FireVolniasPrimary(
     plugin.animation.ConstructInstance(
       scene, instance, scene.AnimationSystem(), "volnias-fire"
     );
-    auto & state = instance.pieceToState["particle"];
+    auto & state = instance.PieceState(::Piece::Particle);
     state.Apply("volnias-fire", true);
     state.angle = angle;
     state.flip = flip;
@@ -518,7 +522,7 @@ void plugin::entity::FireVolniasPrimary(
     plugin.animation.ConstructInstance(
       scene, instance, scene.AnimationSystem(), "volnias-projectile"
     );
-    auto & state = instance.pieceToState["particle"];
+    auto & state = instance.PieceState(::Piece::Particle);
     state.Apply("volnias-projectile", true);
     state.angle = angle;
     state.flip = flip;
@@ -552,7 +556,7 @@ void plugin::entity::FireVolniasPrimary(
 
     exploder
       .animationInstance
-      .pieceToState["particle"].Apply("volnias-hit", true);
+      .PieceState(::Piece::Particle).Apply("volnias-hit", true);
 
     exploder.audioTrigger = &scene.AudioSystem().volniasHit;
 
@@ -664,7 +668,7 @@ void plugin::entity::FireGrannibalPrimary(
     plugin.animation.ConstructInstance(
       scene, instance, scene.AnimationSystem(), "grannibal-projectile"
     );
-    auto & state = instance.pieceToState["particle"];
+    auto & state = instance.PieceState(::Piece::Particle);
     state.Apply("grannibal-projectile", true);
     state.angle = angle;
     state.flip = flip;
@@ -683,7 +687,7 @@ void plugin::entity::FireGrannibalPrimary(
 
       emitter
         .animationInstance
-        .pieceToState["particle"]
+        .PieceState(::Piece::Particle)
         .Apply("grannibal-primary-projectile-trail", true);
 
       // -- timer
@@ -722,7 +726,7 @@ void plugin::entity::FireGrannibalPrimary(
 
     exploder
       .animationInstance
-      .pieceToState["particle"].Apply("grannibal-hit", true);
+      .PieceState(::Piece::Particle).Apply("grannibal-hit", true);
 
     registry.emplace<pul::core::ComponentParticleExploder>(
       grannibalProjectileEntity, std::move(exploder)
@@ -751,7 +755,7 @@ void plugin::entity::FireGrannibalSecondary(
     plugin.animation.ConstructInstance(
       scene, instance, scene.AnimationSystem(), "grannibal-secondary-projectile"
     );
-    auto & state = instance.pieceToState["particle"];
+    auto & state = instance.PieceState(::Piece::Particle);
     state.Apply("grannibal-secondary-projectile", true);
     state.angle = angle;
     state.flip = flip;
@@ -769,7 +773,7 @@ void plugin::entity::FireGrannibalSecondary(
 
       emitter
         .animationInstance
-        .pieceToState["particle"]
+        .PieceState(::Piece::Particle)
         .Apply("grannibal-secondary-projectile-trail", true);
 
       // -- timer
@@ -801,7 +805,7 @@ void plugin::entity::FireGrannibalSecondary(
 
     particle
       .animationInstance
-      .pieceToState["particle"].Apply("grannibal-hit", true);
+      .PieceState(::Piece::Particle).Apply("grannibal-hit", true);
 
     particle.origin = instance.origin;
     particle.velocity = direction*config::ProjectileVelocity();
@@ -876,7 +880,7 @@ void plugin::entity::FireDopplerBeamPrimary(
     plugin.animation.ConstructInstance(
       scene, instance, scene.AnimationSystem(), "doppler-beam-fire"
     );
-    auto & state = instance.pieceToState["particle"];
+    auto & state = instance.PieceState(::Piece::Particle);
     state.Apply("doppler-beam-fire", true);
     state.angle = angle;
     state.flip = flip;
@@ -897,7 +901,7 @@ void plugin::entity::FireDopplerBeamPrimary(
     plugin.animation.ConstructInstance(
       scene, instance, scene.AnimationSystem(), "doppler-beam-projectile"
     );
-    auto & state = instance.pieceToState["particle"];
+    auto & state = instance.PieceState(::Piece::Particle);
     state.Apply("doppler-beam-projectile", true);
     state.angle = angle;
     state.flip = flip;
@@ -924,7 +928,7 @@ void plugin::entity::FireDopplerBeamPrimary(
 
       emitter
         .animationInstance
-        .pieceToState["particle"]
+        .PieceState(::Piece::Particle)
         .Apply("doppler-beam-projectile-trail", true);
 
       // -- timer
@@ -954,7 +958,7 @@ void plugin::entity::FireDopplerBeamPrimary(
 
     exploder
       .animationInstance
-      .pieceToState["particle"].Apply("doppler-beam-hit", true);
+      .PieceState(::Piece::Particle).Apply("doppler-beam-hit", true);
 
     registry.emplace<pul::core::ComponentParticleExploder>(
       dopplerBeamProjectileEntity, std::move(exploder)
@@ -1063,7 +1067,7 @@ void plugin::entity::FirePericaliyaPrimary(
     plugin.animation.ConstructInstance(
       scene, instance, scene.AnimationSystem(), "pericaliya-muzzle"
     );
-    auto & state = instance.pieceToState["particle"];
+    auto & state = instance.PieceState(::Piece::Particle);
     state.Apply("pericaliya-muzzle", true);
     state.angle = angle;
     state.flip = flip;
@@ -1084,7 +1088,7 @@ void plugin::entity::FirePericaliyaPrimary(
     plugin.animation.ConstructInstance(
       scene, instance, scene.AnimationSystem(), "pericaliya-primary-projectile"
     );
-    auto & state = instance.pieceToState["particle"];
+    auto & state = instance.PieceState(::Piece::Particle);
     state.Apply("pericaliya-primary-projectile", true);
     state.angle = angle;
     state.flip = flip;
@@ -1102,7 +1106,7 @@ void plugin::entity::FirePericaliyaPrimary(
 
       emitter
         .animationInstance
-        .pieceToState["particle"]
+        .PieceState(::Piece::Particle)
         .Apply("pericaliya-primary-projectile-trail", true);
 
       // -- timer
@@ -1155,7 +1159,8 @@ void plugin::entity::FirePericaliyaPrimary(
 
     exploder
       .animationInstance
-      .pieceToState["particle"].Apply("pericaliya-primary-explosion", true);
+      .PieceState(::Piece::Particle)
+      .Apply("pericaliya-primary-explosion", true);
 
     registry.emplace<pul::core::ComponentParticleExploder>(
       pericaliyaProjectileEntity, std::move(exploder)
@@ -1192,7 +1197,7 @@ void plugin::entity::FirePericaliyaSecondary(
       plugin.animation.ConstructInstance(
         scene, instance, scene.AnimationSystem(), "pericaliya-muzzle"
       );
-      auto & state = instance.pieceToState["particle"];
+      auto & state = instance.PieceState(::Piece::Particle);
       state.Apply("pericaliya-muzzle", true);
       state.angle = fireAngle;
       state.flip = flip;
@@ -1214,7 +1219,7 @@ void plugin::entity::FirePericaliyaSecondary(
         scene, instance, scene.AnimationSystem()
       , "pericaliya-secondary-projectile"
       );
-      auto & state = instance.pieceToState["particle"];
+      auto & state = instance.PieceState(::Piece::Particle);
       state.Apply("pericaliya-secondary-projectile", true);
       state.angle = fireAngle;
       state.flip = flip;
@@ -1232,7 +1237,7 @@ void plugin::entity::FirePericaliyaSecondary(
 
         emitter
           .animationInstance
-          .pieceToState["particle"]
+          .PieceState(::Piece::Particle)
           .Apply("pericaliya-secondary-projectile-trail", true);
 
         // -- timer
@@ -1298,7 +1303,8 @@ void plugin::entity::FirePericaliyaSecondary(
 
       exploder
         .animationInstance
-        .pieceToState["particle"].Apply("pericaliya-secondary-explosion", true);
+        .PieceState(::Piece::Particle)
+        .Apply("pericaliya-secondary-explosion", true);
 
       registry.emplace<pul::core::ComponentParticleExploder>(
         pericaliyaProjectileEntity, std::move(exploder)
@@ -1369,7 +1375,7 @@ void plugin::entity::FireZeusStingerPrimary(
       scene, animInstance, scene.AnimationSystem()
     , "zeus-stinger-primary-beam-muzzle-flash"
     );
-    auto & animState = animInstance.pieceToState["particle"];
+    auto & animState = animInstance.PieceState(::Piece::Particle);
     animState.Apply("zeus-stinger-primary-beam-muzzle-flash", true);
     animState.flip = flip;
     animInstance.origin = origin + glm::vec2(0.0f, 32.0f);
@@ -1406,7 +1412,7 @@ void plugin::entity::FireZeusStingerPrimary(
         scene, animInstance, scene.AnimationSystem()
       , "zeus-stinger-primary-beam"
       );
-      auto & animState = animInstance.pieceToState["particle"];
+      auto & animState = animInstance.PieceState(::Piece::Particle);
       animState.Apply("zeus-stinger-primary-beam", true);
 
       // -- update animation origin/direction
@@ -1460,7 +1466,9 @@ void plugin::entity::FireZeusStingerPrimary(
         );
       if (
         pul::physics::IntersectionResults resultsBeam;
-        plugin.physics.IntersectionRaycast(scene, beamRay, resultsBeam)
+        plugin.physics.IntersectionRaycast(
+          scene, beamRay, resultsBeam, pul::core::CollisionChannel::Projectile
+        )
       ) {
         intersection = true;
         endOrigin = resultsBeam.origin;
@@ -1547,7 +1555,7 @@ void plugin::entity::FireZeusStingerPrimary(
         pul::animation::ComponentInstance
       >(zeusStingerBeamEntity).instance
     ;
-    auto & animState = animInstance.pieceToState["particle"];
+    auto & animState = animInstance.PieceState(::Piece::Particle);
 
     // -- apply clipping
     float clipLength =
@@ -1571,7 +1579,7 @@ void plugin::entity::FireZeusStingerPrimary(
           pul::animation::ComponentInstance
         >(zeusStingerMuzzleEntity).instance
       ;
-      auto & muzzleAnimState = muzzleAnimInstance.pieceToState["particle"];
+      auto & muzzleAnimState = muzzleAnimInstance.PieceState(::Piece::Particle);
 
       // TODO don't hardcode
       muzzleAnimState.uvCoordWrap.x = clipLength / 128.0f;
@@ -1595,7 +1603,7 @@ void plugin::entity::FireZeusStingerPrimary(
       plugin.animation.ConstructInstance(
         scene, instance, scene.AnimationSystem(), explosionStr
       );
-      auto & state = instance.pieceToState["particle"];
+      auto & state = instance.PieceState(::Piece::Particle);
       state.Apply(explosionStr, true);
       state.angle = 0.0f;
       state.flip = flip;
@@ -1618,7 +1626,7 @@ void plugin::entity::FireZeusStingerPrimary(
         scene, animInstance, scene.AnimationSystem()
       , "zeus-stinger-scatter-beam"
       );
-      auto & animState = animInstance.pieceToState["particle"];
+      auto & animState = animInstance.PieceState(::Piece::Particle);
       animState.Apply("zeus-stinger-scatter-beam", true);
 
       // -- update animation origin/direction
@@ -1690,7 +1698,7 @@ void plugin::entity::FireZeusStingerSecondary(
         scene, instance, scene.AnimationSystem()
       , "zeus-stinger-secondary-projectile"
       );
-      auto & state = instance.pieceToState["particle"];
+      auto & state = instance.PieceState(::Piece::Particle);
       state.Apply("zeus-stinger-secondary-projectile", true);
       state.angle = angle;
       state.flip = flip;
@@ -1718,7 +1726,7 @@ void plugin::entity::FireZeusStingerSecondary(
 
       particle
         .animationInstance
-        .pieceToState["particle"]
+        .PieceState(::Piece::Particle)
         .Apply("zeus-stinger-secondary-explosion", true);
 
       particle.origin = instance.origin;
@@ -1810,7 +1818,7 @@ void plugin::entity::FireBadFetusPrimary(
     plugin.animation.ConstructInstance(
       scene, instance, scene.AnimationSystem(), "bad-fetus-primary-muzzle-flash"
     );
-    auto & state = instance.pieceToState["particle"];
+    auto & state = instance.PieceState(::Piece::Particle);
     state.Apply("bad-fetus-primary-muzzle-flash", true);
     state.angle = angle;
     state.flip = flip;
@@ -1834,7 +1842,7 @@ void plugin::entity::FireBadFetusPrimary(
       scene, instance, scene.AnimationSystem()
     , "bad-fetus-primary-beam"
     );
-    auto & state = instance.pieceToState["particle"];
+    auto & state = instance.PieceState(::Piece::Particle);
     state.Apply("bad-fetus-primary-beam", true);
     instance.origin = origin;
     state.flip = flip;
@@ -1871,13 +1879,13 @@ void plugin::entity::FireBadFetusPrimary(
         // -- update animation origin/direction
         auto const & weaponState =
           playerAnim
-            .pieceToState["weapon-placeholder"];
+            .PieceState(::Piece::WeaponPlaceholder);
 
-        bool const weaponFlip = playerAnim.pieceToState["legs"].flip;
+        bool const weaponFlip = playerAnim.PieceState(::Piece::Legs).flip;
 
         animInstance.origin = playerOrigin + glm::vec2(0.0f, 32.0f);
 
-        auto & animState = animInstance.pieceToState["particle"];
+        auto & animState = animInstance.PieceState(::Piece::Particle);
         animState.flip = weaponFlip;
 
         auto const & weaponMatrix = weaponState.cachedLocalSkeletalMatrix;
@@ -1915,7 +1923,9 @@ void plugin::entity::FireBadFetusPrimary(
           );
         if (
           pul::physics::IntersectionResults resultsBeam;
-          plugin.physics.IntersectionRaycast(scene, beamRay, resultsBeam)
+          plugin.physics.IntersectionRaycast(
+            scene, beamRay, resultsBeam, pul::core::CollisionChannel::Projectile
+          )
         ) {
           endOrigin = resultsBeam.origin;
           hasHit = true;
@@ -1969,7 +1979,7 @@ void plugin::entity::FireBadFetusPrimary(
               scene, instance, scene.AnimationSystem()
             , "bad-fetus-primary-hit-trail"
             );
-            auto & state = instance.pieceToState["particle"];
+            auto & state = instance.PieceState(::Piece::Particle);
             state.Apply("bad-fetus-primary-hit-trail", true);
 
             // origin is where we collided but a few pixels towards player
@@ -2064,7 +2074,7 @@ void plugin::entity::FireBadFetusSecondary(
     plugin.animation.ConstructInstance(
       scene, instance, scene.AnimationSystem(), "bad-fetus-primary-muzzle-flash"
     );
-    auto & state = instance.pieceToState["particle"];
+    auto & state = instance.PieceState(::Piece::Particle);
     state.Apply("bad-fetus-primary-muzzle-flash", true);
     state.angle = angle;
     state.flip = flip;
@@ -2091,7 +2101,7 @@ void plugin::entity::FireBadFetusSecondary(
       scene, instance, scene.AnimationSystem()
     , "bad-fetus-secondary-projectile"
     );
-    auto & state = instance.pieceToState["particle"];
+    auto & state = instance.PieceState(::Piece::Particle);
     state.Apply("bad-fetus-secondary-projectile", true);
     state.angle = angle;
     state.flip = flip;
@@ -2118,7 +2128,7 @@ void plugin::entity::FireBadFetusSecondary(
 
       particle
         .animationInstance
-        .pieceToState["particle"]
+        .PieceState(::Piece::Particle)
         .Apply("bad-fetus-explosion", true);
 
       particle.origin = instance.origin;
@@ -2145,7 +2155,7 @@ void plugin::entity::FireBadFetusSecondary(
 
       emitter
         .animationInstance
-        .pieceToState["particle"]
+        .PieceState(::Piece::Particle)
         .Apply("bad-fetus-secondary-projectile-trail", true);
 
       // -- timer
@@ -2293,7 +2303,7 @@ void plugin::entity::FireManshredderPrimary(
       plugin.animation.ConstructInstance(
         scene, instance, scene.AnimationSystem(), "manshredder-primary-fire"
       );
-      auto & state = instance.pieceToState["particle"];
+      auto & state = instance.PieceState(::Piece::Particle);
       state.Apply("manshredder-primary-fire", true);
       state.angle = angle;
       state.flip = flip;
@@ -2324,7 +2334,7 @@ void plugin::entity::FireManshredderPrimary(
           registry.get<pul::animation::ComponentInstance>(
             manshredderProjectileEntity
           ).instance;
-        auto & state = animation.pieceToState.at("particle");
+        auto & state = animation.PieceState(::Piece::Particle);
 
         { // update origin/animation
           animation.origin = playerOrigin + glm::vec2(0.0f, 28.0f);
@@ -2337,7 +2347,7 @@ void plugin::entity::FireManshredderPrimary(
             );
         }
 
-        if (state.label != "manshredder-primary-hit")
+        if (state.Label() != "manshredder-primary-hit")
         { // update hit
           auto ray =
             pul::physics::IntersectorRay::Construct(
@@ -2348,7 +2358,9 @@ void plugin::entity::FireManshredderPrimary(
           bool hasHit = false;
           if (
             pul::physics::IntersectionResults results;
-            plugin.physics.IntersectionRaycast(scene, ray, results)
+            plugin.physics.IntersectionRaycast(
+              scene, ray, results, pul::core::CollisionChannel::Projectile
+            )
           ) {
             hasHit = true;
             dist = glm::length(glm::vec2(results.origin) - origin);
@@ -2403,7 +2415,7 @@ void plugin::entity::FireManshredderSecondary(
     plugin.animation.ConstructInstance(
       scene, instance, scene.AnimationSystem(), "manshredder-secondary-fire"
     );
-    auto & state = instance.pieceToState["particle"];
+    auto & state = instance.PieceState(::Piece::Particle);
     state.Apply("manshredder-secondary-fire", true);
     state.angle = angle;
     state.flip = flip;
@@ -2425,7 +2437,7 @@ void plugin::entity::FireManshredderSecondary(
       scene, instance, scene.AnimationSystem()
     , "manshredder-secondary-projectile"
     );
-    auto & state = instance.pieceToState["particle"];
+    auto & state = instance.PieceState(::Piece::Particle);
     state.Apply("manshredder-secondary-projectile", true);
     state.angle = angle;
     state.flip = flip;
@@ -2443,7 +2455,7 @@ void plugin::entity::FireManshredderSecondary(
 
       emitter
         .animationInstance
-        .pieceToState["particle"]
+        .PieceState(::Piece::Particle)
         .Apply("manshredder-secondary-projectile", true);
 
       // -- timer
@@ -2484,7 +2496,7 @@ void plugin::entity::FireManshredderSecondary(
 
     exploder
       .animationInstance
-      .pieceToState["particle"].Apply("manshredder-secondary-hit", true);
+      .PieceState(::Piece::Particle).Apply("manshredder-secondary-hit", true);
 
     registry.emplace<pul::core::ComponentParticleExploder>(
       manshredderProjectileEntity, std::move(exploder)
@@ -2552,7 +2564,7 @@ void plugin::entity::FireWallbangerPrimary(
     plugin.animation.ConstructInstance(
       scene, instance, scene.AnimationSystem(), "wallbanger-primary-muzzle"
     );
-    auto & state = instance.pieceToState["particle"];
+    auto & state = instance.PieceState(::Piece::Particle);
     state.Apply("wallbanger-primary-muzzle", true);
     state.angle = angle;
     state.flip = flip;
@@ -2574,7 +2586,7 @@ void plugin::entity::FireWallbangerPrimary(
       scene, instance, scene.AnimationSystem()
     , "wallbanger-primary-projectile"
     );
-    auto & state = instance.pieceToState["particle"];
+    auto & state = instance.PieceState(::Piece::Particle);
     state.Apply("wallbanger-primary-projectile", true);
     state.angle = angle;
     state.flip = flip;
@@ -2601,7 +2613,7 @@ void plugin::entity::FireWallbangerPrimary(
 
       particle
         .animationInstance
-        .pieceToState["particle"]
+        .PieceState(::Piece::Particle)
         .Apply("wallbanger-primary-explosion", true);
 
       particle.origin = instance.origin;
@@ -2641,7 +2653,7 @@ void plugin::entity::FireWallbangerSecondary(
       scene, instance, scene.AnimationSystem()
     , "wallbanger-secondary-muzzle-big"
     );
-    auto & state = instance.pieceToState["particle"];
+    auto & state = instance.PieceState(::Piece::Particle);
     state.Apply("wallbanger-secondary-muzzle-big", true);
     state.angle = angle;
     state.flip = flip;
@@ -2667,7 +2679,7 @@ void plugin::entity::FireWallbangerSecondary(
       scene, instance, scene.AnimationSystem()
     , "wallbanger-secondary-muzzle-small"
     );
-    auto & state = instance.pieceToState["particle"];
+    auto & state = instance.PieceState(::Piece::Particle);
     state.Apply("wallbanger-secondary-muzzle-small", true);
     state.angle = angle;
     state.flip = flip;
@@ -2704,7 +2716,9 @@ void plugin::entity::FireWallbangerSecondary(
       pul::physics::IntersectorRay::Construct(beginOrigin, endOrigin);
     if (
       pul::physics::IntersectionResults resultsBeam;
-      !plugin.physics.IntersectionRaycast(scene, beamRay, resultsBeam)
+      !plugin.physics.IntersectionRaycast(
+        scene, beamRay, resultsBeam, pul::core::CollisionChannel::Projectile
+      )
     ) {
       return;
     } else {
@@ -2717,7 +2731,9 @@ void plugin::entity::FireWallbangerSecondary(
     beamRay = pul::physics::IntersectorRay::Construct(beginOrigin, endOrigin);
     if (
       pul::physics::IntersectionResults resultsBeam;
-      plugin.physics.InverseSceneIntersectionRaycast(scene, beamRay, resultsBeam)
+      plugin.physics.InverseSceneIntersectionRaycast(
+        scene, beamRay, resultsBeam, pul::core::CollisionChannel::Projectile
+      )
     ) {
       endOrigin = glm::vec2(resultsBeam.origin);
     }
@@ -2737,7 +2753,7 @@ void plugin::entity::FireWallbangerSecondary(
     plugin.animation.ConstructInstance(
       scene, instance, scene.AnimationSystem(), "wallbanger-wall-muzzle"
     );
-    auto & state = instance.pieceToState["particle"];
+    auto & state = instance.PieceState(::Piece::Particle);
     state.Apply("wallbanger-wall-muzzle", true);
     state.angle = angle;
     state.flip = flip;
@@ -2756,7 +2772,7 @@ void plugin::entity::FireWallbangerSecondary(
         scene, animInstance, scene.AnimationSystem()
       , "wallbanger-secondary-wall-beam"
       );
-      auto & animState = animInstance.pieceToState["particle"];
+      auto & animState = animInstance.PieceState(::Piece::Particle);
       animState.Apply("wallbanger-secondary-wall-beam", true);
 
       // -- update animation origin/direction
@@ -2791,7 +2807,7 @@ void plugin::entity::FireWallbangerSecondary(
       pul::animation::ComponentInstance
     >(wallbangerBeamEntity).instance
   ;
-  auto & animState = animInstance.pieceToState["particle"];
+  auto & animState = animInstance.PieceState(::Piece::Particle);
 
   // -- apply clipping
   float clipLength =
@@ -2824,7 +2840,7 @@ void plugin::entity::FireWallbangerSecondary(
     plugin.animation.ConstructInstance(
       scene, instance, scene.AnimationSystem(), explosionStr
     );
-    auto & state = instance.pieceToState["particle"];
+    auto & state = instance.PieceState(::Piece::Particle);
     state.Apply(explosionStr, true);
     state.angle = 0.0f;
     state.flip = flip;
@@ -2849,38 +2865,39 @@ plugin::entity::WeaponDamageRaycast(
   pul::physics::IntersectorRay ray;
   ray.beginOrigin = glm::i32vec2(glm::round(originBegin));
   ray.endOrigin = glm::i32vec2(glm::round(originEnd));
-  pul::physics::EntityIntersectionResults results;
 
-  plugin::entity::WeaponDamageRaycastReturnInfo ri = {};
+  // only one entity can be hit with ray (at least for now)
+  pul::physics::EntityRaycastHits hits;
+  hits.maxHits = 1ul;
 
-  // iterate thru all entity intersections, and if damageable record
-  // the damage
-  plugin.physics.EntityIntersectionRaycast(scene, ray, results);
-  for (auto & entityIntersection : results.entities) {
-    auto * damageable =
-      registry.try_get<pul::core::ComponentDamageable>(
-        std::get<1>(entityIntersection)
-      );
-    if (!damageable) { continue; }
-    if (std::get<1>(entityIntersection) == ignoredEntity) { continue; }
+  plugin::entity::WeaponDamageRaycastReturnInfo ri = {};
 
-    pul::core::DamageInfo damageInfo;
-    { // calculate damage info
-      glm::vec2 const dir = glm::normalize(originEnd - originBegin);
+  plugin.physics.EntityIntersectionRaycastNearest(
+    scene, ray, ignoredEntity, hits
+  );
+  if (!hits.Collision()) { return ri; }
 
-      damageInfo.directionForce = dir * force;
-      damageInfo.damage = damage;
-    }
+  auto const & hit = hits.hits[0];
 
-    damageable->frameDamageInfos.emplace_back(damageInfo);
+  // every hitbox entity is damageable, if that ever changes the hitbox still
+  // blocks the ray
+  auto * damageable =
+    registry.try_get<pul::core::ComponentDamageable>(hit.entity);
+  if (!damageable) { return ri; }
 
-    // only one entity can be hit with ray (at least for now)
-    ri.entity = std::get<1>(entityIntersection);
-    ri.origin = std::get<0>(entityIntersection);
+  pul::core::DamageInfo damageInfo;
+  { // calculate damage info
+    glm::vec2 const dir = glm::normalize(originEnd - originBegin);
 
-    break;
+    damageInfo.directionForce = dir * force;
+    damageInfo.damage = damage;
   }
 
+  damageable->frameDamageInfos.emplace_back(damageInfo);
+
+  ri.entity = hit.entity;
+  ri.origin = hit.origin;
+
   return ri;
 }
 
@@ -2929,6 +2946,27 @@ bool plugin::entity::WeaponDamageCircle(
     damageable->frameDamageInfos.emplace_back(damageInfo);
   }
 
+  // -- wake the grenades sleeping in the blast, explosions don't push them so
+  //    they only resume their own motion
+  auto grenades =
+    registry.view<
+      pul::core::ComponentParticleGrenade
+    , pul::animation::ComponentInstance
+    >();
+  for (auto entity : grenades) {
+    auto & grenade =
+      grenades.get<pul::core::ComponentParticleGrenade>(entity);
+    if (!grenade.asleep) { continue; }
+
+    auto const & animation =
+      grenades.get<pul::animation::ComponentInstance>(entity);
+    if (glm::length(animation.instance.origin - origin) > radius)
+      { continue; }
+
+    grenade.asleep = false;
+    grenade.restingTicks = 0u;
+  }
+
   return hasHit;
 }
 
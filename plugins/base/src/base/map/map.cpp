@@ -4,6 +4,7 @@
 #include <pulcher-core/pickup.hpp>
 #include <pulcher-core/player.hpp>
 #include <pulcher-core/scene-bundle.hpp>
+#include <pulcher-core/tiled.hpp>
 #include <pulcher-gfx/context.hpp>
 #include <pulcher-gfx/image.hpp>
 #include <pulcher-gfx/imgui.hpp>
@@ -19,21 +20,16 @@
 #include <GLFW/glfw3.h>
 #include <imgui/imgui.hpp>
 
-#include <filesystem>
-#include <fstream>
+#include <string>
 
 namespace {
 
+using Piece = pul::animation::GameplayPiece;
+
 int32_t constexpr tileDepthMin = -500, tileDepthMax = +500;
 
 size_t mapWidth, mapHeight;
 
-size_t constexpr
-  FlippedHorizontalGidFlag = 0x80000000
-, FlippedVerticalGidFlag   = 0x40000000
-, FlippedDiagonalGidFlag   = 0x20000000
-;
-
 void MapSokolInitialize() {
 }
 
@@ -45,7 +41,7 @@ struct LayerRenderable {
 
   // kept in order to do CPU tilemap processing
   std::vector<size_t> tileIds;
-  std::vector<glm::u32vec2> tileOrigins;
+  std::vector<glm::i32vec2> tileOrigins;
   std::vector<pul::core::TileOrientation> tileOrientations;
 
   sg_buffer bufferVertex;
@@ -58,6 +54,9 @@ struct LayerRenderable {
 
   int32_t depth; // tileDepthMin .. tileDepthMax
 
+  // what the tiles block, layers at the same depth are kept apart by it
+  pul::core::CollisionChannel channels;
+
   bool enabled = true;
 };
 
@@ -96,31 +95,21 @@ bool GetMapTileset(
 }
 
 void MapSokolPushTile(
-  std::string const & layer
-, uint32_t const x, uint32_t const y
-, bool const flipHorizontal
-, bool const flipVertical
-, bool const flipDiagonal
-, size_t const tileId
+  int32_t const depth
+, pul::core::CollisionChannel const channels
+, pul::core::TiledTile const & tile
 ) {
-
-  if (tileId == 0ul) { return; }
-
-  int32_t depth = 0ul;
-
-  // TODO this should not parse numbers but just assume depth based on layer
-
-  if (layer.compare(0, 13, "nonsolid-back") == 0) {
-    size_t numberIdx = layer.find_last_not_of("0123456789");
-    depth = +std::stoi(layer.substr(numberIdx+1));
-  } else if (layer.compare(0, 14, "nonsolid-front") == 0) {
-    size_t numberIdx = layer.find_last_not_of("0123456789");
-    depth = -std::stoi(layer.substr(numberIdx+1));
-  } else if (layer.compare(0, 9, "solid-all") == 0) {
-    depth = 0;
-  } else if (layer.compare(0, 9, "solid-player") == 0) {
-    depth = 0;
-  }
+  size_t const tileId = tile.gid;
+  int32_t const x = tile.origin.x, y = tile.origin.y;
+
+  bool const
+    flipHorizontal =
+      Idx(tile.orientation) & Idx(pul::core::TileOrientation::FlipHorizontal)
+  , flipVertical =
+      Idx(tile.orientation) & Idx(pul::core::TileOrientation::FlipVertical)
+  , flipDiagonal =
+      Idx(tile.orientation) & Idx(pul::core::TileOrientation::FlipDiagonal)
+  ;
 
   // locate spritesheet used and the local tile ID
   size_t spritesheetIdx = -1ul;
@@ -130,7 +119,10 @@ void MapSokolPushTile(
   // locate appropiate 'renderable'
   LayerRenderable * renderable = nullptr;
   for (auto & r : renderables) {
-    if (r.depth == depth && r.spritesheetPrimaryIdx == spritesheetIdx) {
+    if (
+        r.depth == depth && r.channels == channels
+     && r.spritesheetPrimaryIdx == spritesheetIdx
+    ) {
       renderable = &r;
       break;
     }
@@ -139,6 +131,7 @@ void MapSokolPushTile(
   if (renderable == nullptr) {
     renderables.emplace_back();
     renderables.back().depth = depth;
+    renderables.back().channels = channels;
     renderables.back().spritesheetPrimaryIdx = spritesheetIdx;
     renderable = &renderables.back();
   }
@@ -153,15 +146,9 @@ void MapSokolPushTile(
   , uvTileHeight = uvHeight / 32ul
   ;
 
-  renderable->tileOrigins.emplace_back(glm::u32vec2(x, y));
+  renderable->tileOrigins.emplace_back(glm::i32vec2(x, y));
   renderable->tileIds.emplace_back(localTileId);
-  renderable->tileOrientations.emplace_back(
-    static_cast<pul::core::TileOrientation>(
-      (flipDiagonal   ? Idx(pul::core::TileOrientation::FlipDiagonal)   : 0ul)
-    | (flipVertical   ? Idx(pul::core::TileOrientation::FlipVertical)   : 0ul)
-    | (flipHorizontal ? Idx(pul::core::TileOrientation::FlipHorizontal) : 0ul)
-    )
-  );
+  renderable->tileOrientations.emplace_back(tile.orientation);
 
   for (auto const & v
     : std::vector<std::array<float, 2>> {
@@ -333,56 +320,11 @@ void ParseLayerTile(
 , cJSON * layer
 , char const * layerLabel
 ) {
-  cJSON * chunk;
-  cJSON_ArrayForEach(
-    chunk, cJSON_GetObjectItemCaseSensitive(layer, "chunks")
-  ) {
-    auto width =
-      static_cast<uint32_t>(
-        cJSON_GetObjectItemCaseSensitive(chunk, "width")->valueint
-      );
+  int32_t const depth = pul::core::TiledLayerDepth(layerLabel);
+  auto const channels = pul::core::TiledLayerChannels(layerLabel);
 
-    auto x = cJSON_GetObjectItemCaseSensitive(chunk, "x")->valueint;
-    auto y = cJSON_GetObjectItemCaseSensitive(chunk, "y")->valueint;
-
-    size_t localItr = 0;
-
-    cJSON * gidJson;
-
-    cJSON_ArrayForEach(
-      gidJson
-    , cJSON_GetObjectItemCaseSensitive(chunk, "data")
-    ) {
-      auto gid = gidJson->valueint;
-      auto tileId =
-          gid
-        & ~(
-            FlippedHorizontalGidFlag
-          | FlippedVerticalGidFlag
-          | FlippedDiagonalGidFlag
-          )
-      ;
-
-      bool const
-        flipHorizontal = gid & ::FlippedHorizontalGidFlag
-      , flipVertical   = gid & ::FlippedVerticalGidFlag
-      , flipDiagonal   = gid & ::FlippedDiagonalGidFlag
-      ;
-
-      size_t localX = localItr % width;
-      size_t localY = localItr / width;
-
-      ::MapSokolPushTile(
-        layerLabel
-      , static_cast<uint32_t>(x + localX)
-      , static_cast<uint32_t>(y + localY)
-      , flipHorizontal, flipVertical, flipDiagonal
-      , tileId
-      );
-
-      ++ localItr;
-    }
-  }
+  for (auto const & tile : pul::core::TiledLayerTiles(layer))
+    { ::MapSokolPushTile(depth, channels, tile); }
 }
 
 void ParseLayerObject(
@@ -541,10 +483,10 @@ void ParseLayerObject(
 
       pickupAnimationInstance.origin = origin;
       pickupAnimationInstance
-        .pieceToState["pickups"].Apply(animationStatePickupStr, true);
+        .PieceState(::Piece::Pickups).Apply(animationStatePickupStr, true);
       if (applyPickupBg) {
         pickupAnimationInstance
-          .pieceToState["pickup-bg"].Apply(animationStatePickupStr, true);
+          .PieceState(::Piece::PickupBg).Apply(animationStatePickupStr, true);
       }
 
       registry.emplace<pul::animation::ComponentInstance>(
@@ -565,109 +507,38 @@ PUL_PLUGIN_DECL void Map_LoadMap(
 ) {
   spdlog::info("Loading '{}'", filename);
 
-  cJSON * map;
-  {
-    // load file
-    auto file = std::ifstream{filename};
-    if (file.eof() || !file.good()) {
-      spdlog::error("could not load map");
-      return;
-    }
-
-    auto str =
-      std::string {
-        std::istreambuf_iterator<char>(file)
-      , std::istreambuf_iterator<char>()
-      };
-
-    map = cJSON_Parse(str.c_str());
-
-    if (map == nullptr) {
-      spdlog::critical(
-        " -- failed to parse json for map; '{}'", cJSON_GetErrorPtr()
-      );
-      return;
-    }
-  }
+  cJSON * map = pul::core::LoadTiledJson(filename);
+  if (!map) { return; }
 
   ::mapWidth  = cJSON_GetObjectItemCaseSensitive(map, "width")->valueint;
   ::mapHeight = cJSON_GetObjectItemCaseSensitive(map, "height")->valueint;
 
   spdlog::info(" -- dimensions {}x{}", ::mapWidth, ::mapHeight);
 
-  ::MapSokolInitialize();
-
-  cJSON * tileset;
-  cJSON_ArrayForEach(
-    tileset, cJSON_GetObjectItemCaseSensitive(map, "tilesets")
-  ) {
-
-    cJSON * tilesetJson;
-
-    // either the file is embedded or it is externally loaded
-    if (cJSON_GetObjectItemCaseSensitive(tileset, "source")) {
-      auto tilesetFilename =
-        cJSON_GetObjectItemCaseSensitive(tileset, "source")->valuestring;
-
-      spdlog::debug("loading tileset '{}'", tilesetFilename);
-
-      // load file
-      std::filesystem::path tilesetJsonPath =
-          std::filesystem::path(filename).remove_filename() / tilesetFilename
-      ;
-
-      auto file = std::ifstream{tilesetJsonPath.string()};
-      if (file.eof() || !file.good()) {
-        spdlog::error("could not load tilest '{}'", tilesetJsonPath.string());
-        return;
-      }
-
-      auto str =
-        std::string {
-          std::istreambuf_iterator<char>(file)
-        , std::istreambuf_iterator<char>()
-        };
-
-      tilesetJson = cJSON_Parse(str.c_str());
-    } else {
-      tilesetJson = tileset;
-    }
-
-    std::filesystem::path tilesetPath =
-        std::filesystem::path(filename).remove_filename()
-      / std::filesystem::path(
-          cJSON_GetObjectItemCaseSensitive(tilesetJson, "image")->valuestring
-        );
-    ;
+  std::vector<pul::core::TiledTileset> tilesets;
+  if (!pul::core::LoadTiledTilesets(map, filename, tilesets)) {
+    cJSON_Delete(map);
+    return;
+  }
 
-    if (!std::filesystem::exists(tilesetPath)) {
-      spdlog::error(" -- invalid path for tileset");
-      continue;
-    }
+  ::MapSokolInitialize();
 
-    { // construct map tileset
-      auto image = pul::gfx::Image::Construct(tilesetPath.string().c_str());
-
-      // get plugin to load tileset
-      pul::physics::Tileset physxTileset;
-      plugins.physics.ProcessTileset(physxTileset, image);
-
-      auto tilesJson = cJSON_GetObjectItemCaseSensitive(tilesetJson, "tiles");
-      // copy tilesJson if not null
-      if (tilesJson)
-        { tilesJson = cJSON_Duplicate(tilesJson, true); }
-
-      // emplace tileset w/ spritesheet and related tilemap info
-      ::mapTilesets
-        .emplace_back(MapTileset {
-            pul::gfx::Spritesheet::Construct(image)
-          , std::move(physxTileset)
-          , tilesJson
-          , static_cast<size_t>(
-              cJSON_GetObjectItemCaseSensitive(tileset, "firstgid")->valueint
-            )
-        });
-    }
+  for (auto const & tileset : tilesets) {
+    // construct map tileset
+    auto image = pul::gfx::Image::Construct(tileset.imagePath.string().c_str());
+
+    // get plugin to load tileset
+    pul::physics::Tileset physxTileset;
+    plugins.physics.ProcessTileset(physxTileset, image);
+
+    // emplace tileset w/ spritesheet and related tilemap info
+    ::mapTilesets
+      .emplace_back(MapTileset {
+          pul::gfx::Spritesheet::Construct(image)
+        , std::move(physxTileset)
+        , tileset.jsonTiles
+        , tileset.firstGid
+      });
   }
 
   cJSON * layer;
@@ -694,8 +565,9 @@ PUL_PLUGIN_DECL void Map_LoadMap(
 
     std::vector<pul::physics::Tileset const *> tilesets;
     std::vector<std::span<size_t>> mapTileIndices;
-    std::vector<std::span<glm::u32vec2>> mapTileOrigins;
+    std::vector<std::span<glm::i32vec2>> mapTileOrigins;
     std::vector<std::span<pul::core::TileOrientation>> mapTileOrientations;
+    std::vector<pul::core::CollisionChannel> mapTileChannels;
 
     for (auto & renderable : ::renderables) {
       // only depth 0 layers can have collision
@@ -709,12 +581,14 @@ PUL_PLUGIN_DECL void Map_LoadMap(
       mapTileIndices.emplace_back(std::span(renderable.tileIds));
       mapTileOrigins.emplace_back(std::span(renderable.tileOrigins));
       mapTileOrientations.emplace_back(std::span(renderable.tileOrientations));
+      mapTileChannels.emplace_back(renderable.channels);
     }
 
     plugins
       .physics
       .LoadMapGeometry(
         tilesets, mapTileIndices, mapTileOrigins, mapTileOrientations
+      , mapTileChannels
       );
   }
 
@@ -822,14 +696,27 @@ PUL_PLUGIN_DECL void Map_UiRender(pul::core::SceneBundle & scene) {
       pul::physics::Tile const & physicsTile =
         ::mapTilesets[tileInfoTilesetIdx].physicsTileset.tiles[tileIdx];
 
+      auto const hintStr = [](pul::physics::TileIntersectAccelerationHint h) {
+        switch (h) {
+          default: return "mixed";
+          case pul::physics::TileIntersectAccelerationHint::Empty:
+            return "empty";
+          case pul::physics::TileIntersectAccelerationHint::Full:
+            return "full";
+        }
+      };
+
+      pul::imgui::Text(
+        "acceleration hint {}", hintStr(physicsTile.accelerationHint)
+      );
+
       std::string physxStr = "";
       for (size_t i = 0; i < 32*32; ++ i) {
         if (i % 32 == 0 && i > 0) {
           physxStr += "\n";
         }
 
-        physxStr +=
-          physicsTile.signedDistanceField[i%32][i/32] > 0.0f ? "#" : "-";
+        physxStr += physicsTile.Solid(glm::u32vec2(i%32, i/32)) ? "#" : "-";
       }
 
       pul::imgui::Text("{}", physxStr);
@@ -848,6 +735,8 @@ PUL_PLUGIN_DECL void Map_UiRender(pul::core::SceneBundle & scene) {
     ImGui::PushID(&renderable);
     pul::imgui::Text("draw call: {}", renderable.tileCount);
     pul::imgui::Text("depth: {}", renderable.depth);
+    if (renderable.depth == 0)
+      { pul::imgui::Text("collision: {}", ToStr(renderable.channels)); }
     pul::imgui::Text("spritesheet: {}u", renderable.spritesheetPrimaryIdx);
     ImGui::Checkbox("enabled", &renderable.enabled);
 
@@ -4,25 +4,28 @@
 #include <pulcher-gfx/context.hpp>
 #include <pulcher-gfx/image.hpp>
 #include <pulcher-gfx/imgui.hpp>
+#include <pulcher-physics/broadphase.hpp>
 #include <pulcher-physics/intersections.hpp>
 #include <pulcher-physics/tileset.hpp>
 #include <pulcher-plugin/plugin.hpp>
 #include <pulcher-util/enum.hpp>
 #include <pulcher-util/log.hpp>
-#include <pulcher-util/math.hpp>
 
 #include <entt/entt.hpp>
 #include <glad/glad.hpp>
 #include <imgui/imgui.hpp>
 
+#include <algorithm>
 #include <span>
 #include <vector>
 
 namespace {
 
-bool showPhysicsQueries = false;
 bool showHitboxes = false;
 
+// amount of the most recently recorded queries that are drawn
+int debugQueriesDrawn = 256;
+
 struct DebugRenderInfo {
   sg_buffer bufferOrigin;
   sg_buffer bufferCollision;
@@ -32,15 +35,25 @@ struct DebugRenderInfo {
 };
 
 
-constexpr size_t debugRenderMaxPoints = 1'000;
-constexpr size_t debugRenderMaxRays = 1'000;
+constexpr size_t debugRenderMaxPoints =
+  pul::physics::DebugQueries::ringCapacity;
+
+// every recorded ray, plus the four edges of each drawn hitbox
+constexpr size_t debugRenderMaxHitboxes = 256ul;
+constexpr size_t debugRenderMaxLines =
+  pul::physics::DebugQueries::ringCapacity + debugRenderMaxHitboxes*4ul;
+
 DebugRenderInfo debugRenderPoint = {};
 DebugRenderInfo debugRenderRay = {};
 
+// reused between frames, one entry per vertex
+std::vector<glm::vec2> debugRenderOrigins;
+std::vector<float> debugRenderCollisions;
+
 void LoadSokolInfoRay() {
   { // -- origin buffer
     sg_buffer_desc desc = {};
-    desc.size = debugRenderMaxRays * sizeof(float) * 4;
+    desc.size = debugRenderMaxLines * sizeof(float) * 4;
     desc.usage = SG_USAGE_STREAM;
     desc.content = nullptr;
     desc.label = "debug-render-info-ray-origin-buffer";
@@ -49,7 +62,7 @@ void LoadSokolInfoRay() {
 
   { // -- collision buffer
     sg_buffer_desc desc = {};
-    desc.size = debugRenderMaxRays * sizeof(float);
+    desc.size = debugRenderMaxLines * sizeof(float) * 2;
     desc.usage = SG_USAGE_STREAM;
     desc.content = nullptr;
     desc.label = "debug-render-info-ray-collision-buffer";
@@ -244,104 +257,37 @@ void LoadSokolInfoPoint() {
 void LoadSokolInfo() {
   ::LoadSokolInfoPoint();
   ::LoadSokolInfoRay();
+
+  ::debugRenderOrigins.reserve(debugRenderMaxLines * 2ul);
+  ::debugRenderCollisions.reserve(debugRenderMaxLines * 2ul);
 }
 
 // basically, when doings physics, we want tile lookups to be cached / quick,
 // and we only want to do one tile intersection test per tile-grid. In other
-// words, while there may be multiple tilesets contributing to the
-// collision layer, there is still only one collision layer
+// words, while there may be multiple tilesets & layers contributing to the
+// collision layer, there is still only one collision layer; layers are told
+// apart by the collision channels of the texels
 
 pul::physics::TilemapLayer tilemapLayer;
 
-float CalculateSdfDistance(
-  pul::physics::TilemapLayer::TileInfo const & tileInfo
-, glm::u32vec2 texel
-) {
-  if (tileInfo.tilesetIdx == -1ul) { return 0.0f; }
-
-  auto const * tileset = tilemapLayer.tilesets[tileInfo.tilesetIdx];
-
-  if (!tileInfo.Valid()) { return 0.0f; }
-
-  pul::physics::Tile const & physicsTile =
-    tileset->tiles[tileInfo.imageTileIdx];
-
-  // apply tile orientation
-  auto const tileOrientation = Idx(tileInfo.orientation);
-
-  if (tileOrientation & Idx(pul::core::TileOrientation::FlipHorizontal))
-    { texel.x = 31 - texel.x; }
-
-  if (tileOrientation & Idx(pul::core::TileOrientation::FlipVertical))
-    { texel.y = 31 - texel.y; }
-
-  if (tileOrientation & Idx(pul::core::TileOrientation::FlipDiagonal)) {
-    std::swap(texel.x, texel.y);
-  }
-
-  // -- compute intersection SDF and accel hints
-  return physicsTile.signedDistanceField[texel.x][texel.y];
-}
-
-glm::vec2 GetAabbMin(glm::vec2 const & aabbOrigin, glm::vec2 const & aabbDim) {
-  glm::vec2 const p0 = aabbOrigin - aabbDim/2.0f;
-  glm::vec2 const p1 = aabbOrigin + aabbDim/2.0f;
-  return glm::min(p0, p1);
-}
-
-glm::vec2 GetAabbMax(glm::vec2 const & aabbOrigin, glm::vec2 const & aabbDim) {
-  glm::vec2 const p0 = aabbOrigin - aabbDim/2.0f;
-  glm::vec2 const p1 = aabbOrigin + aabbDim/2.0f;
-  return glm::max(p0, p1);
-}
-
-bool IntersectionRayAabb(
-  glm::vec2 const & rayBegin, glm::vec2 const & rayEnd
-, glm::vec2 const & aabbOrigin, glm::vec2 const & aabbDim
-, float & intersectionLength
-) {
-  glm::vec2 normal = glm::normalize(rayEnd - rayBegin);
-  normal.x = normal.x == 0.0f ? 1.0f : 1.0f / normal.x;
-  normal.y = normal.y == 0.0f ? 1.0f : 1.0f / normal.y;
+// point queries of the current logic tick, anything that modifies
+// tilemapLayer has to invalidate it
+pul::physics::QueryCache queryCache;
 
-  glm::vec2 const min = (GetAabbMin(aabbOrigin, aabbDim) - rayBegin) * normal;
-  glm::vec2 const max = (GetAabbMax(aabbOrigin, aabbDim) - rayBegin) * normal;
+// bumped along with every invalidation of queryCache by a geometry change
+size_t geometryVersion = 0ul;
 
-  float tmin = glm::max(glm::min(min.x, max.x), glm::min(min.y, max.y));
-  float tmax = glm::min(glm::max(min.x, max.x), glm::max(min.y, max.y));
-
-  if (tmax < 0.0f || tmin > tmax)
-    { return false; }
-
-  float t = tmin < 0.0f ? tmax : tmin;
-  intersectionLength = t;
-  return t > 0.0f && t < glm::length(rayEnd - rayBegin);
-}
-
-bool IntersectionCircleAabb(
-  glm::vec2 const & circleOrigin, float const circleRadius
-, glm::vec2 const & aabbOrigin, glm::vec2 const & aabbDim
-, glm::vec2 & closestOrigin
-) {
-  closestOrigin =
-    glm::clamp(
-      circleOrigin
-    , GetAabbMin(aabbOrigin, aabbDim)
-    , GetAabbMax(aabbOrigin, aabbDim)
-    );
-
-  return glm::length(circleOrigin - closestOrigin) <= circleRadius;
-}
+// entity hitboxes, rebuilt at the start of every logic tick and updated as
+// entities move during it
+pul::physics::EntityBroadphase entityBroadphase;
 
 } // -- namespace
 
 // -- plugin functions
 extern "C" {
 
-PUL_PLUGIN_DECL void Physics_EntityIntersectionRaycast(
+PUL_PLUGIN_DECL void Physics_EntityBroadphaseRebuild(
   pul::core::SceneBundle & scene
-, pul::physics::IntersectorRay const & ray
-, pul::physics::EntityIntersectionResults & intersectionResults
 ) {
   auto & registry = scene.EnttRegistry();
 
@@ -351,110 +297,74 @@ PUL_PLUGIN_DECL void Physics_EntityIntersectionRaycast(
     , pul::core::ComponentOrigin
     >();
 
-  intersectionResults.entities.clear();
-
-  glm::vec2 const
-    rayOriginBegin = glm::vec2(ray.beginOrigin)
-  , rayOriginEnd = glm::vec2(ray.endOrigin)
-  ;
+  ::entityBroadphase.Clear();
 
   for (auto & entity : view) {
     auto const & hitbox = view.get<pul::core::ComponentHitboxAABB>(entity);
     auto const & origin = view.get<pul::core::ComponentOrigin>(entity);
 
-    float intersectionLength;
-    bool const intersection =
-      ::IntersectionRayAabb(
-        rayOriginBegin, rayOriginEnd
-      , origin.origin, glm::vec2(hitbox.dimensions)
-      , intersectionLength
-      );
-
-    if (intersection) {
-      glm::vec2 const intersectionOrigin =
-          rayOriginBegin
-        + intersectionLength * glm::normalize(rayOriginEnd - rayOriginBegin)
-      ;
-
-      intersectionResults.collision = true;
-      std::pair<glm::i32vec2, entt::entity> results;
-      std::get<0>(results) = glm::i32vec2(glm::round(intersectionOrigin));
-      std::get<1>(results) = entity;
-      intersectionResults.entities.emplace_back(results);
-    }
+    ::entityBroadphase.Update(
+      entity, origin.origin, glm::vec2(hitbox.dimensions)
+    );
   }
 }
 
-PUL_PLUGIN_DECL void Physics_EntityIntersectionCircle(
+PUL_PLUGIN_DECL void Physics_EntityBroadphaseUpdate(
   pul::core::SceneBundle & scene
-, pul::physics::IntersectorCircle const & circle
-, pul::physics::EntityIntersectionResults & intersectionResults
+, entt::entity entity
 ) {
   auto & registry = scene.EnttRegistry();
 
-  auto view =
-    registry.view<
-      pul::core::ComponentHitboxAABB
-    , pul::core::ComponentOrigin
-    >();
+  auto const & hitbox = registry.get<pul::core::ComponentHitboxAABB>(entity);
+  auto const & origin = registry.get<pul::core::ComponentOrigin>(entity);
 
-  intersectionResults.entities.clear();
+  ::entityBroadphase.Update(
+    entity, origin.origin, glm::vec2(hitbox.dimensions)
+  );
+}
 
-  for (auto & entity : view) {
-    auto const & hitbox = view.get<pul::core::ComponentHitboxAABB>(entity);
-    auto const & origin = view.get<pul::core::ComponentOrigin>(entity);
+PUL_PLUGIN_DECL void Physics_EntityIntersectionRaycast(
+  pul::core::SceneBundle & scene
+, pul::physics::IntersectorRay const & ray
+, pul::physics::EntityIntersectionResults & intersectionResults
+) {
+  scene.PhysicsDebugQueries().Count(pul::physics::DebugQueryType::EntityRay);
+  pul::physics::EntityIntersectionRaycast(
+    ::entityBroadphase, ray, intersectionResults
+  );
+}
 
-    glm::vec2 closestOrigin;
-    bool intersection =
-      ::IntersectionCircleAabb(
-        glm::vec2(circle.origin), circle.radius
-      , origin.origin, glm::vec2(hitbox.dimensions)
-      , closestOrigin
-      );
+PUL_PLUGIN_DECL void Physics_EntityIntersectionRaycastNearest(
+  pul::core::SceneBundle & scene
+, pul::physics::IntersectorRay const & ray
+, entt::entity ignoredEntity
+, pul::physics::EntityRaycastHits & hits
+) {
+  scene.PhysicsDebugQueries().Count(pul::physics::DebugQueryType::EntityRay);
+  pul::physics::EntityIntersectionRaycastNearest(
+    ::entityBroadphase, ray, ignoredEntity, hits
+  );
+}
 
-    if (intersection) {
-      intersectionResults.collision = true;
-      std::pair<glm::i32vec2, entt::entity> results;
-      std::get<0>(results) = glm::i32vec2(glm::round(closestOrigin));
-      std::get<1>(results) = entity;
-      intersectionResults.entities.emplace_back(results);
-    }
-  }
+PUL_PLUGIN_DECL void Physics_EntityIntersectionCircle(
+  pul::core::SceneBundle & scene
+, pul::physics::IntersectorCircle const & circle
+, pul::physics::EntityIntersectionResults & intersectionResults
+) {
+  scene
+    .PhysicsDebugQueries()
+    .Count(pul::physics::DebugQueryType::EntityCircle);
+  pul::physics::EntityIntersectionCircle(
+    ::entityBroadphase, circle, intersectionResults
+  );
 }
 
 PUL_PLUGIN_DECL void Physics_ProcessTileset(
   pul::physics::Tileset & tileset
 , pul::gfx::Image const & image
 ) {
-  tileset = {};
-  tileset.tiles.reserve((image.width / 32ul) * (image.height / 32ul));
-
-  // iterate thru every tile
-  for (size_t tileY = 0ul; tileY < image.height / 32ul; ++ tileY)
-  for (size_t tileX = 0ul; tileX < image.width  / 32ul; ++ tileX) {
-    pul::physics::Tile tile;
-
-    auto constexpr gridSize = pul::physics::Tile::gridSize;
-
-    // iterate thru every texel of the tile, stratified by physics tile GridSize
-    for (size_t texelY = 0ul; texelY < 32ul; texelY += 32ul/gridSize)
-    for (size_t texelX = 0ul; texelX < 32ul; texelX += 32ul/gridSize) {
-
-      size_t const
-        imageTexelX = tileX*32ul + texelX
-      , imageTexelY = tileY*32ul + texelY
-      , gridTexelX = static_cast<size_t>(texelX*(gridSize/32.0f))
-      , gridTexelY = static_cast<size_t>(texelY*(gridSize/32.0f))
-      ;
-
-      float const alpha =
-        image.data[(image.height-imageTexelY-1)*image.width + imageTexelX].a;
-
-      tile.signedDistanceField[gridTexelX][gridTexelY] = alpha;
-    }
-
-    tileset.tiles.emplace_back(tile);
-  }
+  tileset =
+    pul::physics::Tileset::Construct(image.data, image.width, image.height);
 }
 
 PUL_PLUGIN_DECL void Physics_ClearMapGeometry() {
@@ -474,117 +384,40 @@ PUL_PLUGIN_DECL void Physics_ClearMapGeometry() {
   sg_destroy_shader(::debugRenderRay  .program);
 
   tilemapLayer = {};
+  ::queryCache.Invalidate();
+  ++ ::geometryVersion;
 }
 
 PUL_PLUGIN_DECL void Physics_LoadMapGeometry(
   std::vector<pul::physics::Tileset const *> const & tilesets
 , std::vector<std::span<size_t>>             const & mapTileIndices
-, std::vector<std::span<glm::u32vec2>>       const & mapTileOrigins
+, std::vector<std::span<glm::i32vec2>>       const & mapTileOrigins
 , std::vector<std::span<pul::core::TileOrientation>> const & mapTileOrientations
+, std::vector<pul::core::CollisionChannel>   const & mapTileChannels
 ) {
   Physics_ClearMapGeometry();
 
-  // -- assert tilesets.size == mapTileIndices.size == mapTileOrigins.size
-  if (tilesets.size() != mapTileOrigins.size()) {
-    spdlog::critical("mismatching size on tilesets & map tile origins");
-    return;
-  }
-
-  if (mapTileIndices.size() != mapTileOrigins.size()) {
-    spdlog::critical("mismatching size on map tile indices/origins");
-    return;
-  }
-
-  // -- compute max width/height of tilemap
-  uint32_t width = 0ul, height = 0ul;
-  for (auto & tileOrigins : mapTileOrigins)
-  for (auto & origin : tileOrigins) {
-    width = std::max(width, origin.x+1);
-    height = std::max(height, origin.y+1);
-  }
-  ::tilemapLayer.width = width;
-
-  // copy tilesets over
-  ::tilemapLayer.tilesets =
-    decltype(::tilemapLayer.tilesets){tilesets.begin(), tilesets.end()};
-
-  // resize
-  ::tilemapLayer.tileInfo.resize(width * height);
-
-  // cache tileset info for quick tile fetching
-  for (size_t tilesetIdx = 0ul; tilesetIdx < tilesets.size(); ++ tilesetIdx) {
-    auto const & tileIndices = mapTileIndices[tilesetIdx];
-    auto const & tileOrigins = mapTileOrigins[tilesetIdx];
-    auto const & tileOrientations = mapTileOrientations[tilesetIdx];
-
-    PUL_ASSERT(tilesets[tilesetIdx], continue;);
-
-    for (size_t i = 0ul; i < tileIndices.size(); ++ i) {
-      auto const & imageTileIdx    = tileIndices[i];
-      auto const & tileOrigin      = tileOrigins[i];
-      auto const & tileOrientation = tileOrientations[i];
-
-      PUL_ASSERT_CMP(
-        imageTileIdx, <, tilesets[tilesetIdx]->tiles.size(), continue;
-      );
-
-      size_t const tileIdx = tileOrigin.y * width + tileOrigin.x;
-
-      PUL_ASSERT_CMP(tileIdx, <, ::tilemapLayer.tileInfo.size(), continue;);
-
-      auto & tile = ::tilemapLayer.tileInfo[tileIdx];
-      if (tile.imageTileIdx != -1ul) {
-        spdlog::error("multiple tiles are intersecting on the collision layer");
-        continue;
-      }
-
-      tile.tilesetIdx   = tilesetIdx;
-      tile.imageTileIdx = imageTileIdx;
-      tile.origin       = tileOrigin;
-      tile.orientation  = tileOrientation;
-    }
-  }
+  ::tilemapLayer =
+    pul::physics::TilemapLayer::Construct(
+      tilesets, mapTileIndices, mapTileOrigins, mapTileOrientations
+    , mapTileChannels
+    );
 
   ::LoadSokolInfo();
 }
 
+PUL_PLUGIN_DECL size_t Physics_GeometryVersion() {
+  return ::geometryVersion;
+}
+
 PUL_PLUGIN_DECL bool Physics_InverseSceneIntersectionRaycast(
   pul::core::SceneBundle & scene
 , pul::physics::IntersectorRay const & ray
 , pul::physics::IntersectionResults & intersectionResults
+, pul::core::CollisionChannel const channels
 ) {
-  intersectionResults = {};
-  // TODO this is slow and can be optimized by using SDFs
-  pul::physics::BresenhamLine(
-    ray.beginOrigin, ray.endOrigin
-  , [&](int32_t x, int32_t y) {
-      if (intersectionResults.collision) { return; }
-      auto origin = glm::i32vec2(x, y);
-      // -- get physics tile from acceleration structure
-
-      // calculate tile indices, not for the spritesheet but for the tile in
-      // the physx map
-      size_t tileIdx;
-      glm::u32vec2 texelOrigin;
-      if (
-        !pul::util::CalculateTileIndices(
-          tileIdx, texelOrigin, origin
-        , ::tilemapLayer.width, ::tilemapLayer.tileInfo.size()
-        )
-      ) {
-        return;
-      }
-
-      PUL_ASSERT_CMP(::tilemapLayer.tileInfo.size(), >, tileIdx, return;);
-      auto const & tileInfo = ::tilemapLayer.tileInfo[tileIdx];
-
-      if (::CalculateSdfDistance(tileInfo, texelOrigin) == 0.0f) {
-        intersectionResults =
-          pul::physics::IntersectionResults {
-            true, origin, tileInfo.imageTileIdx, tileInfo.tilesetIdx
-          };
-      }
-    }
+  pul::physics::InverseIntersectionRaycast(
+    ::tilemapLayer, ray, intersectionResults, channels
   );
 
   auto & queries = scene.PhysicsDebugQueries();
@@ -597,39 +430,10 @@ PUL_PLUGIN_DECL bool Physics_IntersectionRaycast(
   pul::core::SceneBundle & scene
 , pul::physics::IntersectorRay const & ray
 , pul::physics::IntersectionResults & intersectionResults
+, pul::core::CollisionChannel const channels
 ) {
-  intersectionResults = {};
-  // TODO this is slow and can be optimized by using SDFs
-  pul::physics::BresenhamLine(
-    ray.beginOrigin, ray.endOrigin
-  , [&](int32_t x, int32_t y) {
-      if (intersectionResults.collision) { return; }
-      auto origin = glm::i32vec2(x, y);
-      // -- get physics tile from acceleration structure
-
-      // calculate tile indices, not for the spritesheet but for the tile in
-      // the physx map
-      size_t tileIdx;
-      glm::u32vec2 texelOrigin;
-      if (
-        !pul::util::CalculateTileIndices(
-          tileIdx, texelOrigin, origin
-        , ::tilemapLayer.width, ::tilemapLayer.tileInfo.size()
-        )
-      ) {
-        return;
-      }
-
-      PUL_ASSERT_CMP(::tilemapLayer.tileInfo.size(), >, tileIdx, return;);
-      auto const & tileInfo = ::tilemapLayer.tileInfo[tileIdx];
-
-      if (::CalculateSdfDistance(tileInfo, texelOrigin) > 0.0f) {
-        intersectionResults =
-          pul::physics::IntersectionResults {
-            true, origin, tileInfo.imageTileIdx, tileInfo.tilesetIdx
-          };
-      }
-    }
+  pul::physics::IntersectionRaycast(
+    ::tilemapLayer, ray, intersectionResults, channels
   );
 
   auto & queries = scene.PhysicsDebugQueries();
@@ -642,72 +446,113 @@ PUL_PLUGIN_DECL pul::physics::TilemapLayer * Physics_TilemapLayer() {
   return &tilemapLayer;
 }
 
+PUL_PLUGIN_DECL bool Physics_LineOfSight(
+  pul::core::SceneBundle & scene
+, glm::i32vec2 const & beginOrigin
+, glm::i32vec2 const & endOrigin
+, pul::core::CollisionChannel const channels
+) {
+  scene.PhysicsDebugQueries().Count(pul::physics::DebugQueryType::LineOfSight);
+
+  return
+    pul::physics::LineOfSight(
+      ::tilemapLayer, beginOrigin, endOrigin, channels
+    );
+}
+
 PUL_PLUGIN_DECL bool Physics_IntersectionAabb(
-  pul::core::SceneBundle &
-, pul::physics::IntersectorAabb const &
-, pul::physics::IntersectionResults &
+  pul::core::SceneBundle & scene
+, pul::physics::IntersectorAabb const & aabb
+, pul::physics::AabbIntersectionResults & intersectionResults
+, pul::core::CollisionChannel const channels
 ) {
-  return false;
+  scene.PhysicsDebugQueries().Count(pul::physics::DebugQueryType::Aabb);
+
+  return
+    pul::physics::IntersectionAabb(
+      ::tilemapLayer, aabb, intersectionResults, channels
+    );
 }
 
 PUL_PLUGIN_DECL bool Physics_IntersectionPoint(
   pul::core::SceneBundle & scene
 , pul::physics::IntersectorPoint const & point
 , pul::physics::IntersectionResults & intersectionResults
+, pul::core::CollisionChannel const channels
 ) {
-  intersectionResults = {};
+  ::queryCache.BeginTick(scene.logicTick);
+  pul::physics::IntersectionPoint(
+    ::tilemapLayer, ::queryCache, point, intersectionResults, channels
+  );
 
   auto & queries = scene.PhysicsDebugQueries();
+  queries.Add(point, intersectionResults);
 
-  // -- get physics tile from acceleration structure
-  size_t tileIdx;
-  glm::u32vec2 texelOrigin;
-  if (
-    !pul::util::CalculateTileIndices(
-      tileIdx, texelOrigin, point.origin
-    , ::tilemapLayer.width, ::tilemapLayer.tileInfo.size()
-    )
-  ) {
-    queries.Add(point, {});
-    return false;
-  }
+  return intersectionResults.collision;
+}
 
-  PUL_ASSERT_CMP(::tilemapLayer.tileInfo.size(), >, tileIdx, return false;);
-  auto const & tileInfo = ::tilemapLayer.tileInfo[tileIdx];
+PUL_PLUGIN_DECL size_t Physics_IntersectionPointBatch(
+  pul::core::SceneBundle & scene
+, std::span<pul::physics::IntersectorPoint const> points
+, std::span<pul::physics::IntersectionResults> intersectionResults
+, pul::core::CollisionChannel const channels
+) {
+  ::queryCache.BeginTick(scene.logicTick);
+  size_t const collisions =
+    pul::physics::IntersectionPointBatch(
+      ::tilemapLayer, ::queryCache, points, intersectionResults, channels
+    );
+
+  auto & queries = scene.PhysicsDebugQueries();
+  queries.Add(points, intersectionResults);
 
-  if (::CalculateSdfDistance(tileInfo, texelOrigin) > 0.0f) {
-    intersectionResults =
-      pul::physics::IntersectionResults {
-        true, point.origin, tileInfo.imageTileIdx, tileInfo.tilesetIdx
-      };
+  return collisions;
+}
 
-    queries.Add(point, intersectionResults);
-    return true;
-  }
+PUL_PLUGIN_DECL size_t Physics_IntersectionRaycastBatch(
+  pul::core::SceneBundle & scene
+, std::span<pul::physics::IntersectorRay const> rays
+, std::span<pul::physics::IntersectionResults> intersectionResults
+, pul::core::CollisionChannel const channels
+) {
+  size_t const collisions =
+    pul::physics::IntersectionRaycastBatch(
+      ::tilemapLayer, rays, intersectionResults, channels
+    );
+
+  auto & queries = scene.PhysicsDebugQueries();
+  queries.Add(rays, intersectionResults);
 
-  queries.Add(point, {});
-  return false;
+  return collisions;
 }
 
 PUL_PLUGIN_DECL void Physics_RenderDebug(pul::core::SceneBundle & scene) {
-  auto & queries = scene.PhysicsDebugQueries();
+  auto const & queries = scene.PhysicsDebugQueries();
   auto & registry = scene.EnttRegistry();
 
-  if (::showPhysicsQueries && queries.intersectorPoints.size() > 0ul) {
+  auto & origins = ::debugRenderOrigins;
+  auto & collisions = ::debugRenderCollisions;
+
+  size_t const queriesDrawn =
+    static_cast<size_t>(std::max(::debugQueriesDrawn, 0));
+
+  if (queries.Recording() && queries.intersectorPoints.Size() > 0ul) {
     { // -- update buffers
-      std::vector<glm::vec2> points;
-      std::vector<float> collisions;
-      points.reserve(queries.intersectorPoints.size());
-      // update queries
-      for (auto & query : queries.intersectorPoints) {
-        points.emplace_back(std::get<0>(query).origin);
-        collisions
-          .emplace_back(static_cast<float>(std::get<1>(query).collision));
-      }
+      origins.clear();
+      collisions.clear();
+
+      queries.intersectorPoints.ForEachRecent(
+        std::min(queriesDrawn, debugRenderMaxPoints)
+      , [&](auto const & query) {
+          origins.emplace_back(std::get<0>(query).origin);
+          collisions
+            .emplace_back(static_cast<float>(std::get<1>(query).collision));
+        }
+      );
 
       sg_update_buffer(
         debugRenderPoint.bufferOrigin
-      , points.data(), points.size() * sizeof(glm::vec2)
+      , origins.data(), origins.size() * sizeof(glm::vec2)
       );
 
       sg_update_buffer(
@@ -736,31 +581,33 @@ PUL_PLUGIN_DECL void Physics_RenderDebug(pul::core::SceneBundle & scene) {
     );
 
     glPointSize(2);
-    sg_draw(0, queries.intersectorPoints.size(), 1);
+    sg_draw(0, origins.size(), 1);
   }
 
+  bool const showRays =
+    queries.Recording() && queries.intersectorRays.Size() > 0ul;
 
-  bool const showQueries = ::showHitboxes || ::showPhysicsQueries;
-
-  if (showQueries && queries.intersectorRays.size() > 0ul) {
-    size_t drawCount = 0ul;
+  if (::showHitboxes || showRays) {
     { // -- update buffers
-      std::vector<glm::vec2> lines;
-      std::vector<float> collisions;
-      lines.reserve(queries.intersectorRays.size()*2);
+      origins.clear();
+      collisions.clear();
+
       // update queries
-      if (::showPhysicsQueries) {
-        for (auto & query : queries.intersectorRays) {
-          auto & queryRay = std::get<0>(query);
-          auto & queryResult = std::get<1>(query);
-          bool collision = queryResult.collision;
-          lines.emplace_back(queryRay.beginOrigin);
-          lines.emplace_back(
-            collision ? queryResult.origin : queryRay.endOrigin
-          );
-          collisions.emplace_back(static_cast<float>(collision));
-          collisions.emplace_back(static_cast<float>(collision));
-        }
+      if (showRays) {
+        queries.intersectorRays.ForEachRecent(
+          queriesDrawn
+        , [&](auto const & query) {
+            auto & queryRay = std::get<0>(query);
+            auto & queryResult = std::get<1>(query);
+            bool collision = queryResult.collision;
+            origins.emplace_back(queryRay.beginOrigin);
+            origins.emplace_back(
+              collision ? queryResult.origin : queryRay.endOrigin
+            );
+            collisions.emplace_back(static_cast<float>(collision));
+            collisions.emplace_back(static_cast<float>(collision));
+          }
+        );
       }
 
       if (::showHitboxes) {
@@ -770,7 +617,10 @@ PUL_PLUGIN_DECL void Physics_RenderDebug(pul::core::SceneBundle & scene) {
             pul::core::ComponentHitboxAABB, pul::core::ComponentOrigin
           >();
 
+        size_t hitboxCount = 0ul;
         for (auto & entity : view) {
+          if (++ hitboxCount > debugRenderMaxHitboxes) { break; }
+
           // get origin/dimensions, for dimensions multiply by half in order to
           // get its "radius" or whatever
           auto const & dim =
@@ -789,42 +639,46 @@ PUL_PLUGIN_DECL void Physics_RenderDebug(pul::core::SceneBundle & scene) {
             damageable && !damageable->frameDamageInfos.empty();
 
           // top
-          lines.emplace_back(origin + glm::vec2(-dim.x, -dim.y));
-          lines.emplace_back(origin + glm::vec2(+dim.x, -dim.y));
+          origins.emplace_back(origin + glm::vec2(-dim.x, -dim.y));
+          origins.emplace_back(origin + glm::vec2(+dim.x, -dim.y));
           collisions.emplace_back(hasCollision);
           collisions.emplace_back(hasCollision);
 
           // bottom
-          lines.emplace_back(origin + glm::vec2(-dim.x, +dim.y));
-          lines.emplace_back(origin + glm::vec2(+dim.x, +dim.y));
+          origins.emplace_back(origin + glm::vec2(-dim.x, +dim.y));
+          origins.emplace_back(origin + glm::vec2(+dim.x, +dim.y));
           collisions.emplace_back(hasCollision);
           collisions.emplace_back(hasCollision);
 
           // left
-          lines.emplace_back(origin + glm::vec2(-dim.x, -dim.y));
-          lines.emplace_back(origin + glm::vec2(-dim.x, +dim.y));
+          origins.emplace_back(origin + glm::vec2(-dim.x, -dim.y));
+          origins.emplace_back(origin + glm::vec2(-dim.x, +dim.y));
           collisions.emplace_back(hasCollision);
           collisions.emplace_back(hasCollision);
 
           // right
-          lines.emplace_back(origin + glm::vec2(+dim.x, -dim.y));
-          lines.emplace_back(origin + glm::vec2(+dim.x, +dim.y));
+          origins.emplace_back(origin + glm::vec2(+dim.x, -dim.y));
+          origins.emplace_back(origin + glm::vec2(+dim.x, +dim.y));
           collisions.emplace_back(hasCollision);
           collisions.emplace_back(hasCollision);
         }
       }
 
+      PUL_ASSERT_CMP(
+        origins.size(), <=, debugRenderMaxLines * 2ul
+      , origins.resize(debugRenderMaxLines * 2ul);
+        collisions.resize(debugRenderMaxLines * 2ul);
+      );
+
       sg_update_buffer(
         debugRenderRay.bufferOrigin
-      , lines.data(), lines.size() * sizeof(glm::vec2)
+      , origins.data(), origins.size() * sizeof(glm::vec2)
       );
 
       sg_update_buffer(
         debugRenderRay.bufferCollision
       , collisions.data(), collisions.size() * sizeof(float)
       );
-
-      drawCount = lines.size();
     }
 
     // apply pipeline and render
@@ -848,17 +702,84 @@ PUL_PLUGIN_DECL void Physics_RenderDebug(pul::core::SceneBundle & scene) {
 
     glLineWidth(1.0f);
 
-    sg_draw(0, drawCount, 1);
+    sg_draw(0, origins.size(), 1);
   }
 }
 
-PUL_PLUGIN_DECL void Physics_UiRender(pul::core::SceneBundle &) {
+PUL_PLUGIN_DECL void Physics_UiRender(pul::core::SceneBundle & scene) {
   ImGui::Begin("Physics");
 
-  pul::imgui::Text("tilemap width {}", ::tilemapLayer.width);
-  pul::imgui::Text("tile info size {}", ::tilemapLayer.tileInfo.size());
+  pul::imgui::Text(
+    "tilemap tiles {}x{} .. {}x{}"
+  , ::tilemapLayer.tileMin.x, ::tilemapLayer.tileMin.y
+  , ::tilemapLayer.tileMax.x, ::tilemapLayer.tileMax.y
+  );
+  pul::imgui::Text(
+    "tile chunks {} ({} KiB) chunk table {}x{}"
+  , ::tilemapLayer.chunks.size()
+  , ::tilemapLayer.chunks.size()
+      * sizeof(pul::physics::TilemapLayer::Chunk) / 1024ul
+  , ::tilemapLayer.chunkDimensions.x, ::tilemapLayer.chunkDimensions.y
+  );
+  {
+    size_t solidChunks = 0ul, mixedTiles = 0ul;
+    for (auto const & chunk : ::tilemapLayer.chunks)
+      { solidChunks += chunk.channels != pul::core::CollisionChannel::None; }
+    for (auto const & tile : ::tilemapLayer.orientedTiles)
+      { mixedTiles += tile.Mixed(); }
+    pul::imgui::Text(
+      "occupancy; map {} chunks {}/{}"
+    , ToStr(::tilemapLayer.channels)
+    , solidChunks, ::tilemapLayer.chunks.size()
+    );
+    pul::imgui::Text(
+      "oriented tiles {} ({} with mixed channels)"
+    , ::tilemapLayer.orientedTiles.size(), mixedTiles
+    );
+  }
+  pul::imgui::Text(
+    "broadphase entities {}", ::entityBroadphase.records.size()
+  );
+
+  auto & queries = scene.PhysicsDebugQueries();
+
+  #ifdef PULCHER_PHYSICS_DEBUG_QUERIES
+    ImGui::Checkbox("record physics queries", &queries.enabled);
+  #else
+    pul::imgui::Text("physics query recording is compiled out");
+  #endif
+
+  ImGui::Checkbox("cache point queries", &::queryCache.enabled);
+  if (::queryCache.enabled) {
+    auto const & counters = ::queryCache.previousTickCounters;
+    size_t const total = counters.pointHits + counters.pointMisses;
+    pul::imgui::Text(
+      "point cache last tick; hits {} misses {} ({:.1f}% hit rate)"
+    , counters.pointHits, counters.pointMisses
+    , total == 0ul
+        ? 0.0f
+        : 100.0f * static_cast<float>(counters.pointHits)
+          / static_cast<float>(total)
+    );
+  }
+
+  if (queries.Recording()) {
+    ImGui::SliderInt(
+      "queries drawn", &::debugQueriesDrawn
+    , 0, static_cast<int>(pul::physics::DebugQueries::ringCapacity)
+    );
+
+    using Type = pul::physics::DebugQueryType;
+    auto const & counts = queries.previousFrameCounts;
+    pul::imgui::Text(
+      "queries last frame; point {} ray {} aabb {} entity ray {} "
+      "entity circle {} line of sight {}"
+    , counts[Idx(Type::Point)], counts[Idx(Type::Ray)]
+    , counts[Idx(Type::Aabb)], counts[Idx(Type::EntityRay)]
+    , counts[Idx(Type::EntityCircle)], counts[Idx(Type::LineOfSight)]
+    );
+  }
 
-  ImGui::Checkbox("show physics queries", &::showPhysicsQueries);
   ImGui::Checkbox("show hitboxes", &::showHitboxes);
 
   ImGui::End();
@@ -1,5 +1,6 @@
 /* pulcher | aodq.net */
 
+#include <pulcher-animation/animation.hpp>
 #include <pulcher-controls/controls.hpp>
 #include <pulcher-core/scene-bundle.hpp>
 #include <pulcher-gfx/context.hpp>
@@ -64,6 +65,38 @@ PUL_PLUGIN_DECL void Ui_UiDispatch(
   , static_cast<double>(io.Framerate)
   );
 
+  { // -- rendering
+    auto & animationSystem = sceneBundle.AnimationSystem();
+    pul::imgui::Text(
+      "animation draw calls {} ({} instances)"
+    , animationSystem.drawCalls, animationSystem.drawnInstances
+    );
+    pul::imgui::Text(
+      "animation pieces recomputed {} / skipped {}"
+    , animationSystem.piecesRecomputed, animationSystem.piecesSkipped
+    );
+    ImGui::Checkbox(
+      "instanced animation pieces", &animationSystem.useInstancedPieces
+    );
+    pul::imgui::Text(
+      "animation {} uploaded {}"
+    , animationSystem.instancedPieces ? "piece records" : "vertices"
+    , animationSystem.elementsUploaded
+    );
+    pul::imgui::Text(
+      "animation instances reused {} / allocated {}"
+    , animationSystem.instancesReused, animationSystem.instancesAllocated
+    );
+    pul::imgui::Text(
+      "animation update {:.3f} ms ({} workers)"
+    , animationSystem.updateMs, animationSystem.updateJobPool.WorkerCount()
+    );
+    pul::imgui::SliderInt(
+      "animation update workers", &animationSystem.updateWorkerCount
+    , 0, static_cast<int>(std::thread::hardware_concurrency())
+    );
+  }
+
   ImGui::Text("ui pl test");
 
   ImGui::End();